@@ -0,0 +1,97 @@
+// Implementation File -> AllocationCounter.cpp
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+static atomic<uint64_t> allocations{0};
+static atomic<uint64_t> bytesRequested{0};
+
+static void* countedAllocation(const size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    bytesRequested.fetch_add(size, memory_order_relaxed);
+    return malloc(size == 0 ? 1 : size);
+}
+
+static void* countedAlignedAllocation(const size_t size, const align_val_t alignment) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    bytesRequested.fetch_add(size, memory_order_relaxed);
+    const size_t align = static_cast<size_t>(alignment);
+    return aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+void* operator new(const size_t size) {
+    if (void* memory = countedAllocation(size)) return memory;
+    throw bad_alloc();
+}
+
+void* operator new[](const size_t size) {
+    if (void* memory = countedAllocation(size)) return memory;
+    throw bad_alloc();
+}
+
+void* operator new(const size_t size, const nothrow_t&) noexcept { return countedAllocation(size); }
+void* operator new[](const size_t size, const nothrow_t&) noexcept { return countedAllocation(size); }
+
+void* operator new(const size_t size, const align_val_t alignment) {
+    if (void* memory = countedAlignedAllocation(size, alignment)) return memory;
+    throw bad_alloc();
+}
+
+void* operator new[](const size_t size, const align_val_t alignment) {
+    if (void* memory = countedAlignedAllocation(size, alignment)) return memory;
+    throw bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete[](void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t) noexcept { free(memory); }
+void operator delete(void* memory, align_val_t) noexcept { free(memory); }
+void operator delete[](void* memory, align_val_t) noexcept { free(memory); }
+void operator delete(void* memory, size_t, align_val_t) noexcept { free(memory); }
+void operator delete[](void* memory, size_t, align_val_t) noexcept { free(memory); }
+
+uint64_t allocationCount() {
+    return allocations.load(memory_order_relaxed);
+}
+
+uint64_t allocatedBytes() {
+    return bytesRequested.load(memory_order_relaxed);
+}
+
+/*
+ * residentBytes function definition:
+ *  - Linux: the second field of /proc/self/statm is the resident page count.
+ */
+size_t residentBytes() {
+#if defined(__linux__)
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == nullptr) {
+        return 0;
+    }
+    unsigned long long pages = 0;
+    unsigned long long resident = 0;
+    const int fields = fscanf(statm, "%llu %llu", &pages, &resident);
+    fclose(statm);
+    return fields == 2 ? static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+    return 0;
+#endif
+}
+
+void releaseFreeMemory() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
@@ -0,0 +1,41 @@
+// Specification File -> AllocationCounter.h
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+/*
+    Allocation Counter
+    -----------------------------
+    Description:
+    Replaces the global operator new/delete (see AllocationCounter.cpp) with
+    versions that count every heap allocation made through them, from any
+    thread. It is linked into the benchmark program, whose harness reads the
+    count before and after each timed run so every benchmark reports
+    allocations per item next to its time, and into the inventory program
+    itself when it is built with INVENTORY_METRICS (see Metrics.h).
+    residentBytes() reads the process's resident set size (RSS) from the
+    operating system, for memory reports.
+
+    In Simpler Terms:
+    A tally of how often the program asks for memory, and how much memory it is
+    really using.
+*/
+
+// Allocations made through operator new since the program started.
+uint64_t allocationCount();
+
+// Bytes requested through operator new since the program started.
+uint64_t allocatedBytes();
+
+// Current resident set size in bytes (0 where the platform does not report it).
+size_t residentBytes();
+
+// Hands freed heap memory back to the operating system where the C library
+// supports it, so the next residentBytes() reading starts from a clean slate.
+void releaseFreeMemory();
+
+#endif // ALLOCATIONCOUNTER_H
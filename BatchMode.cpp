@@ -0,0 +1,370 @@
+// Implementation File -> BatchMode.cpp
+#include "BatchMode.h"
+#include "BulkLoader.h"
+#include "RecordWriter.h"
+#include "BinarySnapshot.h"
+#include "DeltaExport.h"
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+// Skips spaces and tabs at the front of text.
+static void skipBlanks(string_view& text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+}
+
+// Reads one whitespace-separated integer from the front of text.
+static bool takeInt(string_view& text, int& value) {
+    skipBlanks(text);
+    const auto [last, error] = from_chars(text.data(), text.data() + text.size(), value);
+    if (error != errc() || (last != text.data() + text.size() && *last != ' ' && *last != '\t')) {
+        return false;
+    }
+    text.remove_prefix(static_cast<size_t>(last - text.data()));
+    return true;
+}
+
+// Marks result as rejected for reason and returns it.
+static TransactionResult& reject(TransactionResult& result, const char* reason) {
+    result.status = TransactionResult::Status::Rejected;
+    result.reason = reason;
+    return result;
+}
+
+// Handles "a <item#> <qty>" and "r <item#> <qty>".
+static void applyStockChange(string_view args, InventoryStore& inventory, TransactionResult& result) {
+    if (!takeInt(args, result.itemNum) || !takeInt(args, result.quantity)) {
+        reject(result, "expected an item number and a quantity");
+        return;
+    }
+    skipBlanks(args);
+    if (!args.empty()) {
+        reject(result, "unexpected text after quantity");
+        return;
+    }
+
+    const StockResult outcome = result.op == 'a' ? inventory.addUnits(result.itemNum, result.quantity, &result.units)
+                                                 : inventory.removeUnits(result.itemNum, result.quantity, &result.units);
+    if (outcome != StockResult::Ok) {
+        reject(result, describeStockResult(outcome));
+        return;
+    }
+    result.status = TransactionResult::Status::Applied;
+}
+
+// Handles "n <description>|<cost>|<units>".
+static void applyNewItem(string_view args, InventoryStore& inventory, TransactionResult& result) {
+    skipBlanks(args);
+    const size_t firstPipe = args.find('|');
+    const size_t secondPipe = firstPipe == string_view::npos ? string_view::npos : args.find('|', firstPipe + 1);
+    if (secondPipe == string_view::npos) {
+        reject(result, "expected description|cost|units");
+        return;
+    }
+
+    Money cost;
+    int units;
+    if (!parseCostField(args.substr(firstPipe + 1, secondPipe - firstPipe - 1), cost) || cost < Money()) {
+        reject(result, "unit cost must be a valid non-negative number");
+        return;
+    }
+    if (!parseUnitsField(args.substr(secondPipe + 1), units) || units < 0 || units > MAX_UNITS) {
+        reject(result, "initial quantity must be an integer between 0 - 30");
+        return;
+    }
+
+    result.itemNum = inventory.addItem(args.substr(0, firstPipe), cost, units);
+    if (result.itemNum < 0) {
+        reject(result, inventory.lastFailure());
+        return;
+    }
+    result.units = units;
+    result.status = TransactionResult::Status::Applied;
+}
+
+/*
+ * applyTransaction function definition:
+ *  - Dispatches one transaction line on its first character, mirroring handleCommand.
+ *  - Never prompts and never prints; the result says what happened.
+ */
+TransactionResult applyTransaction(string_view line, InventoryStore& inventory) {
+    TransactionResult result;
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    skipBlanks(line);
+    if (line.empty() || line.front() == '#') {
+        return result;
+    }
+
+    result.op = static_cast<char>(tolower(static_cast<unsigned char>(line.front())));
+    string_view args = line.substr(1);
+    if (!args.empty() && args.front() != ' ' && args.front() != '\t') {
+        return reject(result, "unknown transaction");
+    }
+
+    switch (result.op) {
+        case 'a':
+        case 'r':
+            applyStockChange(args, inventory, result);
+            break;
+        case 'n':
+            applyNewItem(args, inventory, result);
+            break;
+        case 'i': {
+            skipBlanks(args);
+            BulkLoadStats stats;
+            if (!bulkLoadFile(string(args), inventory, stats)) {
+                return reject(result, "could not open input file");
+            }
+            if (stats.formatError != nullptr) {
+                return reject(result, stats.formatError);
+            }
+            result.records = stats.recordsLoaded;
+            result.status = TransactionResult::Status::Applied;
+            break;
+        }
+        case 'o': {
+            // As at the console: the next 'd' starts from this export
+            skipBlanks(args);
+            const vector<int> pending = clearPendingChanges();
+            if (!writeInventoryFile(inventory, string(args))) {
+                restorePendingChanges(pending);
+                return reject(result, "could not write output file");
+            }
+            result.status = TransactionResult::Status::Applied;
+            break;
+        }
+        case 's':
+            skipBlanks(args);
+            if (!saveSnapshotFile(inventory, string(args))) {
+                return reject(result, "could not write snapshot file");
+            }
+            result.status = TransactionResult::Status::Applied;
+            break;
+        default:
+            reject(result, "unknown transaction");
+    }
+    return result;
+}
+
+/*
+ * applyBatchLine function definition:
+ *  - Applies the line and adds its outcome to the run's totals; failures keep
+ *    their line number for the report.
+ */
+void applyBatchLine(const string_view line, const size_t lineNumber, InventoryStore& inventory, BatchSummary& summary) {
+    const TransactionResult result = applyTransaction(line, inventory);
+    switch (result.status) {
+        case TransactionResult::Status::Ignored:
+            return;
+        case TransactionResult::Status::Rejected:
+            ++summary.transactionsRejected;
+            if (summary.errors.size() < BatchSummary::MAX_REPORTED_ERRORS) {
+                summary.errors.push_back({lineNumber, result.reason});
+            }
+            return;
+        case TransactionResult::Status::Applied:
+            break;
+    }
+
+    ++summary.transactionsApplied;
+    switch (result.op) {
+        case 'a':
+            summary.unitsAdded += result.quantity;
+            break;
+        case 'r':
+            summary.unitsRemoved += result.quantity;
+            break;
+        case 'n':
+            ++summary.itemsCreated;
+            break;
+        case 'i':
+            summary.recordsLoaded += result.records;
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * runBatchFile function definition:
+ *  - Maps the transaction file and applies it line by line in a single pass.
+ *  - Times the whole run, including any 'i'/'o' file transactions.
+ */
+bool runBatchFile(const string& filename, InventoryStore& inventory, BatchSummary& summary) {
+    const auto start = chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+
+    const string_view text = file.view();
+    size_t position = 0;
+    while (position < text.size()) {
+        const void* found = memchr(text.data() + position, '\n', text.size() - position);
+        const size_t lineEnd = found ? static_cast<size_t>(static_cast<const char*>(found) - text.data()) : text.size();
+
+        ++summary.linesRead;
+        applyBatchLine(text.substr(position, lineEnd - position), summary.linesRead, inventory, summary);
+        position = lineEnd + 1;
+    }
+
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+/*
+ * printBatchSummary function definition:
+ *  - Prints what the run did, how long it took and why transactions were rejected.
+ */
+void printBatchSummary(const BatchSummary& summary) {
+    const size_t transactions = summary.transactionsApplied + summary.transactionsRejected;
+    const double rate = summary.seconds > 0.0 ? static_cast<double>(transactions) / summary.seconds : 0.0;
+
+    cout << "Batch complete: " << summary.linesRead << " line(s), " << transactions << " transaction(s) in "
+         << fixed << setprecision(2) << summary.seconds * 1000.0 << " ms (" << rate << " transactions/s).\n"
+         << "  Applied:       " << summary.transactionsApplied << '\n'
+         << "  Rejected:      " << summary.transactionsRejected << '\n'
+         << "  Units added:   " << summary.unitsAdded << '\n'
+         << "  Units removed: " << summary.unitsRemoved << '\n'
+         << "  Items created: " << summary.itemsCreated << '\n'
+         << "  Records loaded from files: " << summary.recordsLoaded << '\n';
+
+    for (const BatchError& error : summary.errors) {
+        cout << "  Line " << error.lineNumber << ": " << error.reason << '\n';
+    }
+    if (summary.transactionsRejected > summary.errors.size()) {
+        cout << "  ... and " << summary.transactionsRejected - summary.errors.size() << " more rejection(s).\n";
+    }
+}
+
+/*
+ * runBatch function definition:
+ *  - Prompts until a transaction file can be opened, applies it, then prints the summary.
+ */
+void runBatch(InventoryStore& inventory) {
+    string filename;
+    BatchSummary summary;
+
+    while (true) {
+        cout << "Enter name of transaction file: ";
+        cin >> filename;
+
+        if (runBatchFile(filename, inventory, summary)) {
+            break;
+        }
+
+        cout << "Error: Could not open file \"" << filename << "\". Please try again.\n";
+    }
+
+    printBatchSummary(summary);
+}
+
+/*
+ * applyPickList function definition:
+ *  - Stages every "a"/"r" line in a StockTransaction, remembering which text
+ *    line each came from; a line that does not parse rejects the whole list
+ *    before anything is applied.
+ *  - Commits the transaction (one validation pass, one batch of updates) and
+ *    maps a failing transaction line back to its text line.
+ */
+PickListResult applyPickList(const string_view text, InventoryStore& inventory) {
+    PickListResult result;
+    StockTransaction transaction;
+    vector<size_t> lineNumbers;
+
+    size_t lineNumber = 0;
+    size_t position = 0;
+    while (position < text.size()) {
+        const size_t lineEnd = min(text.find_first_of("\n;", position), text.size());
+        string_view line = text.substr(position, lineEnd - position);
+        position = lineEnd + 1;
+        ++lineNumber;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        skipBlanks(line);
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        const char op = static_cast<char>(tolower(static_cast<unsigned char>(line.front())));
+        string_view args = line.substr(1);
+        int itemNum = 0;
+        int quantity = 0;
+        if ((op != 'a' && op != 'r') || (!args.empty() && args.front() != ' ' && args.front() != '\t')) {
+            result.reason = "expected \"a <item#> <quantity>\" or \"r <item#> <quantity>\"";
+        } else if (!takeInt(args, itemNum) || !takeInt(args, quantity)) {
+            result.reason = "expected an item number and a quantity";
+        } else {
+            skipBlanks(args);
+            if (!args.empty()) {
+                result.reason = "unexpected text after quantity";
+            } else if (quantity < 0) {
+                result.reason = describeStockResult(StockResult::NegativeQuantity);
+            }
+        }
+        if (result.reason != nullptr) {
+            result.failedLine = lineNumber;
+            return result;
+        }
+
+        if (op == 'a') {
+            transaction.add(itemNum, quantity);
+            result.unitsAdded += quantity;
+        } else {
+            transaction.remove(itemNum, quantity);
+            result.unitsRemoved += quantity;
+        }
+        lineNumbers.push_back(lineNumber);
+    }
+    result.lines = transaction.size();
+
+    const auto start = chrono::steady_clock::now();
+    size_t failed = 0;
+    const StockResult outcome = transaction.commit(inventory, &failed);
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (outcome != StockResult::Ok) {
+        result.reason = describeStockResult(outcome);
+        result.failedLine = failed < lineNumbers.size() ? lineNumbers[failed] : lineNumber;
+        return result;
+    }
+    result.applied = true;
+    return result;
+}
+
+/*
+ * runPickList function definition:
+ *  - Takes the file name from the command line ("k picks.txt") or prompts until
+ *    a file can be opened, then applies it as one transaction.
+ */
+void runPickList(InventoryStore& inventory, string_view arguments) {
+    skipBlanks(arguments);
+    string filename(arguments);
+    MappedFile file;
+    while (filename.empty() || !file.open(filename)) {
+        if (!filename.empty()) {
+            cout << "Error: Could not open file \"" << filename << "\". Please try again.\n";
+        }
+        cout << "Enter name of pick list file: ";
+        cin >> filename;
+    }
+
+    const PickListResult result = applyPickList(file.view(), inventory);
+    if (!result.applied) {
+        cout << "Pick list rejected, nothing changed: line " << result.failedLine << ": " << result.reason << ".\n";
+        return;
+    }
+    cout << "Pick list applied: " << result.lines << " line(s), " << result.unitsAdded << " unit(s) added, "
+         << result.unitsRemoved << " removed in " << fixed << setprecision(3) << result.seconds * 1000.0
+         << " ms.\n";
+}
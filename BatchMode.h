@@ -0,0 +1,123 @@
+// Specification File -> BatchMode.h
+#ifndef BATCHMODE_H
+#define BATCHMODE_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InventoryStore.h"
+
+using namespace std;
+
+/*
+    Batch Mode
+    -----------------------------
+    Description:
+    Applies a file of transactions to the inventory without any prompts or
+    per-command console output. Each line holds one transaction:
+
+        a <item#> <quantity>            add parts (same rules as 'a')
+        r <item#> <quantity>            remove parts (same rules as 'r')
+        n <description>|<cost>|<units>  create a new item (same rules as 'n')
+        i <filename>                    append records from an inventory file or snapshot
+        o <filename>                    write the inventory to a file
+        s <filename>                    write a binary snapshot of the inventory
+
+    Blank lines and lines starting with '#' are ignored. A transaction that breaks a
+    rule is skipped and counted; the run always continues with the next line.
+
+    In Simpler Terms:
+    Replays a whole day of stock movements from a file in one go, then prints a
+    short report of what happened.
+*/
+
+// One rejected transaction, kept for the end-of-run report.
+struct BatchError {
+    size_t lineNumber = 0;
+    string reason;
+};
+
+// Totals for one batch run.
+struct BatchSummary {
+    size_t linesRead = 0;
+    size_t transactionsApplied = 0;
+    size_t transactionsRejected = 0;
+    size_t itemsCreated = 0;
+    size_t recordsLoaded = 0;
+    long long unitsAdded = 0;
+    long long unitsRemoved = 0;
+    double seconds = 0.0;
+    vector<BatchError> errors; // Only the first MAX_REPORTED_ERRORS rejections
+
+    static constexpr size_t MAX_REPORTED_ERRORS = 20;
+};
+
+// Outcome of one transaction line (see applyTransaction).
+struct TransactionResult {
+    enum class Status { Applied, Rejected, Ignored };
+
+    Status status = Status::Ignored;   // Ignored: blank line or comment
+    char op = 0;                       // Transaction letter ('a', 'r', 'n', 'i', 'o', 's')
+    const char* reason = nullptr;      // Why it was rejected
+    int itemNum = -1;                  // Item changed or created ('a', 'r', 'n')
+    int quantity = 0;                  // Units added or removed ('a', 'r')
+    int units = 0;                     // The item's units afterwards ('a', 'r', 'n')
+    size_t records = 0;                // Records loaded ('i')
+};
+
+// Applies one transaction line and reports exactly what happened. Safe to call from
+// several threads at once (see InventoryStore); never prompts and never prints.
+TransactionResult applyTransaction(string_view line, InventoryStore& inventory);
+
+// Applies a single transaction line (line number is used for error reporting).
+void applyBatchLine(string_view line, size_t lineNumber, InventoryStore& inventory, BatchSummary& summary);
+
+// Applies every transaction in filename. Returns false if the file cannot be opened.
+bool runBatchFile(const string& filename, InventoryStore& inventory, BatchSummary& summary);
+
+// Prints the end-of-run report (counts, timing and the first few rejections).
+void printBatchSummary(const BatchSummary& summary);
+
+// 'x' command handler: prompts for a transaction file, runs it and prints the summary.
+void runBatch(InventoryStore& inventory);
+
+/*
+    Pick Lists
+    -----------------------------
+    Description:
+    A pick list moves stock on many items as one transaction: either every line
+    keeps its item within 0–30 units and all of them apply, or nothing changes
+    (see StockTransaction). Lines are written as in a batch file,
+
+        a <item#> <quantity>            add parts
+        r <item#> <quantity>            remove parts
+
+    separated by newlines or ';', with blank lines and '#' comments ignored. The
+    whole list is checked in one pass and applied under one set of locks, and it
+    reaches the journal as a single record, so a 500-line list costs about as much
+    as one 'a' command.
+
+    In Simpler Terms:
+    Pick everything on the list, or (if anything is short) pick nothing.
+*/
+
+// Outcome of one pick list.
+struct PickListResult {
+    bool applied = false;
+    size_t lines = 0;                  // Stock lines in the list
+    size_t failedLine = 0;             // Line (1-based, counting ';' as a line break) that was rejected
+    const char* reason = nullptr;      // Why the list was rejected
+    long long unitsAdded = 0;
+    long long unitsRemoved = 0;
+    double seconds = 0.0;              // Checking and applying the list (after parsing)
+};
+
+// Parses and applies a pick list all-or-nothing. Never prompts and never prints.
+PickListResult applyPickList(string_view text, InventoryStore& inventory);
+
+// 'k' command handler: applies the pick list file named in arguments (prompts for
+// one if there is none) and prints the result.
+void runPickList(InventoryStore& inventory, string_view arguments = {});
+
+#endif // BATCHMODE_H
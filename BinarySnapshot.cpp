@@ -0,0 +1,315 @@
+// Implementation File -> BinarySnapshot.cpp
+#include "BinarySnapshot.h"
+#include "BulkLoader.h"
+#include "RecordWriter.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+static constexpr char SNAPSHOT_MAGIC[8] = {'I', 'N', 'V', 'S', 'N', 'A', 'P', '\0'};
+
+// Snapshots written before costs were kept in cents: same layout, double costs.
+static constexpr uint32_t DOUBLE_COSTS_VERSION = 1;
+
+static_assert(sizeof(SnapshotHeader) == 72, "SnapshotHeader layout is part of the file format");
+static_assert(sizeof(int) == 4 && sizeof(double) == 8, "Snapshot columns are stored as int32, int64 and (version 1) float64");
+
+static uint64_t alignTo8(const uint64_t value) {
+    return (value + 7) & ~uint64_t{7};
+}
+
+/*
+ * ChecksumBuilder
+ *  - Streaming form of snapshotChecksum: the data may arrive in pieces of any size.
+ *  - Four independent 64-bit lanes each absorb one word of every 32-byte block, so
+ *    the hash runs at memory speed; the lanes are merged and mixed at the end.
+ */
+namespace {
+class ChecksumBuilder {
+public:
+    void update(string_view data) {
+        if (data.empty()) {
+            return;
+        }
+        total += data.size();
+
+        if (pending > 0) {
+            const size_t take = min(data.size(), sizeof(buffer) - pending);
+            memcpy(buffer + pending, data.data(), take);
+            pending += take;
+            data.remove_prefix(take);
+            if (pending < sizeof(buffer)) {
+                return;
+            }
+            absorb(buffer);
+            pending = 0;
+        }
+
+        while (data.size() >= sizeof(buffer)) {
+            absorb(data.data());
+            data.remove_prefix(sizeof(buffer));
+        }
+
+        memcpy(buffer, data.data(), data.size());
+        pending = data.size();
+    }
+
+    uint64_t finish() const {
+        uint64_t hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+        hash ^= total;
+        for (size_t i = 0; i < pending; ++i) {
+            hash = rotl(hash ^ (static_cast<unsigned char>(buffer[i]) * PRIME_5), 11) * PRIME_1;
+        }
+        hash ^= hash >> 33;
+        hash *= PRIME_2;
+        hash ^= hash >> 29;
+        hash *= PRIME_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+private:
+    static constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+    uint64_t lanes[4] = {PRIME_1 + PRIME_2, PRIME_2, 0, 0 - PRIME_1};
+    char buffer[32] = {};
+    size_t pending = 0;
+    uint64_t total = 0;
+
+    static uint64_t rotl(const uint64_t value, const int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    void absorb(const char* block) {
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t word;
+            memcpy(&word, block + lane * 8, sizeof(word));
+            lanes[lane] = rotl(lanes[lane] + word * PRIME_2, 31) * PRIME_1;
+        }
+    }
+};
+}
+
+uint64_t snapshotChecksum(const string_view data) {
+    ChecksumBuilder builder;
+    builder.update(data);
+    return builder.finish();
+}
+
+bool isSnapshotData(const string_view data) {
+    return data.size() >= sizeof(SNAPSHOT_MAGIC) && memcmp(data.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0;
+}
+
+const char* describeSnapshotResult(const SnapshotResult result) {
+    switch (result) {
+        case SnapshotResult::Ok:
+            return "ok";
+        case SnapshotResult::CannotOpen:
+            return "could not open file";
+        case SnapshotResult::NotASnapshot:
+            return "not a binary snapshot";
+        case SnapshotResult::UnsupportedVersion:
+            return "unsupported snapshot version";
+        case SnapshotResult::Truncated:
+            return "snapshot is truncated";
+        case SnapshotResult::ChecksumMismatch:
+            return "snapshot checksum mismatch (file is damaged)";
+        case SnapshotResult::Corrupt:
+            return "snapshot contents are inconsistent";
+        case SnapshotResult::TooLarge:
+            return "snapshot holds more items than the inventory can store";
+    }
+    return "unknown error";
+}
+
+/*
+ * loadSnapshotData function definition:
+ *  - Checks the magic, version, section layout and checksum before touching the store.
+ *  - Verifies that the description offsets ascend and stay inside the blob.
+ *  - Appends all items with InventoryStore::appendColumns (block copies only;
+ *    a version 1 cost column is converted to cents first).
+ */
+SnapshotResult loadSnapshotData(const string_view data, InventoryStore& inventory, uint64_t* checksum) {
+    if (!isSnapshotData(data)) {
+        return SnapshotResult::NotASnapshot;
+    }
+    if (data.size() < sizeof(SnapshotHeader)) {
+        return SnapshotResult::Truncated;
+    }
+
+    SnapshotHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if ((header.version != SNAPSHOT_VERSION && header.version != DOUBLE_COSTS_VERSION)
+        || header.headerSize != sizeof(SnapshotHeader)) {
+        return SnapshotResult::UnsupportedVersion;
+    }
+
+    const uint64_t count = header.itemCount;
+    if (count > static_cast<uint64_t>(INT32_MAX)
+        || header.costsOffset != sizeof(SnapshotHeader)
+        || header.unitsOffset != header.costsOffset + count * sizeof(Money)
+        || header.offsetsOffset != alignTo8(header.unitsOffset + count * sizeof(int32_t))
+        || header.blobOffset != header.offsetsOffset + (count + 1) * sizeof(uint64_t)) {
+        return SnapshotResult::Corrupt;
+    }
+    if (header.blobSize > data.size() || header.blobOffset + header.blobSize > data.size()) {
+        return SnapshotResult::Truncated;
+    }
+    if (header.blobOffset + header.blobSize != data.size()) {
+        return SnapshotResult::Corrupt;
+    }
+    if (snapshotChecksum(data.substr(sizeof(SnapshotHeader))) != header.checksum) {
+        return SnapshotResult::ChecksumMismatch;
+    }
+
+    // Sections are 8-byte aligned within the file, and the mapping is page aligned.
+    const auto* costs = reinterpret_cast<const Money*>(data.data() + header.costsOffset);
+    const auto* units = reinterpret_cast<const int*>(data.data() + header.unitsOffset);
+    const auto* offsets = reinterpret_cast<const uint64_t*>(data.data() + header.offsetsOffset);
+
+    if (offsets[0] != 0 || offsets[count] != header.blobSize) {
+        return SnapshotResult::Corrupt;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        if (offsets[i] > offsets[i + 1]) {
+            return SnapshotResult::Corrupt;
+        }
+    }
+
+    vector<Money> converted;
+    if (header.version == DOUBLE_COSTS_VERSION) {
+        const auto* doubles = reinterpret_cast<const double*>(costs);
+        converted.resize(static_cast<size_t>(count));
+        for (uint64_t i = 0; i < count; ++i) {
+            if (!isfinite(doubles[i]) || !(fabs(doubles[i]) * Money::SCALE < 9.2e18)) {
+                return SnapshotResult::Corrupt;
+            }
+            converted[i] = Money::fromDouble(doubles[i]);
+        }
+        costs = converted.data();
+    }
+
+    if (!inventory.appendColumns(costs, units, offsets, data.substr(header.blobOffset, header.blobSize),
+                                 static_cast<size_t>(count))) {
+        return SnapshotResult::TooLarge;
+    }
+    if (checksum != nullptr) {
+        *checksum = header.checksum;
+    }
+    return SnapshotResult::Ok;
+}
+
+SnapshotResult loadSnapshotFile(const string& filename, InventoryStore& inventory, uint64_t* checksum) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        return SnapshotResult::CannotOpen;
+    }
+    return loadSnapshotData(file.view(), inventory, checksum);
+}
+
+/*
+ * forEachSnapshotSection function definition:
+ *  - Feeds the bytes that follow the header, in file order, to sink(string_view).
+ *  - Used twice by saveSnapshotFile: once to checksum, once to write.
+ *  - Units come from a copy taken once, so both passes see the same values even
+ *    if other threads change stock meanwhile; costs and descriptions never change.
+ */
+template <typename Sink>
+static void forEachSnapshotSection(const InventoryStore& inventory, const vector<int>& units,
+                                   const vector<uint64_t>& offsets, Sink&& sink) {
+    const size_t count = units.size();
+    static constexpr char zeros[8] = {};
+
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        sink(string_view(reinterpret_cast<const char*>(span.costs), span.count * sizeof(Money)));
+    }, count);
+    sink(string_view(reinterpret_cast<const char*>(units.data()), count * sizeof(int32_t)));
+    sink(string_view(zeros, alignTo8(count * sizeof(int32_t)) - count * sizeof(int32_t)));
+    sink(string_view(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t)));
+    for (size_t i = 0; i < count; ++i) {
+        sink(inventory.getDescription(static_cast<int>(i)));
+    }
+}
+
+/*
+ * saveSnapshotFile function definition:
+ *  - Builds the description offsets table and the header, checksums the sections,
+ *    then streams header and sections through an AtomicFileWriter.
+ */
+bool saveSnapshotFile(const InventoryStore& inventory, const string& filename, uint64_t* checksum) {
+    vector<int> units;
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        units.insert(units.end(), span.units, span.units + span.count);
+    });
+    const size_t count = units.size();
+
+    vector<uint64_t> offsets(count + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        offsets[i + 1] = offsets[i] + inventory.getDescription(static_cast<int>(i)).size();
+    }
+
+    SnapshotHeader header{};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.itemCount = count;
+    header.costsOffset = sizeof(SnapshotHeader);
+    header.unitsOffset = header.costsOffset + count * sizeof(Money);
+    header.offsetsOffset = alignTo8(header.unitsOffset + count * sizeof(int32_t));
+    header.blobOffset = header.offsetsOffset + (count + 1) * sizeof(uint64_t);
+    header.blobSize = offsets[count];
+
+    ChecksumBuilder builder;
+    forEachSnapshotSection(inventory, units, offsets, [&](const string_view bytes) { builder.update(bytes); });
+    header.checksum = builder.finish();
+
+    AtomicFileWriter writer;
+    if (!writer.open(filename)) {
+        return false;
+    }
+    writer.append(string_view(reinterpret_cast<const char*>(&header), sizeof(header)));
+    forEachSnapshotSection(inventory, units, offsets, [&](const string_view bytes) { writer.append(bytes); });
+    if (!writer.commit()) {
+        return false;
+    }
+    if (checksum != nullptr) {
+        *checksum = header.checksum;
+    }
+    return true;
+}
+
+/*
+ * saveSnapshot function definition:
+ *  - Prompts until the snapshot can be written, then reports size and time.
+ *  - The snapshot can be loaded back with 'i', 'b', 'l' or --load (the format is detected).
+ */
+void saveSnapshot(const InventoryStore& inventory) {
+    if (inventory.empty()) {
+        cout << "Inventory is empty. Nothing to write.\n";
+        return;
+    }
+
+    string filename;
+    while (true) {
+        cout << "Enter name of snapshot file: ";
+        cin >> filename;
+
+        const auto start = chrono::steady_clock::now();
+        if (saveSnapshotFile(inventory, filename)) {
+            const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << inventory.size() << " record(s) saved to snapshot \"" << filename << "\" in "
+                 << fixed << setprecision(2) << seconds * 1000.0 << " ms.\n";
+            return;
+        }
+
+        cout << "Error: Could not create file \"" << filename << "\". Please try again.\n";
+    }
+}
@@ -0,0 +1,85 @@
+// Specification File -> BinarySnapshot.h
+#ifndef BINARYSNAPSHOT_H
+#define BINARYSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "InventoryStore.h"
+
+using namespace std;
+
+/*
+    Binary Snapshot Format (version 2)
+    -----------------------------
+    Description:
+    A compact, versioned image of the whole inventory that loads without parsing.
+    All integers are little-endian; every section starts on an 8-byte boundary.
+
+        SnapshotHeader                 (72 bytes, see below)
+        int64    costs[itemCount]      in whole cents (version 1: double)
+        int32    units[itemCount]      (+ padding to 8 bytes)
+        uint64   offsets[itemCount+1]  description i = blob[offsets[i] .. offsets[i+1])
+        char     blob[blobSize]        all descriptions back to back
+
+    The checksum covers every byte after the header. Loading maps the file, checks
+    the header and checksum, then copies each column into the InventoryStore as one
+    block (see InventoryStore::appendColumns). Version 1 files, which held costs
+    as doubles, still load; their costs are rounded to the cent.
+
+    In Simpler Terms:
+    A save file that is a direct copy of the program's memory layout, so it can be
+    read back almost instantly.
+*/
+struct SnapshotHeader {
+    char magic[8];          // "INVSNAP" followed by a zero byte
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t itemCount;
+    uint64_t costsOffset;
+    uint64_t unitsOffset;
+    uint64_t offsetsOffset;
+    uint64_t blobOffset;
+    uint64_t blobSize;
+    uint64_t checksum;
+};
+
+constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+// Outcome of reading a snapshot.
+enum class SnapshotResult {
+    Ok,
+    CannotOpen,
+    NotASnapshot,
+    UnsupportedVersion,
+    Truncated,
+    ChecksumMismatch,
+    Corrupt,
+    TooLarge
+};
+
+// Short human-readable reason for a SnapshotResult.
+const char* describeSnapshotResult(SnapshotResult result);
+
+// True if data starts with the snapshot magic bytes (used to auto-detect the format).
+bool isSnapshotData(string_view data);
+
+// Checksum used by the format: a 4-lane, 64-bit multiply/rotate hash.
+uint64_t snapshotChecksum(string_view data);
+
+// Validates a snapshot image already in memory and appends its items to the inventory.
+// If checksum is given, it receives the snapshot's checksum (identifies this exact image).
+SnapshotResult loadSnapshotData(string_view data, InventoryStore& inventory, uint64_t* checksum = nullptr);
+
+// Maps filename and loads it with loadSnapshotData.
+SnapshotResult loadSnapshotFile(const string& filename, InventoryStore& inventory, uint64_t* checksum = nullptr);
+
+// Writes the inventory as a snapshot (replaced atomically). Returns false on failure.
+// If checksum is given, it receives the checksum stored in the new snapshot's header.
+bool saveSnapshotFile(const InventoryStore& inventory, const string& filename, uint64_t* checksum = nullptr);
+
+// 's' command handler: prompts for a file name and writes a snapshot.
+void saveSnapshot(const InventoryStore& inventory);
+
+#endif // BINARYSNAPSHOT_H
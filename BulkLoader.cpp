@@ -0,0 +1,167 @@
+// Implementation File -> BulkLoader.cpp
+#include "BulkLoader.h"
+#include "BinarySnapshot.h"
+#include "Metrics.h"
+#include <charconv>
+#include <chrono>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*
+ * MappedFile::open function definition:
+ *  - Maps the whole file read-only and hints the kernel that it will be read sequentially.
+ *  - Empty files are valid and produce an empty view.
+ *  - On platforms without mmap, the file is read into an owned buffer instead.
+ */
+bool MappedFile::open(const string& filename) {
+    close();
+
+#if defined(__unix__) || defined(__APPLE__)
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        madvise(address, length, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(address);
+        mapped = true;
+    }
+
+    ::close(fd); // The mapping stays valid after the descriptor is closed
+    countMetric(MetricCounter::BytesRead, length);
+    return true;
+#else
+    ifstream input(filename, ios::binary);
+    if (!input) {
+        return false;
+    }
+    fallback.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    data = fallback.data();
+    length = fallback.size();
+    countMetric(MetricCounter::BytesRead, length);
+    return true;
+#endif
+}
+
+/*
+ * MappedFile::close function definition:
+ *  - Unmaps the file (or frees the fallback buffer) and resets the view.
+ */
+void MappedFile::close() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapped) {
+        munmap(const_cast<char*>(data), length);
+    }
+#endif
+    fallback.clear();
+    data = nullptr;
+    length = 0;
+    mapped = false;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+double BulkLoadStats::megabytesPerSecond() const {
+    return seconds > 0.0 ? static_cast<double>(bytesScanned) / (1024.0 * 1024.0) / seconds : 0.0;
+}
+
+double BulkLoadStats::recordsPerSecond() const {
+    return seconds > 0.0 ? static_cast<double>(recordsLoaded) / seconds : 0.0;
+}
+
+// Removes leading and trailing blanks so " 12.50 " parses like stod() would accept it.
+static string_view trimBlanks(string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/*
+ * parseCostField / parseUnitsField function definitions:
+ *  - Convert a field with parseMoney / std::from_chars, which neither allocate
+ *    nor throw.
+ *  - The whole (trimmed) field must be consumed; "12abc" is rejected.
+ */
+bool parseCostField(string_view text, Money& cost) {
+    return parseMoney(trimBlanks(text), cost);
+}
+
+bool parseUnitsField(string_view text, int& units) {
+    text = trimBlanks(text);
+    if (!text.empty() && text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    const auto [last, error] = from_chars(text.data(), text.data() + text.size(), units);
+    return error == errc() && last == text.data() + text.size();
+}
+
+/*
+ * bulkLoadFile function definition:
+ *  - Maps the file, scans it with scanRecords() and appends each valid record.
+ *  - Reserves store capacity from the file size so appends do not reallocate repeatedly.
+ *  - Only the description is copied out of the mapping, straight into the store (no
+ *    allocation per record; repeated descriptions are stored once).
+ */
+bool bulkLoadFile(const string& filename, InventoryStore& inventory, BulkLoadStats& stats) {
+    const auto start = chrono::steady_clock::now();
+
+    MappedFile file;
+    if (!file.open(filename)) {
+        return false;
+    }
+
+    stats.bytesScanned = file.size();
+
+    if (isSnapshotData(file.view())) {
+        const int before = inventory.size();
+        const SnapshotResult result = loadSnapshotData(file.view(), inventory);
+        stats.snapshot = true;
+        stats.recordsLoaded = static_cast<size_t>(inventory.size() - before);
+        stats.formatError = result == SnapshotResult::Ok ? nullptr : describeSnapshotResult(result);
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        countMetric(MetricCounter::RecordsParsed, stats.recordsLoaded);
+        countMetricTime(MetricCounter::ParseNanoseconds, start);
+        return true;
+    }
+
+    inventory.reserveForFile(file.size());
+    scanRecords(file.view(), stats, [&](const ParsedRecord& record) {
+        return inventory.addItem(record.description, record.cost, record.units) >= 0;
+    });
+    if (stats.stoppedEarly) {
+        stats.formatError = inventory.lastFailure();
+    }
+
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    countMetric(MetricCounter::RecordsParsed, stats.recordsLoaded);
+    countMetricTime(MetricCounter::ParseNanoseconds, start);
+    return true;
+}
@@ -0,0 +1,239 @@
+// Specification File -> BulkLoader.h
+#ifndef BULKLOADER_H
+#define BULKLOADER_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InventoryStore.h"
+#include "RecordSchema.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+/*
+    MappedFile
+    -----------------------------
+    Description:
+    Read-only view of a whole file. On POSIX systems the file is memory-mapped so
+    the loader can parse it in place without copying it through a stream buffer;
+    elsewhere the contents are read into an owned buffer once.
+
+    In Simpler Terms:
+    Lets the program look at a file's bytes directly, as if it were one big string.
+*/
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Opens and maps the file. Returns false if it cannot be opened or mapped.
+    bool open(const string& filename);
+
+    // Releases the mapping (safe to call more than once).
+    void close();
+
+    string_view view() const { return {data, length}; }
+    size_t size() const { return length; }
+
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    vector<char> fallback; // Used when the file cannot be memory-mapped
+};
+
+/*
+    BulkLoadStats
+    -----------------------------
+    Description:
+    Counters collected during a bulk load, used to report throughput to the user.
+*/
+struct BulkLoadStats {
+    size_t bytesScanned = 0;
+    size_t recordsLoaded = 0;
+    size_t recordsRejected = 0;
+    double seconds = 0.0;
+    bool stoppedEarly = false; // The consumer refused a record and scanning stopped
+    bool snapshot = false;     // The file was a binary snapshot (see BinarySnapshot.h)
+    const char* formatError = nullptr; // Why a binary snapshot was rejected, or loading stopped
+
+    double megabytesPerSecond() const;
+    double recordsPerSecond() const;
+};
+
+// One well-formed record; the description points into the scanned buffer.
+struct ParsedRecord {
+    string_view description;
+    Money cost;
+    int units = 0;
+};
+
+/*
+    DelimiterScanner
+    -----------------------------
+    Description:
+    Finds every '|' and '\n' in a buffer, in order. The buffer is examined 64 bytes
+    at a time: each block is compared against both delimiters with SSE2 and folded
+    into a 64-bit mask, and next() then pops one set bit per call. Blocks shorter
+    than 64 bytes (the tail of the buffer) are classified one byte at a time.
+
+    In Simpler Terms:
+    Jumps straight from one separator to the next instead of testing every character.
+*/
+class DelimiterScanner {
+public:
+    DelimiterScanner(const char* begin, const char* end) : block(begin), end(end) {
+        loadBlock();
+    }
+
+    // Returns the next delimiter position, or end once the buffer is exhausted.
+    const char* next() {
+        while (mask == 0) {
+            if (end - block <= 64) {
+                block = end;
+                return end;
+            }
+            block += 64;
+            loadBlock();
+        }
+        const char* found = block + countr_zero(mask);
+        mask &= mask - 1;
+        return found;
+    }
+
+private:
+    const char* block;
+    const char* end;
+    uint64_t mask = 0;
+
+    void loadBlock() {
+        mask = 0;
+        if (end - block >= 64) {
+#if defined(__SSE2__)
+            const __m128i pipe = _mm_set1_epi8('|');
+            const __m128i newline = _mm_set1_epi8('\n');
+            for (int lane = 0; lane < 4; ++lane) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + lane * 16));
+                const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, pipe), _mm_cmpeq_epi8(chunk, newline));
+                mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(hits))) << (lane * 16);
+            }
+            return;
+#endif
+        }
+        const ptrdiff_t count = end - block < 64 ? end - block : 64;
+        for (ptrdiff_t i = 0; i < count; ++i) {
+            if (block[i] == '|' || block[i] == '\n') {
+                mask |= uint64_t{1} << i;
+            }
+        }
+    }
+};
+
+/*
+    splitRecordLines
+    -----------------------------
+    Description:
+    Walks a buffer line by line with the DelimiterScanner and calls
+    onLine(lineStart, lineEnd, pipes, pipeCount) for each line: pipes holds the
+    first FIELDS '|' of the line and pipeCount how many it has in all (lineEnd
+    excludes the newline and a '\r' before it). Stops early if onLine returns
+    false. Feed the pieces to RecordSchema::parseLine.
+*/
+template <size_t FIELDS, typename OnLine>
+void splitRecordLines(const string_view buffer, OnLine&& onLine) {
+    const char* const end = buffer.data() + buffer.size();
+    DelimiterScanner scanner(buffer.data(), end);
+
+    const char* lineStart = buffer.data();
+    const char* pipes[FIELDS];
+    int pipeCount = 0;
+
+    while (lineStart < end) {
+        const char* delimiter = scanner.next();
+
+        if (delimiter != end && *delimiter == '|') {
+            if (pipeCount < static_cast<int>(FIELDS)) {
+                pipes[pipeCount] = delimiter;
+            }
+            ++pipeCount;
+            continue;
+        }
+
+        // delimiter is a newline or the end of the buffer: the line is complete.
+        const char* lineEnd = delimiter;
+        if (lineEnd > lineStart && lineEnd[-1] == '\r') {
+            --lineEnd;
+        }
+        if (!onLine(lineStart, lineEnd, static_cast<const char* const*>(pipes), pipeCount)) {
+            return;
+        }
+
+        pipeCount = 0;
+        lineStart = delimiter + 1;
+    }
+}
+
+/*
+    scanRecords
+    -----------------------------
+    Description:
+    Walks a buffer in a record layout (by default index|description|cost|units,
+    see RecordSchema.h) and calls onRecord for every valid line. Lines need
+    every column of the layout (extra columns are ignored), numeric cost and
+    units, and units in 0–30; 'i' checks the same fields against the
+    configurable import rules instead (see ImportValidator.h). Invalid lines
+    are counted in stats.recordsRejected. If onRecord returns false the
+    record is not counted, stats.stoppedEarly is set and scanning stops.
+*/
+template <typename Schema = InventoryRecordSchema, typename Callback>
+void scanRecords(const string_view buffer, BulkLoadStats& stats, Callback&& onRecord) {
+    static_assert(Schema::template HAS<DescriptionField> && Schema::template HAS<CostField> &&
+                  Schema::template HAS<UnitsField>, "Loading needs description, cost and units columns");
+
+    splitRecordLines<Schema::FIELDS>(buffer, [&](const char* lineStart, const char* lineEnd,
+                                                 const char* const* pipes, const int pipeCount) {
+        typename Schema::Record fields;
+        const bool valid = pipeCount + 1 >= static_cast<int>(Schema::FIELDS) &&
+                           Schema::parseLine(lineStart, lineEnd, pipes, pipeCount, fields) == Schema::FIELDS &&
+                           fields.template get<UnitsField>() >= 0 && fields.template get<UnitsField>() <= MAX_UNITS;
+        if (!valid) {
+            ++stats.recordsRejected;
+            return true;
+        }
+
+        const ParsedRecord record{fields.template get<DescriptionField>(), fields.template get<CostField>(),
+                                  fields.template get<UnitsField>()};
+        if (!onRecord(record)) {
+            stats.stoppedEarly = true;
+            return false;
+        }
+        ++stats.recordsLoaded;
+        return true;
+    });
+}
+
+/*
+    bulkLoadFile
+    -----------------------------
+    Description:
+    Memory-maps filename and appends every valid record to the inventory store,
+    reserving space from the file size first. Fills stats with the bytes scanned,
+    records loaded/rejected and elapsed time. Binary snapshots are detected by
+    their magic bytes and loaded as a whole instead.
+
+    Returns:
+    false if the file could not be opened; true otherwise.
+*/
+bool bulkLoadFile(const string& filename, InventoryStore& inventory, BulkLoadStats& stats);
+
+#endif // BULKLOADER_H
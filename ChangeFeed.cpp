@@ -0,0 +1,579 @@
+// Implementation File -> ChangeFeed.cpp
+#include "ChangeFeed.h"
+#include "Server.h"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+bool parseFeedPolicy(const string_view name, FeedPolicy& policy) {
+    if (name == "overwrite") {
+        policy = FeedPolicy::Overwrite;
+    } else if (name == "block") {
+        policy = FeedPolicy::Block;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* describeFeedPolicy(const FeedPolicy policy) {
+    return policy == FeedPolicy::Block ? "block" : "overwrite";
+}
+
+/*
+ * ChangeFeed constructor definition:
+ *  - Allocates the ring up front; nothing is allocated per change afterwards.
+ *  - Items already in the store are not announced: the feed carries changes.
+ */
+ChangeFeed::ChangeFeed(InventoryStore& store, const size_t capacity, const FeedPolicy policy)
+    : store(store),
+      feedPolicy(policy),
+      mask(bit_ceil(max<size_t>(capacity, 2)) - 1),
+      slots(make_unique<Slot[]>(mask + 1)) {
+    for (atomic<uint64_t>& cursor : cursors) {
+        cursor.store(UNUSED, memory_order_relaxed);
+    }
+    store.addObserver(this);
+}
+
+ChangeFeed::~ChangeFeed() {
+    store.removeObserver(this);
+}
+
+/*
+ * subscribe function definition:
+ *  - Takes a free place with its cursor at 0 first, so a Block writer that looks
+ *    meanwhile waits rather than overtaking, then starts the cursor at the next
+ *    change to be published.
+ */
+unique_ptr<ChangeSubscription> ChangeFeed::subscribe() {
+    for (size_t place = 0; place < MAX_SUBSCRIBERS; ++place) {
+        uint64_t expected = UNUSED;
+        if (cursors[place].compare_exchange_strong(expected, 0)) {
+            dropped[place].store(false);
+            const uint64_t start = nextSequence.load();
+            cursors[place].store(start);
+            return unique_ptr<ChangeSubscription>(new ChangeSubscription(*this, place, start));
+        }
+    }
+    return nullptr;
+}
+
+// Lowest cursor of the subscribers not dropped, or head if there are none.
+uint64_t ChangeFeed::slowestCursor(const uint64_t head) const {
+    uint64_t slowest = head;
+    for (size_t place = 0; place < MAX_SUBSCRIBERS; ++place) {
+        const uint64_t position = cursors[place].load();
+        if (position != UNUSED && !dropped[place].load()) slowest = min(slowest, position);
+    }
+    return slowest;
+}
+
+// Drops every subscriber whose cursor keeps sequence `last` from being written.
+void ChangeFeed::dropSubscribersBehind(const uint64_t last) {
+    for (size_t place = 0; place < MAX_SUBSCRIBERS; ++place) {
+        const uint64_t position = cursors[place].load();
+        if (position != UNUSED && last >= position + capacity() && !dropped[place].exchange(true)) {
+            dropCount.fetch_add(1, memory_order_relaxed);
+        }
+    }
+}
+
+/*
+ * claim function definition:
+ *  - Reserves count consecutive sequence numbers (count <= capacity) with one
+ *    atomic add.
+ *  - Block: the last one's slot last held the event a whole ring earlier, so it
+ *    may only be reused once every subscriber has read past that. The lowest
+ *    cursor is cached and only looked up again when the cache says "full";
+ *    waiting yields, then sleeps briefly. After MAX_BLOCK_WAIT the subscribers
+ *    still in the way are dropped and the change goes ahead.
+ */
+uint64_t ChangeFeed::claim(const uint64_t count) {
+    const uint64_t first = nextSequence.fetch_add(count);
+    if (feedPolicy != FeedPolicy::Block) {
+        return first;
+    }
+    const uint64_t last = first + count - 1;
+    if (last < gatingSequence.load(memory_order_acquire) + capacity()) {
+        return first;
+    }
+    chrono::steady_clock::time_point waitStart;
+    for (int attempt = 0;; ++attempt) {
+        const uint64_t slowest = slowestCursor(first + count);
+        gatingSequence.store(slowest, memory_order_release);
+        if (last < slowest + capacity()) {
+            return first;
+        }
+        if (attempt == 0) {
+            stallCount.fetch_add(1, memory_order_relaxed);
+            waitStart = chrono::steady_clock::now();
+        }
+        if (attempt < 64) {
+            this_thread::yield();
+        } else if (chrono::steady_clock::now() - waitStart < MAX_BLOCK_WAIT) {
+            this_thread::sleep_for(chrono::microseconds(50));
+        } else {
+            dropSubscribersBehind(last);
+        }
+    }
+}
+
+/*
+ * write function definition:
+ *  - Marks the slot BUSY (waiting out another writer of the same slot), fills
+ *    it, then publishes it by storing its sequence number.
+ *  - Overwrite: if a writer a whole ring later got to the slot first, this event
+ *    is already overwritten and is dropped; readers count it as missed.
+ */
+void ChangeFeed::write(const uint64_t sequence, const ChangeKind kind, const int itemNum, const int oldUnits,
+                       const int newUnits, const Money cost) {
+    Slot& slot = slots[sequence & mask];
+    uint64_t previous = slot.sequence.load(memory_order_relaxed);
+    for (;;) {
+        if (previous == BUSY) {
+            this_thread::yield();
+            previous = slot.sequence.load(memory_order_relaxed);
+            continue;
+        }
+        if (previous > sequence) {
+            return;
+        }
+        if (slot.sequence.compare_exchange_weak(previous, BUSY, memory_order_relaxed)) {
+            break;
+        }
+    }
+    atomic_thread_fence(memory_order_release);
+    slot.kind.store(static_cast<uint8_t>(kind), memory_order_relaxed);
+    slot.itemNum.store(itemNum, memory_order_relaxed);
+    slot.oldUnits.store(oldUnits, memory_order_relaxed);
+    slot.newUnits.store(newUnits, memory_order_relaxed);
+    slot.cents.store(cost.cents, memory_order_relaxed);
+    slot.sequence.store(sequence, memory_order_release);
+}
+
+/*
+ * wakeSubscribers function definition:
+ *  - The fence pairs with the one in ChangeSubscription::wait: either the writer
+ *    sees the sleeper, or the sleeper sees the event before going to sleep.
+ */
+void ChangeFeed::wakeSubscribers() {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (sleepers.load(memory_order_relaxed) > 0) {
+        lock_guard lock(wakeMutex);
+        wakeUp.notify_all();
+    }
+}
+
+/*
+ * onItemsAdded function definition:
+ *  - One event per new item; a bulk load claims a ring's worth of numbers at a
+ *    time and wakes the subscribers once per batch.
+ */
+void ChangeFeed::onItemsAdded(const InventoryStore& inventory, const int firstItem, const int count) {
+    for (int done = 0; done < count;) {
+        const int batch = static_cast<int>(min<size_t>(static_cast<size_t>(count - done), capacity()));
+        const uint64_t first = claim(static_cast<uint64_t>(batch));
+        for (int i = 0; i < batch; ++i) {
+            const int itemNum = firstItem + done + i;
+            write(first + static_cast<uint64_t>(i), ChangeKind::ItemAdded, itemNum, 0, inventory.getUnits(itemNum),
+                  inventory.getCost(itemNum));
+        }
+        wakeSubscribers();
+        done += batch;
+    }
+}
+
+void ChangeFeed::onUnitsChanged(const InventoryStore& inventory, const int itemNum, const int oldUnits,
+                                const int newUnits) {
+    write(claim(1), ChangeKind::UnitsChanged, itemNum, oldUnits, newUnits, inventory.getCost(itemNum));
+    wakeSubscribers();
+}
+
+// The lines of a transaction get consecutive sequence numbers.
+void ChangeFeed::onUnitsChangedTogether(const InventoryStore& inventory, const UnitsChange* changes,
+                                        const size_t count) {
+    for (size_t done = 0; done < count;) {
+        const size_t batch = min(count - done, capacity());
+        const uint64_t first = claim(batch);
+        for (size_t i = 0; i < batch; ++i) {
+            const UnitsChange& change = changes[done + i];
+            write(first + i, ChangeKind::UnitsChanged, change.itemNum, change.oldUnits, change.newUnits,
+                  inventory.getCost(change.itemNum));
+        }
+        wakeSubscribers();
+        done += batch;
+    }
+}
+
+ChangeSubscription::~ChangeSubscription() {
+    feed.cursors[place].store(ChangeFeed::UNUSED);
+}
+
+/*
+ * poll function definition:
+ *  - Reads slot by slot from the cursor: a slot holding the cursor's number is
+ *    copied, and kept only if its number is unchanged afterwards (otherwise it
+ *    was rewritten meanwhile). A lower number (or BUSY) means the event is not
+ *    published yet; a higher one that the subscriber was lapped.
+ *  - After a lap, resumes at the oldest event the ring can still hold.
+ *  - Publishes the new cursor once, at the end. A dropped subscriber that has
+ *    read everything published is waited for again from then on.
+ */
+size_t ChangeSubscription::poll(ChangeEvent* events, const size_t maxEvents) {
+    size_t count = 0;
+    while (count < maxEvents) {
+        ChangeFeed::Slot& slot = feed.slots[cursor & feed.mask];
+        const uint64_t seen = slot.sequence.load(memory_order_acquire);
+        if (seen == cursor) {
+            ChangeEvent& event = events[count];
+            event.kind = static_cast<ChangeKind>(slot.kind.load(memory_order_relaxed));
+            event.itemNum = slot.itemNum.load(memory_order_relaxed);
+            event.oldUnits = slot.oldUnits.load(memory_order_relaxed);
+            event.newUnits = slot.newUnits.load(memory_order_relaxed);
+            event.cost = Money::fromCents(slot.cents.load(memory_order_relaxed));
+            atomic_thread_fence(memory_order_acquire);
+            if (slot.sequence.load(memory_order_relaxed) == seen) {
+                event.sequence = cursor++;
+                ++count;
+                continue;
+            }
+        } else if (seen == ChangeFeed::BUSY || seen < cursor) {
+            if (count == 0 && feed.dropped[place].load(memory_order_relaxed)) {
+                feed.dropped[place].store(false, memory_order_release);
+            }
+            break;
+        }
+
+        if (count > 0) {
+            break;
+        }
+        const uint64_t head = feed.nextSequence.load(memory_order_acquire);
+        const uint64_t resume = max(cursor + 1, head > feed.capacity() ? head - feed.capacity() : 1);
+        missedEvents += resume - cursor;
+        cursor = resume;
+    }
+    feed.cursors[place].store(cursor, memory_order_release);
+    return count;
+}
+
+bool ChangeSubscription::wait(const chrono::microseconds timeout) {
+    return feed.waitFor(cursor, timeout);
+}
+
+// True if the slot of sequence holds it (or a later event, which laps it).
+bool ChangeFeed::isPublished(const uint64_t sequence) const {
+    const uint64_t seen = slots[sequence & mask].sequence.load(memory_order_acquire);
+    return seen != BUSY && seen >= sequence;
+}
+
+/*
+ * waitFor function definition:
+ *  - Announces itself as a sleeper before the last look at the ring (see
+ *    wakeSubscribers), so a change published in between wakes it.
+ */
+bool ChangeFeed::waitFor(const uint64_t sequence, const chrono::microseconds timeout) {
+    if (isPublished(sequence)) {
+        return true;
+    }
+    unique_lock lock(wakeMutex);
+    sleepers.fetch_add(1);
+    atomic_thread_fence(memory_order_seq_cst);
+    const bool woken = wakeUp.wait_for(lock, timeout, [&] { return isPublished(sequence); });
+    sleepers.fetch_sub(1);
+    return woken;
+}
+
+static void appendNumber(string& out, const long long value) {
+    char digits[24];
+    out.append(digits, static_cast<size_t>(to_chars(digits, digits + sizeof(digits), value).ptr - digits));
+}
+
+void appendChangeLine(string& out, const ChangeEvent& event) {
+    appendNumber(out, static_cast<long long>(event.sequence));
+    out += event.kind == ChangeKind::ItemAdded ? "|n|" : "|u|";
+    appendNumber(out, event.itemNum);
+    out += '|';
+    appendNumber(out, event.oldUnits);
+    out += '|';
+    appendNumber(out, event.newUnits);
+    out += '|';
+    char cost[MONEY_CHARS];
+    out.append(cost, formatMoney(cost, event.cost));
+    out += '\n';
+}
+
+void appendGapLine(string& out, const uint64_t firstMissed, const uint64_t count) {
+    appendNumber(out, static_cast<long long>(firstMissed));
+    out += "|gap|";
+    appendNumber(out, static_cast<long long>(count));
+    out += '\n';
+}
+
+// Events a sink takes from its subscription at a time, and how long it sleeps
+// when there are none (it also checks for new clients and for stopping then).
+static constexpr size_t SINK_BATCH = 4096;
+static constexpr chrono::microseconds SINK_IDLE_WAIT{10000};
+
+/*
+ * pollLines function definition:
+ *  - Polls one batch and appends it as lines, preceded by a gap line if the
+ *    subscription skipped events. Returns false if there was nothing to write.
+ */
+static bool pollLines(ChangeSubscription& subscription, vector<ChangeEvent>& events, string& out) {
+    const uint64_t position = subscription.position();
+    const uint64_t missedBefore = subscription.missed();
+    const size_t count = subscription.poll(events.data(), events.size());
+    if (subscription.missed() != missedBefore) {
+        appendGapLine(out, position, subscription.missed() - missedBefore);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        appendChangeLine(out, events[i]);
+    }
+    return count > 0 || subscription.missed() != missedBefore;
+}
+
+namespace {
+struct ActiveFeed {
+    unique_ptr<ChangeFeed> feed;
+    atomic<bool> stopping{false};
+    atomic<uint64_t> missed{0};      // By every sink subscriber, for the summary
+    atomic<uint64_t> clients{0};
+    atomic<uint64_t> dropped{0};     // Clients disconnected for being too slow (Block)
+    vector<thread> sinks;
+};
+
+unique_ptr<ActiveFeed> activeFeed;
+}
+
+/*
+ * runFileSink function definition:
+ *  - Appends every batch to the file and flushes it, so a reader tailing the file
+ *    sees each change as soon as the sink has it.
+ *  - Reads the stop flag before polling, so everything published before the stop
+ *    is written.
+ */
+static void runFileSink(unique_ptr<ChangeSubscription> subscription, FILE* file, ActiveFeed& active) {
+    vector<ChangeEvent> events(SINK_BATCH);
+    string lines;
+    for (;;) {
+        const bool stopping = active.stopping.load(memory_order_acquire);
+        lines.clear();
+        if (!pollLines(*subscription, events, lines)) {
+            if (stopping) break;
+            subscription->wait(SINK_IDLE_WAIT);
+            continue;
+        }
+        fwrite(lines.data(), 1, lines.size(), file);
+        fflush(file);
+    }
+    active.missed.fetch_add(subscription->missed(), memory_order_relaxed);
+    fclose(file);
+}
+
+#if defined(__linux__)
+
+// Output waiting for one client beyond which its subscription is not polled; the
+// ring then moves on without it (Overwrite) or waits for it (Block), until the
+// feed drops it and the sink disconnects it.
+static constexpr size_t MAX_CLIENT_OUTPUT = 1 << 20;
+
+namespace {
+struct FeedClient {
+    int fd = -1;
+    unique_ptr<ChangeSubscription> subscription;
+    string output;
+    size_t written = 0;
+};
+}
+
+// Sends what the socket takes. Returns false on a socket error.
+static bool flushClient(FeedClient& client) {
+    while (client.written < client.output.size()) {
+        const ssize_t count = send(client.fd, client.output.data() + client.written,
+                                   client.output.size() - client.written, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        client.written += static_cast<size_t>(count);
+    }
+    client.output.clear();
+    client.written = 0;
+    return true;
+}
+
+// False once the client has closed its side (anything it sends is ignored).
+static bool clientOpen(const FeedClient& client) {
+    char ignored[256];
+    for (;;) {
+        const ssize_t count = recv(client.fd, ignored, sizeof(ignored), 0);
+        if (count > 0) continue;
+        if (count == 0) return false;
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+}
+
+/*
+ * runSocketSink function definition:
+ *  - One thread serves every client: accepts new ones (each gets its own
+ *    subscription), polls each client's subscription while its output is below
+ *    MAX_CLIENT_OUTPUT and sends what the socket takes.
+ *  - A client whose subscription the feed dropped (Block: it held changes up
+ *    for MAX_BLOCK_WAIT) is disconnected; it can reconnect and resync.
+ *  - When idle it sleeps on the feed until the next change any client is
+ *    waiting for (which wakes it at once), or on the sockets when a client's
+ *    output is backed up.
+ */
+static void runSocketSink(const int listenFd, const bool tcp, ActiveFeed& active) {
+    vector<FeedClient> clients;
+    vector<ChangeEvent> events(SINK_BATCH);
+    for (;;) {
+        const bool stopping = active.stopping.load(memory_order_acquire);
+        for (int fd; (fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0;) {
+            unique_ptr<ChangeSubscription> subscription = active.feed->subscribe();
+            if (!subscription) {
+                static constexpr char refusal[] = "ERR too many subscribers\n";
+                [[maybe_unused]] const ssize_t ignored = send(fd, refusal, sizeof(refusal) - 1, MSG_NOSIGNAL);
+                close(fd);
+                continue;
+            }
+            if (tcp) {
+                const int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            }
+            FeedClient& client = clients.emplace_back();
+            client.fd = fd;
+            client.subscription = move(subscription);
+            active.clients.fetch_add(1, memory_order_relaxed);
+        }
+
+        bool busy = false;
+        bool backedUp = false;
+        uint64_t nextWanted = UINT64_MAX;
+        for (size_t c = 0; c < clients.size();) {
+            FeedClient& client = clients[c];
+            const bool tooSlow = client.subscription->dropped();
+            if (!tooSlow && client.output.size() - client.written < MAX_CLIENT_OUTPUT) {
+                busy |= pollLines(*client.subscription, events, client.output);
+            }
+            if (tooSlow) {
+                active.dropped.fetch_add(1, memory_order_relaxed);
+            }
+            if (tooSlow || !clientOpen(client) || !flushClient(client)) {
+                active.missed.fetch_add(client.subscription->missed(), memory_order_relaxed);
+                close(client.fd);
+                clients[c] = move(clients.back());
+                clients.pop_back();
+                continue;
+            }
+            backedUp |= client.written < client.output.size();
+            nextWanted = min(nextWanted, client.subscription->position());
+            ++c;
+        }
+
+        if (busy) continue;
+        if (stopping) break;
+        if (clients.empty() || backedUp) {
+            vector<pollfd> watched{{listenFd, POLLIN, 0}};
+            for (const FeedClient& client : clients) {
+                if (client.written < client.output.size()) watched.push_back({client.fd, POLLOUT, 0});
+            }
+            poll(watched.data(), watched.size(), clients.empty() ? 10 : 1);
+        } else {
+            active.feed->waitFor(nextWanted, SINK_IDLE_WAIT);
+        }
+    }
+
+    for (FeedClient& client : clients) {
+        flushClient(client);
+        active.missed.fetch_add(client.subscription->missed(), memory_order_relaxed);
+        close(client.fd);
+    }
+    close(listenFd);
+}
+
+#endif
+
+/*
+ * startChangeFeed function definition:
+ *  - Opens both sinks before the feed starts observing, so a sink that cannot
+ *    start leaves nothing behind.
+ *  - The file sink subscribes here, before any change can be published.
+ */
+bool startChangeFeed(InventoryStore& inventory, const ChangeFeedOptions& options) {
+    FILE* file = nullptr;
+    if (!options.file.empty()) {
+        file = fopen(options.file.c_str(), "ab");
+        if (file == nullptr) {
+            cout << "Error: Could not open change feed file \"" << options.file << "\".\n";
+            return false;
+        }
+    }
+
+    int listenFd = -1;
+    bool tcp = true;
+    if (!options.address.empty()) {
+        string error;
+        listenFd = openListener(options.address, tcp, error);
+        if (listenFd < 0) {
+            cout << "Error: Could not listen on \"" << options.address << "\" for the change feed: " << error
+                 << ".\n";
+            if (file != nullptr) fclose(file);
+            return false;
+        }
+    }
+
+    activeFeed = make_unique<ActiveFeed>();
+    activeFeed->feed = make_unique<ChangeFeed>(inventory, options.capacity, options.policy);
+    if (file != nullptr) {
+        activeFeed->sinks.emplace_back(runFileSink, activeFeed->feed->subscribe(), file, ref(*activeFeed));
+    }
+#if defined(__linux__)
+    if (listenFd >= 0) {
+        activeFeed->sinks.emplace_back(runSocketSink, listenFd, tcp, ref(*activeFeed));
+    }
+#endif
+
+    cout << "Change feed: " << activeFeed->feed->capacity() << "-event ring ("
+         << describeFeedPolicy(options.policy) << ")";
+    if (file != nullptr) cout << ", appending to \"" << options.file << "\"";
+    if (listenFd >= 0) cout << ", serving " << options.address;
+    cout << ".\n";
+    return true;
+}
+
+void stopChangeFeed() {
+    if (!activeFeed) {
+        return;
+    }
+    activeFeed->stopping.store(true, memory_order_release);
+    for (thread& sink : activeFeed->sinks) {
+        sink.join();
+    }
+
+    const ChangeFeed& feed = *activeFeed->feed;
+    cout << "Change feed: " << feed.published() << " change(s) published";
+    if (activeFeed->clients.load() > 0) cout << ", " << activeFeed->clients.load() << " client(s) served";
+    if (activeFeed->missed.load() > 0) cout << ", " << activeFeed->missed.load() << " missed by slow subscribers";
+    if (feed.stalls() > 0) cout << ", " << feed.stalls() << " change(s) waited for subscribers";
+    if (feed.drops() > 0) cout << ", " << feed.drops() << " slow subscriber(s) dropped";
+    if (activeFeed->dropped.load() > 0) cout << " (" << activeFeed->dropped.load() << " client(s) disconnected)";
+    cout << ".\n";
+    activeFeed.reset();
+}
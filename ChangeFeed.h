@@ -0,0 +1,250 @@
+// Specification File -> ChangeFeed.h
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InventoryStore.h"
+
+using namespace std;
+
+// What a change event reports.
+enum class ChangeKind : uint8_t {
+    ItemAdded,      // A new item (newUnits is its stock, oldUnits 0)
+    UnitsChanged    // An item's units went from oldUnits to newUnits
+};
+
+// One change, numbered in the order the feed received it (from 1, no gaps).
+struct ChangeEvent {
+    uint64_t sequence = 0;
+    ChangeKind kind = ChangeKind::UnitsChanged;
+    int itemNum = 0;
+    int oldUnits = 0;
+    int newUnits = 0;
+    Money cost;
+};
+
+// What happens when the slowest subscriber is a whole ring behind.
+enum class FeedPolicy : uint8_t {
+    Overwrite,  // Changes never wait; the subscriber skips what was overwritten (missed())
+    Block       // Changes wait until every subscriber has made room, up to MAX_BLOCK_WAIT
+};
+
+// "overwrite" / "block" to a policy; false if the name is unknown.
+bool parseFeedPolicy(string_view name, FeedPolicy& policy);
+const char* describeFeedPolicy(FeedPolicy policy);
+
+class ChangeSubscription;
+
+/*
+    ChangeFeed
+    -----------------------------
+    Description:
+    An in-process stream of every change made to an InventoryStore, for
+    consumers (an ERP bridge, dashboards) that want the deltas as they happen
+    instead of rescanning exports. As an InventoryObserver it turns each change
+    into a ChangeEvent and publishes it into a bounded ring of capacity slots
+    (a power of two).
+
+    The ring is lock-free on both sides. A change claims its sequence number with
+    one atomic add and fills its slot; the slot's own sequence number, written
+    last, publishes it (a writer marks the slot busy first, so a reader that
+    raced with a rewrite notices and drops what it read). Changes to one item
+    are numbered in the order they applied.
+
+    Any number of subscribers (up to MAX_SUBSCRIBERS) read the same ring, each
+    at its own pace with its own cursor, starting from the changes made after
+    they subscribed. When the slowest one falls a whole ring behind, the policy
+    decides: Overwrite keeps changes from ever waiting, and that subscriber
+    skips ahead and counts what it missed (it should resync from an export);
+    Block makes the changing thread wait for room, so a subscriber that keeps
+    up loses nothing. Under Block one slow subscriber stalls every thread that
+    changes stock, so the wait is bounded: a subscriber that holds a change up
+    for MAX_BLOCK_WAIT is dropped (dropped()), the ring stops waiting for it and
+    it goes on as under Overwrite until it has caught up again.
+
+    A subscriber waits for events with wait(); the changing thread only takes
+    the wake-up lock when a subscriber is actually asleep, so a busy feed costs
+    writers one atomic add, a slot write and one load per change.
+
+    Must be created, like any observer, before the store is shared between
+    threads; subscriptions may come and go at any time.
+
+    In Simpler Terms:
+    A ticker tape of every stock movement that any number of readers can follow
+    at their own speed.
+*/
+class ChangeFeed : public InventoryObserver {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
+    static constexpr size_t MAX_SUBSCRIBERS = 32;
+    static constexpr chrono::milliseconds MAX_BLOCK_WAIT{250};
+
+    // Rounds capacity up to a power of two (at least 2) and starts observing the store.
+    explicit ChangeFeed(InventoryStore& store, size_t capacity = DEFAULT_CAPACITY,
+                        FeedPolicy policy = FeedPolicy::Overwrite);
+    ~ChangeFeed() override;
+
+    ChangeFeed(const ChangeFeed&) = delete;
+    ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+    // A new subscriber that reads every change from now on; nullptr if
+    // MAX_SUBSCRIBERS are subscribed already. Must not outlive the feed.
+    unique_ptr<ChangeSubscription> subscribe();
+
+    size_t capacity() const { return mask + 1; }
+    FeedPolicy policy() const { return feedPolicy; }
+
+    // Changes published so far.
+    uint64_t published() const { return nextSequence.load(memory_order_acquire) - 1; }
+
+    // Times a change had to wait for a subscriber (Block only).
+    uint64_t stalls() const { return stallCount.load(memory_order_relaxed); }
+
+    // Times a subscriber was dropped for holding a change up too long (Block only).
+    uint64_t drops() const { return dropCount.load(memory_order_relaxed); }
+
+    // Waits until the event numbered sequence is published or timeout passes;
+    // returns true if it is. Lets one thread serving several subscribers sleep
+    // until any of them has something to read.
+    bool waitFor(uint64_t sequence, chrono::microseconds timeout);
+
+    void onItemsAdded(const InventoryStore& store, int firstItem, int count) override;
+    void onUnitsChanged(const InventoryStore& store, int itemNum, int oldUnits, int newUnits) override;
+    void onUnitsChangedTogether(const InventoryStore& store, const UnitsChange* changes, size_t count) override;
+
+private:
+    friend class ChangeSubscription;
+
+    // The slot's sequence number is BUSY while a writer fills it, EMPTY before
+    // its first event.
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr uint64_t BUSY = UINT64_MAX;
+    static constexpr uint64_t UNUSED = UINT64_MAX;  // Cursor of a free subscriber place
+
+    // Every field is atomic so a reader may race with a rewrite (it then discards what it read).
+    struct Slot {
+        atomic<uint64_t> sequence{EMPTY};
+        atomic<int> itemNum{0};
+        atomic<int> oldUnits{0};
+        atomic<int> newUnits{0};
+        atomic<int64_t> cents{0};
+        atomic<uint8_t> kind{0};
+    };
+
+    InventoryStore& store;
+    const FeedPolicy feedPolicy;
+    const size_t mask;
+    unique_ptr<Slot[]> slots;
+    atomic<uint64_t> nextSequence{1};
+
+    // Next sequence each subscriber will read (UNUSED if the place is free), and
+    // the lowest of them as last computed, so Block rarely has to look. Block
+    // does not wait for a dropped subscriber.
+    array<atomic<uint64_t>, MAX_SUBSCRIBERS> cursors;
+    array<atomic<bool>, MAX_SUBSCRIBERS> dropped{};
+    atomic<uint64_t> gatingSequence{1};
+    atomic<uint64_t> stallCount{0};
+    atomic<uint64_t> dropCount{0};
+
+    // Subscribers asleep in wait(); writers take wakeMutex only when there are any.
+    atomic<int> sleepers{0};
+    mutex wakeMutex;
+    condition_variable wakeUp;
+
+    uint64_t claim(uint64_t count);
+    uint64_t slowestCursor(uint64_t head) const;
+    void dropSubscribersBehind(uint64_t last);
+    bool isPublished(uint64_t sequence) const;
+    void write(uint64_t sequence, ChangeKind kind, int itemNum, int oldUnits, int newUnits, Money cost);
+    void wakeSubscribers();
+};
+
+/*
+    ChangeSubscription
+    -----------------------------
+    Description:
+    One reader of a ChangeFeed. poll() copies the events published since the
+    last call, in sequence order, and moves the cursor past them, which is what
+    lets the feed reuse their slots. Used by one thread at a time.
+*/
+class ChangeSubscription {
+public:
+    ~ChangeSubscription();
+
+    ChangeSubscription(const ChangeSubscription&) = delete;
+    ChangeSubscription& operator=(const ChangeSubscription&) = delete;
+
+    // Copies up to maxEvents new events to events and returns how many. Stops
+    // before a stretch that was overwritten unread; the next call skips it
+    // (adding it to missed()) and continues after it.
+    size_t poll(ChangeEvent* events, size_t maxEvents);
+
+    // Waits until an event can be polled or timeout passes; returns true if one can.
+    bool wait(chrono::microseconds timeout);
+
+    // Events overwritten before this subscriber read them (Overwrite, or Block
+    // after it was dropped).
+    uint64_t missed() const { return missedEvents; }
+
+    // True while Block does not wait for this subscriber because it held a
+    // change up for MAX_BLOCK_WAIT; cleared once it has caught up.
+    bool dropped() const { return feed.dropped[place].load(memory_order_acquire); }
+
+    // Sequence number of the next event to be read.
+    uint64_t position() const { return cursor; }
+
+private:
+    friend class ChangeFeed;
+    ChangeSubscription(ChangeFeed& feed, size_t place, uint64_t cursor)
+        : feed(feed), place(place), cursor(cursor) {}
+
+    ChangeFeed& feed;
+    const size_t place;
+    uint64_t cursor;
+    uint64_t missedEvents = 0;
+};
+
+// Appends an event as one line: "<sequence>|<n|u>|<item#>|<old units>|<new units>|<cost>\n".
+void appendChangeLine(string& out, const ChangeEvent& event);
+
+// Appends the line that marks missed events: "<first missed sequence>|gap|<count>\n".
+void appendGapLine(string& out, uint64_t firstMissed, uint64_t count);
+
+/*
+    Application-level change feed
+    -----------------------------
+    Started by main() (--feed-file, --feed-listen) after recovery, so the feed
+    carries the changes made from then on, loads included. Each sink is one
+    subscriber with its own thread:
+      - file:   appends the event lines to a file, flushed after every batch.
+      - socket: listens on "[host:]port" (127.0.0.1 by default) or "unix:/path";
+                every client that connects gets the event lines from then on,
+                at its own pace. Linux only, like server mode. Under Block a
+                client that is dropped for being too slow is disconnected, so
+                it reconnects and resyncs instead of reading a feed with gaps.
+*/
+struct ChangeFeedOptions {
+    string file;            // File sink; empty for none
+    string address;         // Socket sink; empty for none
+    size_t capacity = ChangeFeed::DEFAULT_CAPACITY;
+    FeedPolicy policy = FeedPolicy::Overwrite;
+};
+
+// Starts the feed and its sinks. Prints the reason and returns false if a sink cannot start.
+bool startChangeFeed(InventoryStore& inventory, const ChangeFeedOptions& options);
+
+// Stops the sinks (after they have sent what was published), prints a summary
+// and frees the feed. Call before the inventory goes away.
+void stopChangeFeed();
+
+#endif // CHANGEFEED_H
@@ -0,0 +1,35 @@
+// Implementation File -> ChunkedColumn.cpp
+#include "ChunkedColumn.h"
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+/*
+ * allocateZeroedChunk function definition:
+ *  - Maps fresh anonymous memory where the system has mmap: the kernel supplies
+ *    zero pages on first touch, so only the pages a column actually writes
+ *    become resident (a one-item column keeps one page per chunk, not 16384
+ *    elements' worth).
+ *  - On platforms without mmap, calloc provides the zeroed chunk instead.
+ */
+void* allocateZeroedChunk(const size_t bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+    void* chunk = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return chunk == MAP_FAILED ? nullptr : chunk;
+#else
+    return calloc(1, bytes);
+#endif
+}
+
+void freeZeroedChunk(void* chunk, const size_t bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+    munmap(chunk, bytes);
+#else
+    (void)bytes;
+    free(chunk);
+#endif
+}
@@ -0,0 +1,137 @@
+// Specification File -> ChunkedColumn.h
+#ifndef CHUNKEDCOLUMN_H
+#define CHUNKEDCOLUMN_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+// Zero-filled memory for one chunk, or nullptr if none is left. Where the system
+// can map anonymous memory, a page costs nothing until it is first written, so a
+// column holding a handful of elements keeps a few pages resident, not a chunk.
+void* allocateZeroedChunk(size_t bytes);
+void freeZeroedChunk(void* chunk, size_t bytes);
+
+/*
+    ChunkedColumn
+    -----------------------------
+    Description:
+    A growable array whose elements never move. Storage is a list of fixed-size
+    chunks (CHUNK_SIZE elements each) reached through a directory of chunk
+    pointers, so growing the column only ever adds a chunk and publishes its
+    pointer; existing chunks are never copied, resized or freed while the column
+    lives. A reader on another thread can therefore keep using elements (and
+    pointers to them) while a writer appends.
+
+    Nothing is allocated until the first ensure. The directory starts with a few
+    entries and doubles when full; a replaced directory is kept until the column
+    goes away, since a reader may still be looking through it. Chunks are
+    zero-filled memory from allocateZeroedChunk, which is why T must be trivially
+    destructible and all-zero bytes must be its empty value (numbers, atomics,
+    pointers and string_view all qualify): a small column costs a few pages,
+    however large CHUNK_SIZE is, while every chunk keeps the same layout.
+
+    Growth (ensure) must be serialized by the caller. Element i is valid once the
+    caller has published a count greater than i (see InventoryStore's item count).
+
+    In Simpler Terms:
+    Like a notebook with numbered pages: new pages are added at the back, and no
+    page is ever rewritten elsewhere, so someone reading page 3 is never disturbed.
+*/
+template <typename T>
+class ChunkedColumn {
+    static_assert(is_trivially_destructible_v<T>, "Chunks are zero-filled memory, never constructed or destroyed");
+
+public:
+    static constexpr size_t CHUNK_SHIFT = 14;
+    static constexpr size_t CHUNK_SIZE = size_t{1} << CHUNK_SHIFT;   // 16384 elements per chunk
+    static constexpr size_t MAX_CHUNKS = size_t{1} << 16;            // 2^30 elements in total
+
+    ChunkedColumn() = default;
+
+    ~ChunkedColumn() {
+        for (size_t c = 0; c < allocated; ++c) {
+            freeZeroedChunk(directory.load(memory_order_relaxed)[c].load(memory_order_relaxed), CHUNK_BYTES);
+        }
+    }
+
+    ChunkedColumn(const ChunkedColumn&) = delete;
+    ChunkedColumn& operator=(const ChunkedColumn&) = delete;
+
+    // Allocates chunks until elements 0 .. count - 1 exist. Writers only.
+    // Returns false, allocating nothing, if count is beyond MAX_CHUNKS chunks,
+    // and false (keeping the chunks made so far) if memory runs out.
+    bool ensure(const size_t count) {
+        if (count > MAX_CHUNKS * CHUNK_SIZE) {
+            return false;
+        }
+        while (allocated * CHUNK_SIZE < count) {
+            if (allocated == directorySize.load(memory_order_relaxed)) {
+                growDirectory();
+            }
+            T* chunk = static_cast<T*>(allocateZeroedChunk(CHUNK_BYTES));
+            if (chunk == nullptr) {
+                return false;
+            }
+            directory.load(memory_order_relaxed)[allocated].store(chunk, memory_order_release);
+            ++allocated;
+        }
+        return true;
+    }
+
+    // Number of elements that currently have storage.
+    size_t capacity() const { return allocated * CHUNK_SIZE; }
+
+    // index must be below a count passed to a successful ensure.
+    T& operator[](const size_t index) {
+        assert(hasChunk(index >> CHUNK_SHIFT));
+        return chunkAt(index >> CHUNK_SHIFT)[index & (CHUNK_SIZE - 1)];
+    }
+
+    const T& operator[](const size_t index) const {
+        assert(hasChunk(index >> CHUNK_SHIFT));
+        return chunkAt(index >> CHUNK_SHIFT)[index & (CHUNK_SIZE - 1)];
+    }
+
+    // First element of chunk number `chunk` (contiguous for CHUNK_SIZE elements).
+    const T* chunk(const size_t chunk) const { return chunkAt(chunk); }
+
+private:
+    static constexpr size_t CHUNK_BYTES = CHUNK_SIZE * sizeof(T);
+    static constexpr size_t FIRST_DIRECTORY_SIZE = 8;
+
+    atomic<atomic<T*>*> directory{nullptr};
+    atomic<size_t> directorySize{0};               // Published after the directory it describes
+    vector<unique_ptr<atomic<T*>[]>> directories;  // The current one last; older ones stay for readers
+    size_t allocated = 0; // Chunks in use; only touched by the (single) writer
+
+    T* chunkAt(const size_t chunk) const {
+        return directory.load(memory_order_acquire)[chunk].load(memory_order_acquire);
+    }
+
+    // Reading the size first guarantees a directory at least that large.
+    bool hasChunk(const size_t chunk) const {
+        return chunk < directorySize.load(memory_order_acquire) && chunkAt(chunk) != nullptr;
+    }
+
+    // Copies the chunk pointers into a directory twice the size and publishes it.
+    void growDirectory() {
+        const size_t oldSize = directorySize.load(memory_order_relaxed);
+        const size_t newSize = oldSize == 0 ? FIRST_DIRECTORY_SIZE : min(oldSize * 2, MAX_CHUNKS);
+        auto grown = make_unique<atomic<T*>[]>(newSize);
+        for (size_t c = 0; c < allocated; ++c) {
+            grown[c].store(directories.back()[c].load(memory_order_relaxed), memory_order_relaxed);
+        }
+        directory.store(grown.get(), memory_order_release);
+        directorySize.store(newSize, memory_order_release);
+        directories.push_back(move(grown));
+    }
+};
+
+#endif // CHUNKEDCOLUMN_H
@@ -0,0 +1,188 @@
+// Implementation File -> ColumnKernels.cpp
+#include "ColumnKernels.h"
+#include <algorithm>
+#include <bit>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+/*
+ * totalStockValue function definition:
+ *  - Integer multiply-adds on the cents, so the total is exact and does not
+ *    depend on the order of the items.
+ *  - Left as a plain loop: SSE2 has no 64-bit multiply (emulating one with
+ *    32-bit halves measured slower than scalar code), while targets that have
+ *    one (AVX-512) get it vectorized by the compiler.
+ */
+Money totalStockValue(const Money* cost, const int* units, const size_t count) {
+    int64_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += cost[i].cents * units[i];
+    }
+    return Money::fromCents(total);
+}
+
+/*
+ * totalUnits function definition:
+ *  - Plain 64-bit accumulation; the loop has no dependencies the compiler cannot
+ *    vectorize on its own.
+ */
+int64_t totalUnits(const int* units, const size_t count) {
+    int64_t total = 0;
+    for (size_t i = 0; i < count; ++i) {
+        total += units[i];
+    }
+    return total;
+}
+
+/*
+ * minMaxCost function definition:
+ *  - Branch-free running minimum and maximum over the cents.
+ */
+CostRange minMaxCost(const Money* cost, const size_t count) {
+    CostRange range;
+    if (count == 0) {
+        return range;
+    }
+
+    int64_t low = cost[0].cents;
+    int64_t high = low;
+    for (size_t i = 1; i < count; ++i) {
+        low = min(low, cost[i].cents);
+        high = max(high, cost[i].cents);
+    }
+    range.minimum = Money::fromCents(low);
+    range.maximum = Money::fromCents(high);
+    return range;
+}
+
+/*
+ * countUnitsAtMost function definition:
+ *  - SSE2 path: compares four units against the threshold at once; each match is
+ *    an all-ones lane (-1), so subtracting the comparison result counts matches.
+ *  - Item numbers are ints, so a 32-bit lane count cannot overflow.
+ */
+size_t countUnitsAtMost(const int* units, const size_t count, const int threshold) {
+    size_t i = 0;
+    size_t matches = 0;
+
+#if defined(__SSE2__)
+    const __m128i limit = _mm_set1_epi32(threshold);
+    __m128i tally = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(units + i));
+        tally = _mm_sub_epi32(tally, _mm_xor_si128(_mm_cmpgt_epi32(values, limit), _mm_set1_epi32(-1)));
+    }
+    unsigned lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), tally);
+    matches += static_cast<size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+    for (; i < count; ++i) {
+        matches += units[i] <= threshold ? 1 : 0;
+    }
+    return matches;
+}
+
+/*
+ * selectUnitsAtMost function definition:
+ *  - SSE2 path: tests four items per compare and skips the whole group when the
+ *    movemask shows no match, so only matching items cost a branch and a store.
+ */
+void selectUnitsAtMost(const int* units, const size_t count, const int threshold, vector<int>& selected) {
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i limit = _mm_set1_epi32(threshold);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(units + i));
+        int mask = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(values, limit))) & 0xF;
+        while (mask != 0) {
+            const int lane = countr_zero(static_cast<unsigned>(mask));
+            selected.push_back(static_cast<int>(i) + lane);
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        if (units[i] <= threshold) {
+            selected.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+/*
+ * selectCostAtLeast function definition:
+ *  - Compares whole cents, so a threshold such as 12.34 matches exactly the items
+ *    that cost 12.34 or more.
+ */
+void selectCostAtLeast(const Money* cost, const size_t count, const Money threshold, vector<int>& selected) {
+    for (size_t i = 0; i < count; ++i) {
+        if (cost[i] >= threshold) {
+            selected.push_back(static_cast<int>(i));
+        }
+    }
+}
+
+Money totalStockValue(const InventoryStore& inventory) {
+    Money total;
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        total += totalStockValue(span.costs, span.units, span.count);
+    });
+    return total;
+}
+
+int64_t totalUnits(const InventoryStore& inventory) {
+    int64_t total = 0;
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        total += totalUnits(span.units, span.count);
+    });
+    return total;
+}
+
+CostRange minMaxCost(const InventoryStore& inventory) {
+    CostRange range;
+    bool first = true;
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        const CostRange part = minMaxCost(span.costs, span.count);
+        range.minimum = first ? part.minimum : min(range.minimum, part.minimum);
+        range.maximum = first ? part.maximum : max(range.maximum, part.maximum);
+        first = false;
+    });
+    return range;
+}
+
+size_t countUnitsAtMost(const InventoryStore& inventory, const int threshold) {
+    size_t total = 0;
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        total += countUnitsAtMost(span.units, span.count, threshold);
+    });
+    return total;
+}
+
+// Shifts the span-relative item numbers appended since `from` to store item numbers.
+static void offsetSelection(vector<int>& selected, const size_t from, const int firstItem) {
+    for (size_t i = from; i < selected.size(); ++i) {
+        selected[i] += firstItem;
+    }
+}
+
+void selectUnitsAtMost(const InventoryStore& inventory, const int threshold, vector<int>& selected) {
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        const size_t from = selected.size();
+        selectUnitsAtMost(span.units, span.count, threshold, selected);
+        offsetSelection(selected, from, span.firstItem);
+    });
+}
+
+void selectCostAtLeast(const InventoryStore& inventory, const Money threshold, vector<int>& selected) {
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        const size_t from = selected.size();
+        selectCostAtLeast(span.costs, span.count, threshold, selected);
+        offsetSelection(selected, from, span.firstItem);
+    });
+}
@@ -0,0 +1,62 @@
+// Specification File -> ColumnKernels.h
+#ifndef COLUMNKERNELS_H
+#define COLUMNKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "InventoryStore.h"
+
+using namespace std;
+
+/*
+    Column Kernels
+    -----------------------------
+    Description:
+    Scans over the cost and units columns of the InventoryStore. Each kernel reads
+    only the column(s) it needs, as plain contiguous arrays. The units kernels use
+    SSE2 to handle several items per instruction when the compiler targets it (a
+    scalar loop covers the remaining items and non-SSE2 builds); the cost kernels
+    work on whole cents (see Money.h), so their sums are exact, and are plain
+    integer loops the compiler vectorizes where the target has 64-bit compares
+    and multiplies. The InventoryStore overloads run the kernel over each
+    contiguous span of the store (see forEachSpan) and combine the results; they
+    take no locks, so they can run while stock is changing.
+
+    In Simpler Terms:
+    Fast number-crunching over all items at once, used for valuation reports.
+*/
+
+// Smallest and largest value found by minMaxCost (both 0 for an empty column).
+struct CostRange {
+    Money minimum;
+    Money maximum;
+};
+
+// Sum of cost[i] * units[i] over all items, exact to the cent.
+Money totalStockValue(const Money* cost, const int* units, size_t count);
+
+// Sum of units[i] over all items.
+int64_t totalUnits(const int* units, size_t count);
+
+// Lowest and highest cost.
+CostRange minMaxCost(const Money* cost, size_t count);
+
+// Number of items with units[i] <= threshold.
+size_t countUnitsAtMost(const int* units, size_t count, int threshold);
+
+// Appends to selected every item number i with units[i] <= threshold.
+void selectUnitsAtMost(const int* units, size_t count, int threshold, vector<int>& selected);
+
+// Appends to selected every item number i with cost[i] >= threshold.
+void selectCostAtLeast(const Money* cost, size_t count, Money threshold, vector<int>& selected);
+
+// Whole-store versions of the kernels above.
+Money totalStockValue(const InventoryStore& inventory);
+int64_t totalUnits(const InventoryStore& inventory);
+CostRange minMaxCost(const InventoryStore& inventory);
+size_t countUnitsAtMost(const InventoryStore& inventory, int threshold);
+void selectUnitsAtMost(const InventoryStore& inventory, int threshold, vector<int>& selected);
+void selectCostAtLeast(const InventoryStore& inventory, Money threshold, vector<int>& selected);
+
+#endif // COLUMNKERNELS_H
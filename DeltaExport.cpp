@@ -0,0 +1,365 @@
+// Implementation File -> DeltaExport.cpp
+#include "DeltaExport.h"
+#include "BinarySnapshot.h"
+#include "BulkLoader.h"
+#include "RecordSchema.h"
+#include "RecordWriter.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+static constexpr size_t WORD_BITS = 64;
+
+/*
+ * ChangeTracker constructor definition:
+ *  - Makes room for the items already stored, then attaches as an observer.
+ *    Must run before other threads start changing the store.
+ */
+ChangeTracker::ChangeTracker(InventoryStore& store) : store(store) {
+    onItemsAdded(store, 0, store.size());
+    store.addObserver(this);
+}
+
+ChangeTracker::~ChangeTracker() {
+    store.removeObserver(this);
+}
+
+/*
+ * onItemsAdded function definition:
+ *  - Called with the store's structure lock held, so growth is serialized.
+ *  - Only grows the bitmap: new items are pending because they lie past the
+ *    item count of the last export.
+ */
+void ChangeTracker::onItemsAdded(const InventoryStore&, const int firstItem, const int count) {
+    const size_t items = static_cast<size_t>(firstItem) + static_cast<size_t>(count);
+    changedWords.ensure((items + WORD_BITS - 1) / WORD_BITS);
+    covered.store(static_cast<int>(items), memory_order_release);
+}
+
+/*
+ * onUnitsChanged function definition:
+ *  - One atomic OR. The store announces items before publishing them, so every
+ *    item that can change already has its bit; the check only guards the range.
+ */
+void ChangeTracker::onUnitsChanged(const InventoryStore&, const int itemNum, int, int) {
+    if (itemNum < covered.load(memory_order_acquire)) {
+        changedWords[static_cast<size_t>(itemNum) / WORD_BITS].fetch_or(
+            uint64_t{1} << (static_cast<size_t>(itemNum) % WORD_BITS), memory_order_relaxed);
+    }
+}
+
+/*
+ * take function definition:
+ *  - Clears the bitmap word by word (only words with a bit set are written) and
+ *    collects the changed items that existed at the last take, then every item
+ *    added since.
+ *  - A change made while this runs is either collected now or left for the next
+ *    take; an item collected now is written with its latest units anyway.
+ */
+vector<int> ChangeTracker::take() {
+    lock_guard lock(takeMutex);
+    const int end = covered.load(memory_order_acquire);
+    const int previous = min(exportedItems, end);
+
+    vector<int> items;
+    const size_t words = (static_cast<size_t>(end) + WORD_BITS - 1) / WORD_BITS;
+    for (size_t w = 0; w < words; ++w) {
+        if (changedWords[w].load(memory_order_relaxed) == 0) continue;
+        for (uint64_t bits = changedWords[w].exchange(0, memory_order_acq_rel); bits != 0; bits &= bits - 1) {
+            const int itemNum = static_cast<int>(w * WORD_BITS + static_cast<size_t>(countr_zero(bits)));
+            if (itemNum < previous) items.push_back(itemNum);
+        }
+    }
+    for (int itemNum = previous; itemNum < end; ++itemNum) {
+        items.push_back(itemNum);
+    }
+    exportedItems = end;
+    return items;
+}
+
+void ChangeTracker::restore(const vector<int>& itemNums) {
+    lock_guard lock(takeMutex);
+    for (const int itemNum : itemNums) {
+        onUnitsChanged(store, itemNum, 0, 0);
+    }
+}
+
+size_t ChangeTracker::pending() const {
+    lock_guard lock(takeMutex);
+    const int end = covered.load(memory_order_acquire);
+    const size_t previous = static_cast<size_t>(min(exportedItems, end));
+
+    size_t count = static_cast<size_t>(end) - previous;
+    for (size_t w = 0; w * WORD_BITS < previous; ++w) {
+        uint64_t bits = changedWords[w].load(memory_order_relaxed);
+        if (previous - w * WORD_BITS < WORD_BITS) {
+            bits &= (uint64_t{1} << (previous - w * WORD_BITS)) - 1;  // Items added since are counted above
+        }
+        count += static_cast<size_t>(popcount(bits));
+    }
+    return count;
+}
+
+namespace {
+unique_ptr<ChangeTracker> activeTracker;
+}
+
+void startChangeTracking(InventoryStore& inventory) {
+    activeTracker = make_unique<ChangeTracker>(inventory);
+}
+
+/*
+ * clearPendingChanges function definition:
+ *  - Called before an 'o' export is written, like the take of exportDelta, so a
+ *    change made during the write stays pending for the next 'd'.
+ */
+vector<int> clearPendingChanges() {
+    return activeTracker ? activeTracker->take() : vector<int>();
+}
+
+void restorePendingChanges(const vector<int>& itemNums) {
+    if (activeTracker) {
+        activeTracker->restore(itemNums);
+    }
+}
+
+/*
+ * exportDelta function definition:
+ *  - Takes the pending items first, so a change made during the write is
+ *    pending again rather than lost; a failed write puts them all back.
+ */
+void exportDelta(const InventoryStore& inventory, const string_view arguments) {
+    if (!activeTracker) {
+        cout << "Change tracking is not available.\n";
+        return;
+    }
+
+    string filename;
+    if (const size_t first = arguments.find_first_not_of(" \t"); first != string_view::npos) {
+        filename = string(arguments.substr(first, arguments.find_first_of(" \t", first) - first));
+    } else {
+        cout << "Enter name of delta file: ";
+        cin >> filename;
+    }
+
+    const auto start = chrono::steady_clock::now();
+    const vector<int> items = activeTracker->take();
+    if (items.empty()) {
+        cout << "No changes since the last export.\n";
+        return;
+    }
+
+    size_t bytes = 0;
+    if (!writeInventoryRecords(inventory, items, filename, &bytes)) {
+        activeTracker->restore(items);
+        cout << "Error: Could not write file \"" << filename << "\"; the changes are still pending.\n";
+        return;
+    }
+    const double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << items.size() << " changed record(s) written to \"" << filename << "\" (" << bytes << " bytes, "
+         << fixed << setprecision(3) << milliseconds << " ms).\n";
+}
+
+void stopChangeTracking() {
+    activeTracker.reset();
+}
+
+// One line of a delta or base file; the views point into the mapped file.
+struct DeltaRecord {
+    int itemNum = 0;
+    string_view line;          // Without its newline
+    string_view description;
+    Money cost;
+    int units = 0;
+};
+
+/*
+ * parseRecordLine function definition:
+ *  - Reads "index|description|cost|units" (extra fields ignored) with the parser
+ *    generated from InventoryRecordSchema, the layout 'o' writes.
+ *  - The schema only checks that units is a whole number; a record outside
+ *    0..MAX_UNITS is refused here, so a merge can never store one.
+ */
+static bool parseRecordLine(const string_view line, DeltaRecord& record, const char*& reason) {
+    InventoryRecordSchema::Record fields;
+    if (InventoryRecordSchema::parseText(line, fields) != InventoryRecordSchema::FIELDS ||
+        fields.get<IndexField>() < 0) {
+        reason = "not an inventory record";
+        return false;
+    }
+    if (fields.get<UnitsField>() < 0 || fields.get<UnitsField>() > MAX_UNITS) {
+        reason = "units must be between 0 - 30";
+        return false;
+    }
+    record.itemNum = fields.get<IndexField>();
+    record.line = line;
+    record.description = fields.get<DescriptionField>();
+    record.cost = fields.get<CostField>();
+    record.units = fields.get<UnitsField>();
+    return true;
+}
+
+// Calls visit(lineNumber, line) for every non-empty line of text ('\r' removed).
+template <typename Visit>
+static bool forEachLine(const string_view text, Visit&& visit) {
+    size_t lineNumber = 0;
+    for (size_t position = 0; position < text.size();) {
+        size_t end = text.find('\n', position);
+        if (end == string_view::npos) end = text.size();
+        string_view line = text.substr(position, end - position);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        ++lineNumber;
+        if (!line.empty() && !visit(lineNumber, line)) {
+            return false;
+        }
+        position = end + 1;
+    }
+    return true;
+}
+
+static string describeLine(const string& filename, const size_t lineNumber, const string_view problem) {
+    return "\"" + filename + "\" line " + to_string(lineNumber) + ": " + string(problem);
+}
+
+/*
+ * mergeDeltaFiles function definition:
+ *  - Reads every delta into one list, sorts it by item number (stable, so the
+ *    latest delta's record for an item comes last) and keeps the last per item.
+ *  - Text base: copies the base line by line, swapping in delta records, then
+ *    appends the records past its end.
+ *  - Snapshot base: loads it, sets units and appends items, saves it again.
+ */
+bool mergeDeltaFiles(const string& baseFile, const vector<string>& deltaFiles, MergeSummary& summary,
+                     string& error) {
+    const auto start = chrono::steady_clock::now();
+    summary = MergeSummary();
+
+    vector<unique_ptr<MappedFile>> mapped;
+    vector<DeltaRecord> records;
+    for (const string& deltaFile : deltaFiles) {
+        mapped.push_back(make_unique<MappedFile>());
+        if (!mapped.back()->open(deltaFile)) {
+            error = "cannot open \"" + deltaFile + "\"";
+            return false;
+        }
+        const bool parsed = forEachLine(mapped.back()->view(), [&](const size_t lineNumber, const string_view line) {
+            DeltaRecord record;
+            const char* reason = nullptr;
+            if (!parseRecordLine(line, record, reason)) {
+                error = describeLine(deltaFile, lineNumber, reason);
+                return false;
+            }
+            records.push_back(record);
+            return true;
+        });
+        if (!parsed) {
+            return false;
+        }
+        ++summary.deltaFiles;
+    }
+    stable_sort(records.begin(), records.end(),
+                [](const DeltaRecord& a, const DeltaRecord& b) { return a.itemNum < b.itemNum; });
+    vector<DeltaRecord> latest;
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (i + 1 == records.size() || records[i + 1].itemNum != records[i].itemNum) {
+            latest.push_back(records[i]);
+        }
+    }
+
+    MappedFile base;
+    if (!base.open(baseFile)) {
+        error = "cannot open \"" + baseFile + "\"";
+        return false;
+    }
+
+    const auto mismatch = [&](const int itemNum) {
+        error = "item " + to_string(itemNum) + " of the deltas does not match \"" + baseFile +
+                "\" (different description); the deltas belong to another export";
+        return false;
+    };
+    const auto gap = [&](const size_t items) {
+        error = "the deltas skip item " + to_string(items) + " after the end of \"" + baseFile + "\"";
+        return false;
+    };
+
+    if (isSnapshotData(base.view())) {
+        summary.snapshot = true;
+        InventoryStore inventory;
+        if (const SnapshotResult result = loadSnapshotData(base.view(), inventory); result != SnapshotResult::Ok) {
+            error = "\"" + baseFile + "\": " + describeSnapshotResult(result);
+            return false;
+        }
+        for (const DeltaRecord& record : latest) {
+            if (record.itemNum < inventory.size()) {
+                if (inventory.getDescription(record.itemNum) != record.description) return mismatch(record.itemNum);
+                inventory.setUnits(record.itemNum, record.units);
+                ++summary.itemsUpdated;
+            } else if (record.itemNum == inventory.size()) {
+                if (inventory.addItem(record.description, record.cost, record.units) < 0) {
+                    error = "\"" + baseFile + "\": " + inventory.lastFailure();
+                    return false;
+                }
+                ++summary.itemsAdded;
+            } else {
+                return gap(static_cast<size_t>(inventory.size()));
+            }
+        }
+        base.close();
+        if (!saveSnapshotFile(inventory, baseFile)) {
+            error = "cannot write \"" + baseFile + "\"";
+            return false;
+        }
+        summary.items = static_cast<size_t>(inventory.size());
+        summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    AtomicFileWriter writer;
+    if (!writer.open(baseFile)) {
+        error = "cannot write \"" + baseFile + "\"";
+        return false;
+    }
+    size_t next = 0;   // Next delta record to place
+    size_t items = 0;  // Base lines copied so far
+    const bool copied = forEachLine(base.view(), [&](const size_t lineNumber, const string_view line) {
+        DeltaRecord baseRecord;
+        const char* reason = nullptr;
+        if (!parseRecordLine(line, baseRecord, reason) || baseRecord.itemNum != static_cast<int>(items)) {
+            error = describeLine(baseFile, lineNumber, "not a record of an 'o' export (item numbers 0, 1, 2, ...)");
+            return false;
+        }
+        if (next < latest.size() && latest[next].itemNum == baseRecord.itemNum) {
+            if (latest[next].description != baseRecord.description) return mismatch(baseRecord.itemNum);
+            writer.append(latest[next].line);
+            ++next;
+            ++summary.itemsUpdated;
+        } else {
+            writer.append(line);
+        }
+        writer.append('\n');
+        ++items;
+        return true;
+    });
+    if (!copied) {
+        return false;
+    }
+    for (; next < latest.size(); ++next) {
+        if (latest[next].itemNum != static_cast<int>(items)) return gap(items);
+        writer.append(latest[next].line);
+        writer.append('\n');
+        ++items;
+        ++summary.itemsAdded;
+    }
+    if (!writer.commit()) {
+        error = "cannot write \"" + baseFile + "\"";
+        return false;
+    }
+    summary.items = items;
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return true;
+}
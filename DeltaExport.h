@@ -0,0 +1,120 @@
+// Specification File -> DeltaExport.h
+#ifndef DELTAEXPORT_H
+#define DELTAEXPORT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "ChunkedColumn.h"
+#include "InventoryStore.h"
+
+using namespace std;
+
+/*
+    ChangeTracker
+    -----------------------------
+    Description:
+    Remembers which items changed since the last export, so the next one can
+    write just those. As an InventoryObserver it sets one bit per item whose
+    units change (an atomic OR into a bitmap, no lock). Items added since the
+    last export need no bit: they are every item from the export's item count
+    on. take() hands over the changed and added items in item order and starts
+    a new round; finding them reads the bitmap a word (64 items) at a time, so
+    a million-item store costs about 16K word reads.
+
+    Tracking starts with every item pending: nothing is known to be exported
+    yet, so the first delta holds everything, unless an 'o' export came first.
+
+    In Simpler Terms:
+    A sticky note on every item touched since the last save.
+*/
+class ChangeTracker : public InventoryObserver {
+public:
+    explicit ChangeTracker(InventoryStore& store);
+    ~ChangeTracker() override;
+
+    ChangeTracker(const ChangeTracker&) = delete;
+    ChangeTracker& operator=(const ChangeTracker&) = delete;
+
+    // Items changed or added since the last take, ascending. They count as
+    // exported from now on; changes made later are pending again.
+    vector<int> take();
+
+    // Marks items pending again (after the export of what take() returned failed).
+    void restore(const vector<int>& itemNums);
+
+    // Number of items a take() would return now.
+    size_t pending() const;
+
+    void onItemsAdded(const InventoryStore& store, int firstItem, int count) override;
+    void onUnitsChanged(const InventoryStore& store, int itemNum, int oldUnits, int newUnits) override;
+
+private:
+    InventoryStore& store;
+    ChunkedColumn<atomic<uint64_t>> changedWords;  // Bit i % 64 of word i / 64 = item i changed
+    atomic<int> covered{0};                        // Items with a bit (grown in onItemsAdded)
+    int exportedItems = 0;                         // Items that existed at the last take
+    mutable mutex takeMutex;                       // One take/restore at a time
+};
+
+/*
+    Application-level change tracking
+    -----------------------------
+    Started by main() after journal recovery; 'o' and 'd' take the pending
+    changes. A delta file has the same "index|description|cost|units" lines as
+    an 'o' export, for the changed and added items only.
+*/
+
+// Starts following the inventory (called once from main).
+void startChangeTracking(InventoryStore& inventory);
+
+// 'o' is about to write every item: nothing is pending any more. Returns the
+// items that were pending, to be restored if the write fails.
+vector<int> clearPendingChanges();
+
+// The 'o' export after clearPendingChanges failed: those items are pending again.
+void restorePendingChanges(const vector<int>& itemNums);
+
+// 'd' command handler: d [file]. Writes the items changed or added since the
+// last 'o' or 'd' to a delta file.
+void exportDelta(const InventoryStore& inventory, string_view arguments);
+
+// Detaches and frees the tracker (called at exit, before the inventory goes away).
+void stopChangeTracking();
+
+// What mergeDeltaFiles did.
+struct MergeSummary {
+    size_t deltaFiles = 0;
+    size_t itemsUpdated = 0;     // Existing items replaced by a delta record
+    size_t itemsAdded = 0;       // Delta records past the end of the base
+    size_t items = 0;            // Items in the merged file
+    bool snapshot = false;       // The base was a binary snapshot
+    double seconds = 0.0;
+};
+
+/*
+    mergeDeltaFiles
+    -----------------------------
+    Description:
+    Folds delta files, oldest first, into a full export and replaces it
+    (atomically) with the result, as if 'o' had been run after the last delta.
+    The base is either an 'o' text export, merged line by line without loading
+    it into a store, or a binary snapshot ('s'), which is loaded, updated and
+    saved again. A later delta wins over an earlier one for the same item.
+
+    Descriptions never change, so every delta record must carry the same
+    description as the base item it replaces, and added items must continue
+    the base's numbering without gaps; otherwise the delta belongs to another
+    base and nothing is written.
+
+    Returns:
+    false with error set if a file cannot be read or written or does not fit.
+*/
+bool mergeDeltaFiles(const string& baseFile, const vector<string>& deltaFiles, MergeSummary& summary,
+                     string& error);
+
+#endif // DELTAEXPORT_H
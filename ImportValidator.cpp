@@ -0,0 +1,346 @@
+// Implementation File -> ImportValidator.cpp
+#include "ImportValidator.h"
+#include "BulkLoader.h"
+#include "Metrics.h"
+#include "ParallelFor.h"
+#include "RecordWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+// Chunk sizes: big enough to be worth a thread, small enough that line
+// numbers within a chunk fit 32 bits and a chunk's records stay cache-sized.
+static constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+static constexpr size_t MAX_CHUNK_BYTES = 64 << 20;
+
+static ImportRules activeRules;
+
+const char* describeRejectReason(const RejectReason reason) {
+    switch (reason) {
+        case RejectReason::MissingFields:       return "missing fields";
+        case RejectReason::InvalidCost:         return "invalid cost";
+        case RejectReason::InvalidUnits:        return "invalid units";
+        case RejectReason::CostOutOfRange:      return "cost out of range";
+        case RejectReason::UnitsOutOfRange:     return "units out of range";
+        case RejectReason::DescriptionTooShort: return "description too short";
+        case RejectReason::DescriptionTooLong:  return "description too long";
+        case RejectReason::NotStored:           return "could not be stored";
+        case RejectReason::Count:               break;
+    }
+    return "rejected";
+}
+
+void setImportRules(const ImportRules& rules) {
+    activeRules = rules;
+}
+
+const ImportRules& importRules() {
+    return activeRules;
+}
+
+// Removes and returns the next word of text; commas separate words like blanks.
+static string_view takeRuleWord(string_view& text) {
+    const auto separator = [](const char c) { return c == ',' || isspace(static_cast<unsigned char>(c)); };
+    while (!text.empty() && separator(text.front())) text.remove_prefix(1);
+    size_t length = 0;
+    while (length < text.size() && !separator(text[length])) ++length;
+    const string_view word = text.substr(0, length);
+    text.remove_prefix(length);
+    return word;
+}
+
+// Splits "min..max" into its bounds (either may be empty).
+static bool splitRange(const string_view range, string_view& low, string_view& high) {
+    const size_t dots = range.find("..");
+    if (dots == string_view::npos) return false;
+    low = range.substr(0, dots);
+    high = range.substr(dots + 2);
+    return true;
+}
+
+static bool parseSize(const string_view text, size_t& value) {
+    const auto [last, error] = from_chars(text.data(), text.data() + text.size(), value);
+    return error == errc() && last == text.data() + text.size();
+}
+
+/*
+ * parseImportRules function definition:
+ *  - Reads "<field> <min>..<max>" pairs; a later pair for the same field wins.
+ *  - Fields left out keep the values already in rules.
+ */
+bool parseImportRules(const string_view text, ImportRules& rules, const char*& reason) {
+    ImportRules parsed = rules;
+    string_view rest = text;
+
+    for (string_view field = takeRuleWord(rest); !field.empty(); field = takeRuleWord(rest)) {
+        string_view low;
+        string_view high;
+        if (!splitRange(takeRuleWord(rest), low, high)) {
+            reason = "expected a range like 0..30 after the field name";
+            return false;
+        }
+
+        if (field == "units") {
+            int minUnits = 0;
+            int maxUnits = MAX_UNITS;
+            if ((!low.empty() && !parseUnitsField(low, minUnits)) || (!high.empty() && !parseUnitsField(high, maxUnits))) {
+                reason = "units bounds must be whole numbers";
+                return false;
+            }
+            if (minUnits < 0 || maxUnits > MAX_UNITS) {
+                reason = "units must stay within 0..30";
+                return false;
+            }
+            parsed.minUnits = minUnits;
+            parsed.maxUnits = maxUnits;
+        } else if (field == "cost") {
+            Money minCost = Money::lowest();
+            Money maxCost = Money::highest();
+            if ((!low.empty() && !parseCostField(low, minCost)) || (!high.empty() && !parseCostField(high, maxCost))) {
+                reason = "cost bounds must be numbers";
+                return false;
+            }
+            parsed.minCost = minCost;
+            parsed.maxCost = maxCost;
+        } else if (field == "description") {
+            size_t minLength = 0;
+            size_t maxLength = SIZE_MAX;
+            if ((!low.empty() && !parseSize(low, minLength)) || (!high.empty() && !parseSize(high, maxLength))) {
+                reason = "description bounds must be lengths";
+                return false;
+            }
+            parsed.minDescription = minLength;
+            parsed.maxDescription = maxLength;
+        } else {
+            reason = "expected units, cost or description";
+            return false;
+        }
+    }
+
+    if (parsed.minUnits > parsed.maxUnits || parsed.minCost > parsed.maxCost ||
+        parsed.minDescription > parsed.maxDescription) {
+        reason = "a range's lower bound is above its upper bound";
+        return false;
+    }
+    rules = parsed;
+    return true;
+}
+
+static void appendBound(string& out, const Money value) {
+    if (value == Money::lowest() || value == Money::highest()) return;
+    char digits[MONEY_CHARS];
+    out.append(digits, formatMoney(digits, value));
+}
+
+static void appendBound(string& out, const size_t value, const size_t unbounded) {
+    if (value == unbounded) return;
+    out += to_string(value);
+}
+
+string describeImportRules(const ImportRules& rules) {
+    string out = "units " + to_string(rules.minUnits) + ".." + to_string(rules.maxUnits) + ", cost ";
+    appendBound(out, rules.minCost);
+    out += "..";
+    appendBound(out, rules.maxCost);
+    out += ", description ";
+    appendBound(out, rules.minDescription, 0);
+    out += "..";
+    appendBound(out, rules.maxDescription, SIZE_MAX);
+    return out;
+}
+
+// A valid record; line counts from 0 at the start of its chunk.
+struct ValidRecord {
+    string_view description;
+    Money cost;
+    int units = 0;
+    uint32_t line = 0;
+};
+
+// One line-aligned slice of the buffer and what checking it found.
+struct ImportChunk {
+    string_view text;
+    vector<ValidRecord> records;
+    vector<ImportReject> rejects;  // Lines numbered from 0 at the start of the chunk
+    size_t lines = 0;
+};
+
+/*
+ * checkFields function definition:
+ *  - Parses the line's columns with the layout's generated parser and checks
+ *    them against the rules.
+ *  - Returns true with record filled in, or false with the first rule broken.
+ */
+template <typename Schema>
+static bool checkFields(const char* lineStart, const char* lineEnd, const char* const* pipes, const int pipeCount,
+                        const ImportRules& rules, ValidRecord& record, RejectReason& reason) {
+    typename Schema::Record fields;
+    const size_t failed = Schema::parseLine(lineStart, lineEnd, pipes, pipeCount, fields);
+    record.description = fields.template get<DescriptionField>();
+    record.cost = fields.template get<CostField>();
+    record.units = fields.template get<UnitsField>();
+
+    if (failed == Schema::template position<CostField>()) {
+        reason = RejectReason::InvalidCost;
+        return false;
+    }
+    if (failed == Schema::template position<UnitsField>()) {
+        reason = RejectReason::InvalidUnits;
+        return false;
+    }
+    if (record.cost < rules.minCost || record.cost > rules.maxCost) {
+        reason = RejectReason::CostOutOfRange;
+        return false;
+    }
+    if (record.units < rules.minUnits || record.units > rules.maxUnits) {
+        reason = RejectReason::UnitsOutOfRange;
+        return false;
+    }
+    if (record.description.size() < rules.minDescription) {
+        reason = RejectReason::DescriptionTooShort;
+        return false;
+    }
+    if (record.description.size() > rules.maxDescription) {
+        reason = RejectReason::DescriptionTooLong;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * checkChunk function definition:
+ *  - Walks the chunk with splitRecordLines, as scanRecords does, and sorts
+ *    every line into the chunk's records or rejects.
+ */
+template <typename Schema>
+static void checkChunk(ImportChunk& chunk, const ImportRules& rules) {
+    uint32_t line = 0;
+    splitRecordLines<Schema::FIELDS>(chunk.text, [&](const char* lineStart, const char* lineEnd,
+                                                     const char* const* pipes, const int pipeCount) {
+        ValidRecord record;
+        record.line = line;
+        RejectReason reason = RejectReason::MissingFields;
+        if (pipeCount + 1 >= static_cast<int>(Schema::FIELDS) &&
+            checkFields<Schema>(lineStart, lineEnd, pipes, pipeCount, rules, record, reason)) {
+            chunk.records.push_back(record);
+        } else {
+            chunk.rejects.push_back({line, reason, string_view(lineStart, static_cast<size_t>(lineEnd - lineStart))});
+        }
+        ++line;
+        return true;
+    });
+    chunk.lines = line;
+}
+
+// The whole line (without its newline) around a description inside text.
+static string_view lineAround(const string_view text, const string_view description) {
+    const size_t offset = static_cast<size_t>(description.data() - text.data());
+    const size_t newline = text.rfind('\n', offset);
+    const size_t start = newline == string_view::npos ? 0 : newline + 1;
+    size_t end = text.find('\n', offset);
+    if (end == string_view::npos) end = text.size();
+    if (end > start && text[end - 1] == '\r') --end;
+    return text.substr(start, end - start);
+}
+
+/*
+ * importInto function definition:
+ *  - Splits the buffer into line-aligned chunks and checks them in parallel.
+ *  - Appends the valid records chunk by chunk, so item numbers follow the file.
+ *  - Turns chunk line numbers into file line numbers; items the store refuses
+ *    join the rejects, which are then put back in line order.
+ */
+template <typename Store>
+static ImportSummary importInto(const string_view buffer, Store& inventory, const ImportRules& rules,
+                                const unsigned workers, const RecordLayout layout) {
+    const auto start = chrono::steady_clock::now();
+    ImportSummary summary;
+    summary.workers = workers == 0 ? defaultWorkerCount() : workers;
+
+    const size_t chunkTarget = clamp(buffer.size() / (summary.workers * 4 + 1), MIN_CHUNK_BYTES, MAX_CHUNK_BYTES);
+    vector<ImportChunk> chunks;
+    for (size_t position = 0; position < buffer.size();) {
+        size_t end = min(buffer.size(), position + chunkTarget);
+        if (end < buffer.size()) {
+            const void* newline = memchr(buffer.data() + end, '\n', buffer.size() - end);
+            end = newline ? static_cast<size_t>(static_cast<const char*>(newline) - buffer.data()) + 1 : buffer.size();
+        }
+        ImportChunk chunk;
+        chunk.text = buffer.substr(position, end - position);
+        chunks.push_back(move(chunk));
+        position = end;
+    }
+    summary.chunks = chunks.size();
+
+    parallelFor(chunks.size(), [&](const size_t c) {
+        chunks[c].records.reserve(chunks[c].text.size() / 32 + 1);
+        withRecordSchema(layout, [&](auto schema) { checkChunk<decltype(schema)>(chunks[c], rules); });
+    }, summary.workers);
+
+    inventory.reserveForFile(buffer.size());
+    bool refused = false;
+    uint64_t firstLine = 1;
+    for (ImportChunk& chunk : chunks) {
+        for (ImportReject& reject : chunk.rejects) {
+            reject.line += firstLine;
+            summary.rejects.push_back(reject);
+        }
+        for (const ValidRecord& record : chunk.records) {
+            if (inventory.addItem(record.description, record.cost, record.units) < 0) {
+                summary.rejects.push_back({firstLine + record.line, RejectReason::NotStored,
+                                           lineAround(chunk.text, record.description)});
+                refused = true;
+                continue;
+            }
+            ++summary.recordsLoaded;
+        }
+        firstLine += chunk.lines;
+        summary.lines += chunk.lines;
+        vector<ValidRecord>().swap(chunk.records);
+    }
+    if (refused) {
+        stable_sort(summary.rejects.begin(), summary.rejects.end(),
+                    [](const ImportReject& a, const ImportReject& b) { return a.line < b.line; });
+    }
+    for (const ImportReject& reject : summary.rejects) {
+        ++summary.rejectsByReason[static_cast<size_t>(reject.reason)];
+    }
+
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    countMetric(MetricCounter::RecordsParsed, summary.recordsLoaded);
+    countMetricTime(MetricCounter::ParseNanoseconds, start);
+    return summary;
+}
+
+ImportSummary importRecords(const string_view buffer, InventoryStore& inventory, const ImportRules& rules,
+                            const unsigned workers, const RecordLayout layout) {
+    return importInto(buffer, inventory, rules, workers, layout);
+}
+
+// A page file record holds at most MAX_DESCRIPTION bytes of description.
+ImportSummary importRecords(const string_view buffer, PagedStore& inventory, const ImportRules& rules,
+                            const unsigned workers, const RecordLayout layout) {
+    ImportRules pagedRules = rules;
+    pagedRules.maxDescription = min(pagedRules.maxDescription, PagedStore::MAX_DESCRIPTION);
+    return importInto(buffer, inventory, pagedRules, workers, layout);
+}
+
+bool writeRejectFile(const string& filename, const vector<ImportReject>& rejects) {
+    AtomicFileWriter writer;
+    if (!writer.open(filename)) {
+        return false;
+    }
+    for (const ImportReject& reject : rejects) {
+        writer.appendInt(static_cast<long long>(reject.line));
+        writer.append('|');
+        writer.append(describeRejectReason(reject.reason));
+        writer.append('|');
+        writer.append(reject.text);
+        writer.append('\n');
+    }
+    return writer.commit();
+}
@@ -0,0 +1,113 @@
+// Specification File -> ImportValidator.h
+#ifndef IMPORTVALIDATOR_H
+#define IMPORTVALIDATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InventoryStore.h"
+#include "PagedStore.h"
+#include "RecordSchema.h"
+
+using namespace std;
+
+// Why a line of an inventory file was not loaded.
+enum class RejectReason : uint8_t {
+    MissingFields,           // Fewer than four '|'-separated fields
+    InvalidCost,             // Not a (finite) number
+    InvalidUnits,            // Not a whole number
+    CostOutOfRange,
+    UnitsOutOfRange,
+    DescriptionTooShort,
+    DescriptionTooLong,
+    NotStored,               // The store refused the item
+    Count
+};
+
+constexpr size_t REJECT_REASONS = static_cast<size_t>(RejectReason::Count);
+
+// Short text for a reject reason ("invalid cost", "units out of range", ...).
+const char* describeRejectReason(RejectReason reason);
+
+/*
+    ImportRules
+    -----------------------------
+    Description:
+    What a record must satisfy to be loaded by 'i'. The defaults are the
+    program's own rules: 0–30 units and a non-negative cost, any description.
+    Rules can be tightened from the command line (--import-rules), written as
+    "<field> <min>..<max>" for units, cost and description (its length), with
+    either bound left out for "no limit":
+        units 1..30, cost 0..500, description 1..60
+    Units can only be narrowed: the store never holds more than MAX_UNITS.
+*/
+struct ImportRules {
+    int minUnits = 0;
+    int maxUnits = MAX_UNITS;
+    Money minCost;
+    Money maxCost = Money::highest();
+    size_t minDescription = 0;
+    size_t maxDescription = SIZE_MAX;
+};
+
+// Parses rules written as above. On failure returns false and sets reason.
+bool parseImportRules(string_view text, ImportRules& rules, const char*& reason);
+
+// The rules in the form parseImportRules reads.
+string describeImportRules(const ImportRules& rules);
+
+// The rules 'i' applies (set once at startup, before any command runs).
+void setImportRules(const ImportRules& rules);
+const ImportRules& importRules();
+
+// A line that was not loaded; text points into the imported buffer.
+struct ImportReject {
+    uint64_t line = 0;       // 1-based line number in the file
+    RejectReason reason = RejectReason::MissingFields;
+    string_view text;        // The line as it appears in the file (without its newline)
+};
+
+// What importRecords did.
+struct ImportSummary {
+    size_t lines = 0;
+    size_t recordsLoaded = 0;
+    vector<ImportReject> rejects;                    // In line order
+    array<size_t, REJECT_REASONS> rejectsByReason{};
+    size_t chunks = 0;
+    unsigned workers = 0;
+    double seconds = 0.0;
+};
+
+/*
+    importRecords
+    -----------------------------
+    Description:
+    Validates every line of a buffer in a record layout (index|description|
+    cost|units unless told otherwise, see RecordSchema.h) against the rules
+    and appends the valid records to the store in file order. The buffer is
+    split at line boundaries into chunks that are checked in parallel; each
+    chunk keeps its valid records and its rejects,
+    numbered by line, so nothing is printed or thrown while checking. Numbers
+    are parsed with from_chars: the whole field must be a number ("12abc" is an
+    invalid cost). The paged overload also rejects descriptions longer than a
+    page file record holds, as too long.
+
+    The rejects are returned, not printed: hand them to writeRejectFile.
+
+    In Simpler Terms:
+    Sorts a file's lines into "load these" and "here is what was wrong with
+    the rest", using every core, and only then touches the inventory.
+*/
+ImportSummary importRecords(string_view buffer, InventoryStore& inventory, const ImportRules& rules,
+                            unsigned workers = 0, RecordLayout layout = RecordLayout::Inventory);
+ImportSummary importRecords(string_view buffer, PagedStore& inventory, const ImportRules& rules,
+                            unsigned workers = 0, RecordLayout layout = RecordLayout::Inventory);
+
+// Writes one "line|reason|text" line per reject, in one buffered, atomic
+// write. Returns false if the file cannot be written.
+bool writeRejectFile(const string& filename, const vector<ImportReject>& rejects);
+
+#endif // IMPORTVALIDATOR_H
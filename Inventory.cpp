@@ -14,29 +14,277 @@
           - Load and save inventory data from/to external files
           - Display a formatted list of all items in inventory
 
+        Command-line options:
+          --load <file|pattern>...  Loads the files in parallel before anything else
+                                    (see ParallelIngest.h).
+          --batch <file>            Applies a transaction file without any prompts
+                                    (see BatchMode.h), prints a summary and exits.
+          --journal <file>          Logs every change to <file> and recovers from it at
+                                    startup (see Journal.h).
+          --snapshot <file>         Snapshot the journal builds on (default <journal>.snap).
+          --fsync-ms <n>            Sync the journal at most every n ms (-1 = never).
+          --compact-mb <n>          Checkpoint once the journal exceeds n MB.
+          --serve <address>         Serves the inventory to network clients instead of
+                                    the console (see Server.h); "[host:]port" or "unix:/path".
+          --server-threads <n>      Worker threads for --serve (0 = one per CPU).
+          --reorder-at <n>          Raise a reorder alert when an item drops to n units
+                                    (default 5, see StockStats.h).
+          --paged <file>            Keeps the items in a page file instead of in memory
+                                    (see PagedStore.h); for inventories larger than RAM.
+          --cache-mb <n>            Page cache size for --paged (default 64 MB).
+          --import-rules <rules>    What 'i' accepts, e.g. "units 1..30, cost 0..500"
+                                    (see ImportValidator.h).
+          --merge <base> <delta>... Folds 'd' delta files into an 'o' export or 's'
+                                    snapshot (see DeltaExport.h) and exits.
+          --warehouses <file|name=file|pattern>...
+                                    Keeps one inventory per warehouse, loaded in parallel,
+                                    with items named warehouse:number (see ShardedInventory.h).
+          --feed-file <file>        Appends every change to <file> as it happens
+                                    (see ChangeFeed.h).
+          --feed-listen <address>   Streams every change to clients that connect to
+                                    "[host:]port" or "unix:/path".
+          --feed-policy <policy>    "overwrite" (default): slow feed readers skip ahead;
+                                    "block": changes wait for them.
+          --feed-capacity <n>       Changes the feed holds for its readers (default 65536).
+
         The system enforces input validation (e.g., quantity limits, numeric formats),
-        caps inventory size at 100 items, and handles common boundary conditions.
+        grows the inventory store as needed, and handles common boundary conditions.
         The project demonstrates structured programming principles,
         modular design with header and source files, and file I/O in C++.
 */
 
 #include <iostream>
+#include <iomanip>
 #include <string>
-#include <limits>
 #include <vector>
 #include <cctype>
-#include "InventoryItem.h"
+#include <chrono>
+#include <cstdlib>
+#include "InventoryStore.h"
 #include "Menu.h"
+#include "BatchMode.h"
+#include "RecordWriter.h"
+#include "ParallelIngest.h"
+#include "Journal.h"
+#include "Server.h"
+#include "SearchIndex.h"
+#include "StockStats.h"
+#include "PagedStore.h"
+#include "Metrics.h"
+#include "ImportValidator.h"
+#include "DeltaExport.h"
+#include "ShardedInventory.h"
+#include "ChangeFeed.h"
 
 using namespace std;
 
+// Default page cache size for --paged.
+constexpr size_t DEFAULT_CACHE_MB = 64;
+
 // Function prototype for welcome banner
 void displayBanner();
 
-int main() {
-    vector<InventoryItem> inventory(100);
-    int itemCount = 0;
+// Command loop of paged mode (--paged).
+int runPagedMode(const string& pageFile, size_t cacheBytes);
+
+// Command loop of warehouse mode (--warehouses).
+int runWarehouseMode(const vector<string>& warehouseFiles);
+
+int main(int argc, char* argv[]) {
+    InventoryStore inventory;
+
+    vector<string> loadPatterns;
+    string batchFile;
+    string journalFile;
+    string snapshotFile;
+    JournalOptions journalOptions;
+    ServerOptions serverOptions;
+    int reorderThreshold = DEFAULT_REORDER_THRESHOLD;
+    string pageFile;
+    size_t cacheMegabytes = DEFAULT_CACHE_MB;
+    string importRuleText;
+    vector<string> mergeFiles;
+    vector<string> warehouseFiles;
+    bool warehouses = false;
+    ChangeFeedOptions feedOptions;
+    for (int arg = 1; arg < argc; ++arg) {
+        const string option = argv[arg];
+        if (option == "--load") {
+            while (arg + 1 < argc && string(argv[arg + 1]).rfind("--", 0) != 0) {
+                loadPatterns.emplace_back(argv[++arg]);
+            }
+        } else if (option == "--batch" && arg + 1 < argc) {
+            batchFile = argv[++arg];
+        } else if (option == "--journal" && arg + 1 < argc) {
+            journalFile = argv[++arg];
+        } else if (option == "--snapshot" && arg + 1 < argc) {
+            snapshotFile = argv[++arg];
+        } else if (option == "--fsync-ms" && arg + 1 < argc) {
+            journalOptions.syncInterval = chrono::milliseconds(atoll(argv[++arg]));
+        } else if (option == "--compact-mb" && arg + 1 < argc) {
+            journalOptions.compactBytes = strtoull(argv[++arg], nullptr, 10) * 1024 * 1024;
+        } else if (option == "--serve" && arg + 1 < argc) {
+            serverOptions.address = argv[++arg];
+        } else if (option == "--server-threads" && arg + 1 < argc) {
+            serverOptions.threads = static_cast<unsigned>(strtoul(argv[++arg], nullptr, 10));
+        } else if (option == "--reorder-at" && arg + 1 < argc) {
+            reorderThreshold = atoi(argv[++arg]);
+        } else if (option == "--paged" && arg + 1 < argc) {
+            pageFile = argv[++arg];
+        } else if (option == "--cache-mb" && arg + 1 < argc) {
+            cacheMegabytes = strtoull(argv[++arg], nullptr, 10);
+        } else if (option == "--import-rules" && arg + 1 < argc) {
+            importRuleText = argv[++arg];
+        } else if (option == "--merge") {
+            while (arg + 1 < argc && string(argv[arg + 1]).rfind("--", 0) != 0) {
+                mergeFiles.emplace_back(argv[++arg]);
+            }
+        } else if (option == "--warehouses") {
+            warehouses = true;
+            while (arg + 1 < argc && string(argv[arg + 1]).rfind("--", 0) != 0) {
+                warehouseFiles.emplace_back(argv[++arg]);
+            }
+        } else if (option == "--feed-file" && arg + 1 < argc) {
+            feedOptions.file = argv[++arg];
+        } else if (option == "--feed-listen" && arg + 1 < argc) {
+            feedOptions.address = argv[++arg];
+        } else if (option == "--feed-policy" && arg + 1 < argc && parseFeedPolicy(argv[arg + 1], feedOptions.policy)) {
+            ++arg;
+        } else if (option == "--feed-capacity" && arg + 1 < argc) {
+            feedOptions.capacity = strtoull(argv[++arg], nullptr, 10);
+        } else {
+            cerr << "Usage: " << argv[0] << " [--load <file|pattern>...] [--batch <transaction file>]\n"
+                 << "       [--journal <file> [--snapshot <file>] [--fsync-ms <n>] [--compact-mb <n>]]\n"
+                 << "       [--serve <[host:]port|unix:/path> [--server-threads <n>]]\n"
+                 << "       [--reorder-at <n>] [--paged <file> [--cache-mb <n>]] [--import-rules <rules>]\n"
+                 << "       [--warehouses <file|name=file|pattern>...]\n"
+                 << "       [--feed-file <file>] [--feed-listen <[host:]port|unix:/path>]\n"
+                 << "       [--feed-policy overwrite|block] [--feed-capacity <n>]\n"
+                 << "       " << argv[0] << " --merge <base file> <delta file>...\n";
+            return 1;
+        }
+    }
+
+    // Offline merge of delta files: no inventory is loaded
+    if (!mergeFiles.empty()) {
+        if (mergeFiles.size() < 2) {
+            cerr << "Error: --merge needs a base file and at least one delta file.\n";
+            return 1;
+        }
+        MergeSummary summary;
+        string error;
+        if (!mergeDeltaFiles(mergeFiles.front(), vector<string>(mergeFiles.begin() + 1, mergeFiles.end()),
+                             summary, error)) {
+            cerr << "Error: " << error << ".\n";
+            return 1;
+        }
+        cout << "Merged " << summary.deltaFiles << " delta file(s) into \"" << mergeFiles.front() << "\" ("
+             << (summary.snapshot ? "snapshot" : "text") << "): " << summary.itemsUpdated << " item(s) updated, "
+             << summary.itemsAdded << " added, " << summary.items << " in total, " << fixed << setprecision(3)
+             << summary.seconds << " s.\n";
+        return 0;
+    }
+
+    if (!importRuleText.empty()) {
+        ImportRules rules;
+        const char* reason = nullptr;
+        if (!parseImportRules(importRuleText, rules, reason)) {
+            cerr << "Error: --import-rules: " << reason << ".\n";
+            return 1;
+        }
+        setImportRules(rules);
+    }
+
+    const bool feed = !feedOptions.file.empty() || !feedOptions.address.empty();
+
+    // Paged mode keeps the items on disk; the in-memory features do not apply
+    if (!pageFile.empty()) {
+        if (!loadPatterns.empty() || !batchFile.empty() || !journalFile.empty() || !serverOptions.address.empty() ||
+            warehouses || feed) {
+            cerr << "Error: --paged cannot be combined with --load, --batch, --journal, --serve, --warehouses or "
+                    "a change feed.\n";
+            return 1;
+        }
+        return runPagedMode(pageFile, cacheMegabytes * 1024 * 1024);
+    }
+
+    // Warehouse mode keeps one store per warehouse; the single-store features do not apply
+    if (warehouses) {
+        if (!loadPatterns.empty() || !batchFile.empty() || !journalFile.empty() || !serverOptions.address.empty() ||
+            feed) {
+            cerr << "Error: --warehouses cannot be combined with --load, --batch, --journal, --serve or a change "
+                    "feed.\n";
+            return 1;
+        }
+        return runWarehouseMode(warehouseFiles);
+    }
+
+    // Recover from snapshot + journal first; everything after this is journaled
+    if (!journalFile.empty()) {
+        if (snapshotFile.empty()) {
+            snapshotFile = journalFile + ".snap";
+        }
+        if (!startJournal(snapshotFile, journalFile, inventory, journalOptions)) {
+            return 1;
+        }
+    }
+
+    // Running statistics follow every change from here on
+    startStockStats(inventory, reorderThreshold);
+
+    // Changes from here on go into the next 'd' delta (recovered items included)
+    startChangeTracking(inventory);
+
+    // Downstream consumers get every change from here on, loads included
+    if (feed && !startChangeFeed(inventory, feedOptions)) {
+        stopJournal();
+        stopChangeTracking();
+        stopStockStats();
+        return 1;
+    }
+
+    if (!loadPatterns.empty()) {
+        printIngestSummary(ingestFiles(expandFilePatterns(loadPatterns), inventory));
+        commitJournal(inventory);
+        reportStockAlerts(inventory);
+    }
+
+    // Non-interactive mode: apply the transaction file and exit
+    if (!batchFile.empty()) {
+        BatchSummary summary;
+        if (!runBatchFile(batchFile, inventory, summary)) {
+            cerr << "Error: Could not open file \"" << batchFile << "\".\n";
+            stopJournal();
+            stopChangeFeed();
+            stopChangeTracking();
+            stopStockStats();
+            return 1;
+        }
+        printBatchSummary(summary);
+        reportStockAlerts(inventory);
+        commitJournal(inventory);
+        stopJournal();
+        stopChangeFeed();
+        stopChangeTracking();
+        stopStockStats();
+        return summary.transactionsRejected == 0 ? 0 : 2;
+    }
+
+    // Server mode: network clients replace the console until SIGINT/SIGTERM
+    if (!serverOptions.address.empty()) {
+        // Clients change stock from several threads: order single changes
+        // against pick lists and the observers (see InventoryStore::applyChanges)
+        inventory.enableTransactions();
+        const bool served = runServer(serverOptions, inventory);
+        commitJournal(inventory);
+        stopJournal();
+        stopChangeFeed();
+        stopChangeTracking();
+        stopStockStats();
+        return served ? 0 : 1;
+    }
     char command;
+    string arguments;
     bool running = true;
 
     // Display welcome banner at program startup
@@ -52,23 +300,129 @@ int main() {
         - If the user enters 'q', the program displays a farewell message and exits.
         - Otherwise, the input is routed to handleCommand() in Menu.cpp,
           which performs the requested inventory operation.
-        - The input buffer is flushed after each command to ensure clean reads.
+        - The rest of the command's line is read as its arguments, which also
+          leaves the input buffer clean for the next read.
+        - A background write that finished meanwhile is reported after the command,
+          and quitting waits for a running one to complete.
+        - With --journal, the command's changes are committed to the journal.
+        - Reorder alerts raised by the command are printed right after it.
+        - With INVENTORY_METRICS, the command's latency is recorded (see Metrics.h).
     */
     while (running) {
         cout << "Command: ";
         cin >> command;
         command = static_cast<char>(tolower(command));
         cin.clear();
-        cin.ignore(numeric_limits<streamsize>::max(), '\n'); // flush buffer
+        getline(cin, arguments); // rest of the line (e.g. "p 1000 50")
+
+        // Arguments must be separated from the command ("print" is just 'p')
+        if (!arguments.empty() && !isspace(static_cast<unsigned char>(arguments.front()))) {
+            arguments.clear();
+        }
 
         if (command == 'q') {
+            waitForBackgroundExport();
+            stopJournal();
+            stopSearchIndex();
+            stopChangeFeed();
+            stopChangeTracking();
+            stopStockStats();
             cout << "Thank you for using the Inventory Management System. Come again.\n";
             running = false;
         } else {
-            handleCommand(command, inventory, itemCount);
+            {
+                CommandTimer timer(command);
+                handleCommand(command, inventory, arguments);
+            }
+            commitJournal(inventory);
+            reportStockAlerts(inventory);
+            reportBackgroundExport();
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * runPagedMode function definition:
+ *  - Opens (or creates) the page file with a cache of cacheBytes and runs the
+ *    command loop on it, as main() does for the in-memory store.
+ *  - Dirty pages are flushed after every command, so a finished command is in
+ *    the file even if the program is killed afterwards.
+ */
+int runPagedMode(const string& pageFile, const size_t cacheBytes) {
+    PagedStore inventory;
+    const char* reason = nullptr;
+    if (!inventory.open(pageFile, cacheBytes, reason)) {
+        cerr << "Error: \"" << pageFile << "\": " << reason << ".\n";
+        return 1;
+    }
+
+    watchPageCache(&inventory);
+    displayBanner();
+    cout << "Paged mode: " << inventory.size() << " item(s) in \"" << pageFile << "\".\n"
+         << "Enter a command (h for help menu, q to quit).\n";
+
+    char command;
+    string arguments;
+    while (cout << "Command: " && cin >> command) {
+        command = static_cast<char>(tolower(command));
+        getline(cin, arguments);
+        if (!arguments.empty() && !isspace(static_cast<unsigned char>(arguments.front()))) {
+            arguments.clear();
+        }
+
+        if (command == 'q') {
+            break;
+        }
+        {
+            CommandTimer timer(command);
+            handlePagedCommand(command, inventory, arguments);
+        }
+        if (!inventory.flush()) {
+            cout << "Error: Could not write to \"" << pageFile << "\".\n";
+        }
+    }
+
+    const bool flushed = inventory.flush();
+    watchPageCache(nullptr);
+    cout << "Thank you for using the Inventory Management System. Come again.\n";
+    return flushed ? 0 : 1;
+}
+
+/*
+ * runWarehouseMode function definition:
+ *  - Loads the warehouse files in parallel (one task per warehouse) and runs the
+ *    command loop on the sharded inventory, as main() does for a single store.
+ */
+int runWarehouseMode(const vector<string>& warehouseFiles) {
+    ShardedInventory inventory;
+    if (!warehouseFiles.empty()) {
+        printWarehouseLoadSummary(loadWarehouses(warehouseFiles, inventory));
+    }
+
+    displayBanner();
+    cout << "Warehouse mode: " << inventory.shardCount() << " warehouse(s), " << inventory.totalItems()
+         << " item(s).\n"
+         << "Enter a command (h for help menu, q to quit).\n";
+
+    char command;
+    string arguments;
+    while (cout << "Command: " && cin >> command) {
+        command = static_cast<char>(tolower(command));
+        getline(cin, arguments);
+        if (!arguments.empty() && !isspace(static_cast<unsigned char>(arguments.front()))) {
+            arguments.clear();
+        }
+
+        if (command == 'q') {
+            break;
         }
+        CommandTimer timer(command);
+        handleWarehouseCommand(command, inventory, arguments);
     }
 
+    cout << "Thank you for using the Inventory Management System. Come again.\n";
     return 0;
 }
 
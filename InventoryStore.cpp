@@ -0,0 +1,432 @@
+// Implementation File -> InventoryStore.cpp
+#include "InventoryStore.h"
+#include <algorithm>
+
+using namespace std;
+
+/*
+ * reserve function definition:
+ *  - Allocates chunks in every column so that count items fit without further
+ *    allocation while appending. Only a hint: a count the columns cannot hold
+ *    reserves nothing.
+ */
+void InventoryStore::reserve(const size_t count) {
+    lock_guard lock(structureMutex);
+    reserveLocked(count);
+}
+
+// False, with the reason in failure, if the columns cannot hold count items.
+bool InventoryStore::reserveLocked(const size_t count) {
+    if (costs.ensure(count) && units.ensure(count) && descriptions.ensure(count)) {
+        return true;
+    }
+    const bool full = count > ChunkedColumn<Money>::MAX_CHUNKS * ChunkedColumn<Money>::CHUNK_SIZE;
+    failure.store(full ? "the inventory is full" : "out of memory", memory_order_relaxed);
+    return false;
+}
+
+/*
+ * reserveForFile function definition:
+ *  - Estimates how many records a file holds from its size and reserves room
+ *    for them in addition to the current items.
+ */
+void InventoryStore::reserveForFile(const uintmax_t fileBytes) {
+    const size_t expected = static_cast<size_t>(fileBytes / ESTIMATED_BYTES_PER_RECORD) + 1;
+    lock_guard lock(structureMutex);
+    reserveLocked(static_cast<size_t>(size()) + expected);
+}
+
+/*
+ * addItem function definition:
+ *  - Interns the description (a repeated description is not stored again), fills
+ *    in the new row of each column and only then publishes it by incrementing the
+ *    item count (release), so a reader that sees the new count also sees the
+ *    complete item.
+ *  - Observers are told before the item is published: no other thread can change
+ *    it yet, so they record its initial units and every later change comes after.
+ *  - Allocates nothing per item: columns grow a chunk at a time, the text goes
+ *    into arena blocks.
+ *  - Returns -1, storing nothing, once the columns are full (MAX_CHUNKS chunks)
+ *    or a chunk cannot be allocated; lastFailure() says which.
+ */
+int InventoryStore::addItem(const string_view description, const Money cost, const int unitCount) {
+    lock_guard lock(structureMutex);
+    const int itemNum = itemCount.load(memory_order_relaxed);
+    if (!reserveLocked(static_cast<size_t>(itemNum) + 1)) {
+        return -1;
+    }
+
+    descriptions[itemNum] = descriptionText.intern(description);
+    costs[itemNum] = cost;
+    units[itemNum].store(unitCount, memory_order_relaxed);
+
+    notifyItemsAdded(itemNum, 1);
+    itemCount.store(itemNum + 1, memory_order_release);
+    return itemNum;
+}
+
+int InventoryStore::addItem(const InventoryItem& item) {
+    return addItem(item.getDescription(), Money::fromDouble(item.getCost()), item.getUnits());
+}
+
+/*
+ * appendColumns function definition:
+ *  - Bulk counterpart of addItem used by snapshot loading: each description is
+ *    interned straight from the blob (no per-item allocation), and all count
+ *    items are announced to the observers, then published, at once.
+ *  - Returns false, storing nothing, if the columns cannot hold them all.
+ */
+bool InventoryStore::appendColumns(const Money* newCosts, const int* newUnits, const uint64_t* offsets,
+                                   const string_view blob, const size_t count) {
+    lock_guard lock(structureMutex);
+    const int firstItem = itemCount.load(memory_order_relaxed);
+    if (!reserveLocked(static_cast<size_t>(firstItem) + count)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const size_t itemNum = static_cast<size_t>(firstItem) + i;
+        costs[itemNum] = newCosts[i];
+        units[itemNum].store(newUnits[i], memory_order_relaxed);
+        descriptions[itemNum] = descriptionText.intern(blob.substr(offsets[i], offsets[i + 1] - offsets[i]));
+    }
+
+    notifyItemsAdded(firstItem, static_cast<int>(count));
+    itemCount.store(firstItem + static_cast<int>(count), memory_order_release);
+    return true;
+}
+
+size_t InventoryStore::storedDescriptions() const {
+    lock_guard lock(structureMutex);
+    return descriptionText.storedStrings();
+}
+
+size_t InventoryStore::descriptionBytes() const {
+    lock_guard lock(structureMutex);
+    return descriptionText.bytesUsed();
+}
+
+/*
+ * updateDescriptionIndex function definition:
+ *  - Adds every item appended since the last lookup to the description index.
+ *  - Called with indexMutex held.
+ */
+void InventoryStore::updateDescriptionIndex() const {
+    const int count = size();
+    if (indexedItems == count) {
+        return;
+    }
+    descriptionIndex.reserve(static_cast<size_t>(count));
+    for (; indexedItems < count; ++indexedItems) {
+        descriptionIndex.emplace(descriptions[indexedItems], indexedItems);
+    }
+}
+
+/*
+ * setUnits function definition:
+ *  - Stores the new unit count (no validation) and tells the observers.
+ *  - Takes no stripe lock: it is for loading and recovery, before the store is
+ *    shared, so a frozen view only needs the chunk preserved.
+ */
+void InventoryStore::setUnits(const int itemNum, const int newUnits) {
+    preserveUnits(itemNum);
+    const int oldUnits = units[itemNum].exchange(newUnits, memory_order_relaxed);
+    notifyUnitsChanged(itemNum, oldUnits, newUnits);
+}
+
+/*
+ * addUnits / removeUnits function definitions:
+ *  - Enforce the same rules as the interactive addParts/removeParts handlers:
+ *    a valid item number, a non-negative quantity, and 0–30 units afterwards.
+ *  - The item is only modified when every check passes.
+ */
+StockResult InventoryStore::addUnits(const int itemNum, const int quantity, int* unitsAfter) {
+    if (!contains(itemNum)) return StockResult::NoSuchItem;
+    if (quantity < 0) return StockResult::NegativeQuantity;
+    return changeUnits(itemNum, quantity, unitsAfter);
+}
+
+StockResult InventoryStore::removeUnits(const int itemNum, const int quantity, int* unitsAfter) {
+    if (!contains(itemNum)) return StockResult::NoSuchItem;
+    if (quantity < 0) return StockResult::NegativeQuantity;
+    return changeUnits(itemNum, -quantity, unitsAfter);
+}
+
+/*
+ * changeUnits function definition:
+ *  - Compare-and-swap loop: reads the current count, checks that current + delta
+ *    stays within 0..MAX_UNITS, and installs the result only if no other thread
+ *    changed the item in between (otherwise re-checks with the fresh value).
+ *  - Without transactions enabled it takes no lock at all. With them (the store
+ *    is shared between changing threads), the item's stripe lock is held around
+ *    the swap and the notification so that observers see each item's changes in
+ *    order and no change lands inside a transaction or a freeze.
+ *  - A frozen view gets the item's chunk copied before the first change to it.
+ */
+StockResult InventoryStore::changeUnits(const int itemNum, const int delta, int* unitsAfter) {
+    atomic<int>& slot = units[itemNum];
+    unique_lock<mutex> ordered;
+    if (transactional) {
+        ordered = unique_lock(updateStripes[static_cast<size_t>(itemNum) % UPDATE_STRIPES]);
+    }
+
+    preserveUnits(itemNum);
+    int current = slot.load(memory_order_relaxed);
+    int updated;
+    do {
+        updated = current + delta;
+        if (updated > MAX_UNITS) return StockResult::ExceedsMaximum;
+        if (updated < 0) return StockResult::InsufficientUnits;
+    } while (!slot.compare_exchange_weak(current, updated, memory_order_relaxed));
+
+    if (!observers.empty()) {
+        notifyUnitsChanged(itemNum, current, updated);
+    }
+    if (unitsAfter != nullptr) {
+        *unitsAfter = updated;
+    }
+    return StockResult::Ok;
+}
+
+/*
+ * applyChanges function definition:
+ *  - Locks the stripes of every item involved, in ascending stripe order (so two
+ *    transactions can never deadlock), as one 64-bit mask.
+ *  - One validation pass: lines are grouped by item (a stable sort keeps each
+ *    item's lines in order) and each item's running count is checked line by
+ *    line, exactly as if the lines were applied one after the other.
+ *  - Only when every line passes are the new counts stored and the observers
+ *    told, still under the locks; a failure leaves every item untouched.
+ */
+StockResult InventoryStore::applyChanges(const StockChange* changes, const size_t count, size_t* failedLine) {
+    if (count > MAX_TRANSACTION_CHANGES) {
+        if (failedLine != nullptr) *failedLine = MAX_TRANSACTION_CHANGES;
+        return StockResult::TooManyChanges;
+    }
+
+    uint64_t stripeMask = 0;
+    for (size_t line = 0; line < count; ++line) {
+        if (!contains(changes[line].itemNum)) {
+            if (failedLine != nullptr) *failedLine = line;
+            return StockResult::NoSuchItem;
+        }
+        stripeMask |= uint64_t{1} << (static_cast<size_t>(changes[line].itemNum) % UPDATE_STRIPES);
+    }
+    static_assert(UPDATE_STRIPES <= 64, "Stripes are collected in one 64-bit mask");
+
+    array<unique_lock<mutex>, UPDATE_STRIPES> locks;
+    for (size_t stripe = 0; stripe < UPDATE_STRIPES; ++stripe) {
+        if (stripeMask & (uint64_t{1} << stripe)) {
+            locks[stripe] = unique_lock(updateStripes[stripe]);
+        }
+    }
+
+    vector<uint32_t> order(count);
+    for (size_t line = 0; line < count; ++line) {
+        order[line] = static_cast<uint32_t>(line);
+    }
+    stable_sort(order.begin(), order.end(), [changes](const uint32_t a, const uint32_t b) {
+        return changes[a].itemNum < changes[b].itemNum;
+    });
+
+    vector<UnitsChange> applied(count);
+    size_t firstBad = count;
+    StockResult result = StockResult::Ok;
+    for (size_t i = 0; i < count;) {
+        const int itemNum = changes[order[i]].itemNum;
+        long long running = getUnits(itemNum);
+        for (; i < count && changes[order[i]].itemNum == itemNum; ++i) {
+            const size_t line = order[i];
+            const long long updated = running + changes[line].delta;
+            if ((updated > MAX_UNITS || updated < 0) && line < firstBad) {
+                firstBad = line;
+                result = updated > MAX_UNITS ? StockResult::ExceedsMaximum : StockResult::InsufficientUnits;
+            }
+            applied[line] = {itemNum, static_cast<int>(running), static_cast<int>(updated)};
+            running = updated;
+        }
+    }
+    if (result != StockResult::Ok) {
+        if (failedLine != nullptr) *failedLine = firstBad;
+        return result;
+    }
+
+    for (const UnitsChange& change : applied) {
+        preserveUnits(change.itemNum);
+        units[change.itemNum].store(change.newUnits, memory_order_relaxed);
+    }
+    for (InventoryObserver* observer : observers) {
+        observer->onUnitsChangedTogether(*this, applied.data(), applied.size());
+    }
+    return StockResult::Ok;
+}
+
+array<unique_lock<mutex>, InventoryStore::UPDATE_STRIPES> InventoryStore::lockAllStripes() const {
+    array<unique_lock<mutex>, UPDATE_STRIPES> locks;
+    for (size_t stripe = 0; stripe < UPDATE_STRIPES; ++stripe) {
+        locks[stripe] = unique_lock(updateStripes[stripe]);
+    }
+    return locks;
+}
+
+/*
+ * freezeUnits function definition:
+ *  - Every stock change that runs while the store is shared holds its item's
+ *    stripe, so with all stripes held no change is halfway done: the view is
+ *    published between two changes and each later one checks it before writing.
+ *    Without transactions the caller is the only thread that changes stock, so
+ *    no change can be halfway done either.
+ *  - Items added later are past the view's item count and never copied.
+ */
+unique_ptr<FrozenUnits> InventoryStore::freezeUnits() const {
+    const auto locks = lockAllStripes();
+    if (frozen.load(memory_order_relaxed) != nullptr) {
+        return nullptr;
+    }
+    unique_ptr<FrozenUnits> view(new FrozenUnits(*this, size()));
+    frozen.store(view.get(), memory_order_release);
+    return view;
+}
+
+FrozenUnits::FrozenUnits(const InventoryStore& store, const int itemCount)
+    : store(store),
+      itemCount(itemCount),
+      chunkCount((static_cast<size_t>(itemCount) + InventoryStore::SPAN_SIZE - 1) / InventoryStore::SPAN_SIZE),
+      copies(make_unique<atomic<int*>[]>(chunkCount)) {
+}
+
+/*
+ * FrozenUnits destructor definition:
+ *  - Unpublishes the view with every stripe held, so no change is still using
+ *    it, then frees the copies that were never visited.
+ */
+FrozenUnits::~FrozenUnits() {
+    {
+        const auto locks = store.lockAllStripes();
+        store.frozen.store(nullptr, memory_order_relaxed);
+    }
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        releaseChunk(chunk);
+    }
+}
+
+/*
+ * preserveChunk function definition:
+ *  - The first caller for a chunk copies its counts; the mutex makes a writer and
+ *    the reader (or two writers on different stripes) agree on one copy. The
+ *    writers of the chunk's items are either blocked on their stripe or have not
+ *    written since the freeze, so the copy holds the frozen counts.
+ */
+const int* FrozenUnits::preserveChunk(const size_t chunk, const bool forWriter) {
+    if (int* copy = copies[chunk].load(memory_order_acquire); copy != nullptr) {
+        return copy == released() ? nullptr : copy;
+    }
+    lock_guard lock(copyMutex);
+    if (int* copy = copies[chunk].load(memory_order_relaxed); copy != nullptr) {
+        return copy == released() ? nullptr : copy;
+    }
+    const size_t first = chunk * InventoryStore::SPAN_SIZE;
+    const size_t count = min(InventoryStore::SPAN_SIZE, static_cast<size_t>(itemCount) - first);
+    const atomic<int>* live = store.units.chunk(chunk);
+    int* copy = new int[count];
+    for (size_t i = 0; i < count; ++i) {
+        copy[i] = live[i].load(memory_order_relaxed);
+    }
+    copies[chunk].store(copy, memory_order_release);
+    if (forWriter) {
+        copiedForWriters.fetch_add(1, memory_order_relaxed);
+    }
+    return copy;
+}
+
+/*
+ * releaseChunk function definition:
+ *  - Frees a visited chunk's copy and marks it, so a later writer does not copy
+ *    it again for nobody.
+ */
+void FrozenUnits::releaseChunk(const size_t chunk) {
+    int* copy;
+    {
+        lock_guard lock(copyMutex);
+        copy = copies[chunk].exchange(released(), memory_order_acq_rel);
+    }
+    if (copy != released()) {
+        delete[] copy;
+    }
+}
+
+const char* describeStockResult(const StockResult result) {
+    switch (result) {
+        case StockResult::Ok:
+            return "ok";
+        case StockResult::NoSuchItem:
+            return "invalid item number";
+        case StockResult::NegativeQuantity:
+            return "quantity must be a non-negative integer";
+        case StockResult::ExceedsMaximum:
+            return "total quantity would exceed 30 units";
+        case StockResult::InsufficientUnits:
+            return "cannot remove more units than currently available";
+        case StockResult::TooManyChanges:
+            return "too many lines in one transaction";
+    }
+    return "unknown error";
+}
+
+/*
+ * at function definition:
+ *  - Materializes an InventoryItem from the columns for the given item number.
+ */
+InventoryItem InventoryStore::at(const int itemNum) const {
+    return InventoryItem(string(descriptions[itemNum]), costs[itemNum].toDouble(), getUnits(itemNum));
+}
+
+/*
+ * findByDescription function definition:
+ *  - Looks up the description in the hash index.
+ *  - When several items share a description, the oldest (lowest number) wins.
+ */
+int InventoryStore::findByDescription(const string_view description) const {
+    lock_guard lock(indexMutex);
+    updateDescriptionIndex();
+    int found = -1;
+    const auto [first, last] = descriptionIndex.equal_range(description);
+    for (auto entry = first; entry != last; ++entry) {
+        if (found == -1 || entry->second < found) {
+            found = entry->second;
+        }
+    }
+    return found;
+}
+
+vector<int> InventoryStore::findAllByDescription(const string_view description) const {
+    lock_guard lock(indexMutex);
+    updateDescriptionIndex();
+    vector<int> found;
+    const auto [first, last] = descriptionIndex.equal_range(description);
+    for (auto entry = first; entry != last; ++entry) {
+        found.push_back(entry->second);
+    }
+    sort(found.begin(), found.end());
+    return found;
+}
+
+void InventoryStore::addObserver(InventoryObserver* observer) {
+    observers.push_back(observer);
+}
+
+void InventoryStore::removeObserver(InventoryObserver* observer) {
+    observers.erase(remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void InventoryStore::notifyItemsAdded(const int firstItem, const int count) const {
+    for (InventoryObserver* observer : observers) {
+        observer->onItemsAdded(*this, firstItem, count);
+    }
+}
+
+void InventoryStore::notifyUnitsChanged(const int itemNum, const int oldUnits, const int newUnits) const {
+    for (InventoryObserver* observer : observers) {
+        observer->onUnitsChanged(*this, itemNum, oldUnits, newUnits);
+    }
+}
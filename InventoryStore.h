@@ -0,0 +1,431 @@
+// Specification File -> InventoryStore.h
+#ifndef INVENTORYSTORE_H
+#define INVENTORYSTORE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "ChunkedColumn.h"
+#include "InventoryItem.h"
+#include "Money.h"
+#include "StringArena.h"
+
+using namespace std;
+
+// Business rule shared by every path that changes stock: 0–30 units per item.
+constexpr int MAX_UNITS = 30;
+
+// Outcome of a non-interactive stock change (see InventoryStore::addUnits/removeUnits).
+enum class StockResult {
+    Ok,
+    NoSuchItem,        // Item number out of range
+    NegativeQuantity,  // Quantity to add/remove was below zero
+    ExceedsMaximum,    // Adding would take the item above MAX_UNITS
+    InsufficientUnits, // Removing more units than are on hand
+    TooManyChanges     // A transaction longer than MAX_TRANSACTION_CHANGES
+};
+
+// Most lines one all-or-nothing transaction may hold (see InventoryStore::applyChanges).
+constexpr size_t MAX_TRANSACTION_CHANGES = 65536;
+
+// One line of a multi-item transaction: add (delta > 0) or remove (delta < 0) units.
+struct StockChange {
+    int itemNum = 0;
+    int delta = 0;
+};
+
+// One line of a committed transaction as observers see it.
+struct UnitsChange {
+    int itemNum = 0;
+    int oldUnits = 0;
+    int newUnits = 0;
+};
+
+// Short human-readable reason for a StockResult.
+const char* describeStockResult(StockResult result);
+
+class InventoryStore;
+class FrozenUnits;
+
+/*
+    InventoryObserver
+    -----------------------------
+    Description:
+    Interface for components that must follow every change made to an
+    InventoryStore (for example the write-ahead journal). Observers are called
+    synchronously, after the change has been applied, from whichever code path
+    made it: interactive commands, batch transactions and file loads alike.
+    When several threads change stock at once (the store must have transactions
+    enabled), observers are called from all of them, but the changes to any one
+    item are reported in the order they applied.
+    New items are announced just before the store publishes them, so an item's
+    units read in onItemsAdded are its initial units and precede all its changes.
+
+    In Simpler Terms:
+    Anything that wants to be told "an item was added" or "stock changed".
+*/
+class InventoryObserver {
+public:
+    virtual ~InventoryObserver() = default;
+
+    // Items firstItem .. firstItem + count - 1 were appended (not yet counted by
+    // size(); the getters already return them).
+    virtual void onItemsAdded(const InventoryStore& /*store*/, int /*firstItem*/, int /*count*/) {}
+
+    // The units of itemNum changed from oldUnits to newUnits.
+    virtual void onUnitsChanged(const InventoryStore& /*store*/, int /*itemNum*/, int /*oldUnits*/, int /*newUnits*/) {}
+
+    // The lines of one transaction (see InventoryStore::applyChanges) were applied
+    // together, in this order. By default each is reported as an onUnitsChanged.
+    virtual void onUnitsChangedTogether(const InventoryStore& store, const UnitsChange* changes, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            onUnitsChanged(store, changes[i].itemNum, changes[i].oldUnits, changes[i].newUnits);
+        }
+    }
+};
+
+/*
+    InventoryStore
+    -----------------------------
+    Description:
+    Owns every InventoryItem in the program. Items are numbered 0, 1, 2, ... in the
+    order they were added, and that item number is their position in each column,
+    so lookup by item number is O(1). A hash index keyed by description gives O(1)
+    average lookup by name; it is brought up to date on the first lookup after new
+    items arrive, so bulk loads do not pay for it.
+
+    Storage is column-oriented ("structure of arrays"): all costs are one column
+    (in whole cents, see Money.h), all unit counts another, and the description
+    text lives in a separate StringInterner, which stores each distinct
+    description once (catalogs repeat themselves). Scans such as stock valuation
+    therefore read only the cost and units columns and never touch description
+    memory. at() assembles an InventoryItem on demand for code that wants the
+    familiar object API.
+
+    Concurrency: the store may be shared by many threads (e.g. several terminals).
+      - Stock changes (addUnits/removeUnits) are lock-free: each is a compare-and-
+        swap on the item's unit count that re-checks the 0..MAX_UNITS rule, so two
+        pickers can never push an item out of range between them. Once
+        transactions are enabled they also take their item's stripe lock (below).
+      - Structural changes (addItem, appendColumns, reserve) are serialized by a
+        mutex. Columns are ChunkedColumns, so growing never moves existing items;
+        new items are filled in first and then published by bumping the item count.
+      - Readers (size, getters, forEachSpan scans) take no locks at all. They see
+        every item up to the count they read, and never block a writer.
+      - Multi-item transactions (applyChanges) lock the update stripes of their
+        items. When several threads change stock and any of them uses observers,
+        transactions or frozen views, enableTransactions() makes single changes
+        take their stripe too, so they never land in the middle of one and each
+        item's changes reach the observers in order. A store changed by one
+        thread at a time (the console, batch mode) needs none of this.
+      - A point-in-time view (freezeUnits) costs the writers one extra atomic
+        load while it exists, and a chunk copy the first time they change a
+        chunk of items (see FrozenUnits).
+    Observers must be registered, and transactions enabled, before the store is
+    shared between threads.
+
+    In Simpler Terms:
+    This is the list of everything in the inventory. It grows as needed, can find an
+    item quickly either by its number or by its description, and can be used by many
+    people at the same time.
+*/
+class InventoryStore {
+public:
+    static constexpr size_t SPAN_SIZE = ChunkedColumn<Money>::CHUNK_SIZE;
+
+    // A run of consecutive items stored contiguously (one chunk of each column).
+    struct ColumnSpan {
+        int firstItem = 0;
+        size_t count = 0;
+        const Money* costs = nullptr;
+        const int* units = nullptr;
+        const string_view* descriptions = nullptr;
+    };
+
+    InventoryStore() = default;
+    InventoryStore(const InventoryStore&) = delete;
+    InventoryStore& operator=(const InventoryStore&) = delete;
+
+    // Number of items in the store; valid item numbers are 0 to size() - 1.
+    int size() const { return itemCount.load(memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    bool contains(int itemNum) const { return itemNum >= 0 && itemNum < size(); }
+
+    // Pre-allocates room for count items in total.
+    void reserve(size_t count);
+
+    // Pre-allocates room for the records an input file of fileBytes bytes is
+    // expected to hold, on top of the items already stored.
+    void reserveForFile(uintmax_t fileBytes);
+
+    // Appends an item and returns its item number, or -1 if the store is full
+    // or out of memory (see lastFailure()). The description is copied into the
+    // store, so the view only has to be valid during the call.
+    int addItem(string_view description, Money cost, int unitCount);
+    int addItem(const InventoryItem& item);
+
+    // Appends count items straight from column data: costs[i], units[i] and the
+    // description blob.substr(offsets[i], offsets[i + 1] - offsets[i]). Descriptions
+    // are interned as in addItem. Offsets must be ascending and within the blob.
+    // Returns false, appending nothing, if the store cannot hold them all.
+    bool appendColumns(const Money* newCosts, const int* newUnits, const uint64_t* offsets,
+                       string_view blob, size_t count);
+
+    // Why the last addItem or appendColumns failed.
+    const char* lastFailure() const { return failure.load(memory_order_relaxed); }
+
+    // O(1) access by item number. itemNum must satisfy contains(itemNum).
+    InventoryItem at(int itemNum) const;
+    string_view getDescription(int itemNum) const { return descriptions[itemNum]; }
+    Money getCost(int itemNum) const { return costs[itemNum]; }
+    int getUnits(int itemNum) const { return units[itemNum].load(memory_order_relaxed); }
+
+    // Stores a unit count without validation (used by recovery) and tells the observers.
+    void setUnits(int itemNum, int newUnits);
+
+    // Validated stock changes: apply the change and return Ok, or leave the item
+    // untouched and return the rule that was broken. Safe to call from any thread.
+    // If unitsAfter is given, it receives the item's units right after this change.
+    StockResult addUnits(int itemNum, int quantity, int* unitsAfter = nullptr);
+    StockResult removeUnits(int itemNum, int quantity, int* unitsAfter = nullptr);
+
+    // Applies every change or none: the lines are checked in one pass, in order
+    // (several lines may name the same item), against the 0..MAX_UNITS rule, and
+    // then applied together while their items' stripe locks are held. Observers
+    // hear about them in one onUnitsChangedTogether call. On failure nothing is
+    // changed and failedLine (if given) receives the index of the first bad line.
+    StockResult applyChanges(const StockChange* changes, size_t count, size_t* failedLine = nullptr);
+
+    // Makes single stock changes take their stripe lock, so changes from several
+    // threads cannot interleave with applyChanges or freezeUnits, and observers
+    // hear about each item's changes in order. Call before the store is shared
+    // between changing threads (the program does when it serves clients).
+    void enableTransactions() { transactional = true; }
+
+    // Calls visit(const ColumnSpan&) for items 0 .. size() - 1 (or only the first
+    // limit items), one chunk at a time (at most SPAN_SIZE items per span), for scans
+    // such as ColumnKernels. Description views stay valid for the store's lifetime
+    // (the arena never moves text).
+    template <typename Visit>
+    void forEachSpan(Visit&& visit, size_t limit = SIZE_MAX) const;
+
+    // Freezes the unit counts as they are now, for a reader that needs one
+    // consistent version of the store while stock keeps changing (a background
+    // export). Returns nullptr if a view is already frozen. Without transactions
+    // enabled, freeze and destroy the view on the only thread that changes stock
+    // (other threads may read it). The view must be destroyed before the store.
+    unique_ptr<FrozenUnits> freezeUnits() const;
+
+    // Registers/unregisters an observer (not owned) to be told about every change.
+    void addObserver(InventoryObserver* observer);
+    void removeObserver(InventoryObserver* observer);
+
+    // Description copies stored, and the bytes of text they take up. Items with
+    // the same description share one copy while the interner deduplicates.
+    size_t storedDescriptions() const;
+    size_t descriptionBytes() const;
+
+    // Returns the lowest item number with exactly this description, or -1.
+    int findByDescription(string_view description) const;
+
+    // Returns every item number with exactly this description, in ascending order.
+    vector<int> findAllByDescription(string_view description) const;
+
+private:
+    // Rough size of one "index|description|cost|units" line, used for reserve hints.
+    static constexpr uintmax_t ESTIMATED_BYTES_PER_RECORD = 32;
+
+    // Stock changes on items that hash to the same stripe are ordered for observers.
+    static constexpr size_t UPDATE_STRIPES = 64;
+
+    ChunkedColumn<Money> costs;
+    ChunkedColumn<atomic<int>> units;
+    ChunkedColumn<string_view> descriptions; // Views into descriptionText
+    StringInterner descriptionText;          // Each distinct description stored once
+    atomic<int> itemCount{0};
+
+    // Held by structural changes (appending items, reserving space).
+    mutable mutex structureMutex;
+    atomic<const char*> failure{""};         // See lastFailure(); set under structureMutex
+
+    // Hash index over descriptions[0 .. indexedItems); extended lazily by lookups.
+    mutable mutex indexMutex;
+    mutable unordered_multimap<string_view, int> descriptionIndex;
+    mutable int indexedItems = 0;
+
+    vector<InventoryObserver*> observers;
+    mutable array<mutex, UPDATE_STRIPES> updateStripes;
+    bool transactional = false;
+
+    // The frozen view, if one exists; set and cleared with every stripe held.
+    mutable atomic<FrozenUnits*> frozen{nullptr};
+    friend class FrozenUnits;
+
+    StockResult changeUnits(int itemNum, int delta, int* unitsAfter);
+    void preserveUnits(int itemNum) const;
+    array<unique_lock<mutex>, UPDATE_STRIPES> lockAllStripes() const;
+    bool reserveLocked(size_t count);
+    void updateDescriptionIndex() const;
+    void notifyItemsAdded(int firstItem, int count) const;
+    void notifyUnitsChanged(int itemNum, int oldUnits, int newUnits) const;
+};
+
+/*
+    StockTransaction
+    -----------------------------
+    Description:
+    Stages stock changes on many items (a pick list, a kit being assembled) and
+    commits them all-or-nothing through InventoryStore::applyChanges: either every
+    line stays within 0..MAX_UNITS and all of them apply, or none does. Staging
+    does not touch the store.
+
+    In Simpler Terms:
+    A shopping list that is either filled completely or not at all.
+*/
+class StockTransaction {
+public:
+    // Stages adding / removing quantity units of itemNum (checked at commit).
+    void add(int itemNum, int quantity) { lines.push_back({itemNum, quantity}); }
+    void remove(int itemNum, int quantity) { lines.push_back({itemNum, -quantity}); }
+
+    size_t size() const { return lines.size(); }
+    bool empty() const { return lines.empty(); }
+    void clear() { lines.clear(); }
+    const vector<StockChange>& changes() const { return lines; }
+
+    // Applies every staged line or none; see InventoryStore::applyChanges.
+    StockResult commit(InventoryStore& store, size_t* failedLine = nullptr) const {
+        return store.applyChanges(lines.data(), lines.size(), failedLine);
+    }
+
+private:
+    vector<StockChange> lines;
+};
+
+static_assert(sizeof(atomic<int>) == sizeof(int) && atomic<int>::is_always_lock_free,
+              "Unit chunks are scanned as plain int arrays");
+
+/*
+    FrozenUnits
+    -----------------------------
+    Description:
+    The unit counts of an InventoryStore's first size() items as they were when
+    freezeUnits was called, while the store itself keeps changing. Costs and
+    descriptions never change once an item exists, so only units need a second
+    version, and they get one lazily, a chunk (SPAN_SIZE items) at a time: the
+    first stock change to touch a chunk after the freeze copies that chunk's
+    counts before it writes (copy-on-write). The reader copies each remaining
+    chunk itself just before visiting it and drops every copy once visited, so
+    memory stays at the chunks changed but not yet read, never a whole column.
+
+    Freezing and thawing lock every update stripe for a moment, so a stock change
+    is either wholly before the freeze or sees it; nothing else waits. Without
+    transactions enabled that takes the changing thread doing both itself.
+
+    Meant for one reader thread (such as the background export).
+
+    In Simpler Terms:
+    A photograph of the stock levels: pickers keep working on the real shelves,
+    and only a shelf someone touches is sketched first, so the photograph stays
+    as it was.
+*/
+class FrozenUnits {
+public:
+    FrozenUnits(const FrozenUnits&) = delete;
+    FrozenUnits& operator=(const FrozenUnits&) = delete;
+    ~FrozenUnits();
+
+    // Items in the view (items added after the freeze are not part of it).
+    int size() const { return itemCount; }
+
+    // Calls visit(const InventoryStore::ColumnSpan&) for every chunk of the view,
+    // as InventoryStore::forEachSpan does, with the frozen unit counts. Each
+    // chunk's copy is released after its visit, so a view can be walked once.
+    template <typename Visit>
+    void forEachSpan(Visit&& visit);
+
+    // Chunks copied because a stock change reached them first (so far).
+    size_t chunksCopiedForWriters() const { return copiedForWriters.load(memory_order_relaxed); }
+
+private:
+    friend class InventoryStore;
+    FrozenUnits(const InventoryStore& store, int itemCount);
+
+    // Copies chunk's counts unless that happened already; returns the copy, or
+    // nullptr if the chunk was already visited and released.
+    const int* preserveChunk(size_t chunk, bool forWriter);
+    void releaseChunk(size_t chunk);
+
+    const InventoryStore& store;
+    const int itemCount;
+    const size_t chunkCount;
+    unique_ptr<atomic<int*>[]> copies;  // nullptr until copied; released once visited
+    mutex copyMutex;
+    atomic<size_t> copiedForWriters{0};
+
+    static inline int releasedMarker = 0;
+    static int* released() { return &releasedMarker; }
+};
+
+/*
+ * preserveUnits function definition:
+ *  - Called by every stock change before it writes itemNum, with the item's stripe
+ *    held. Without a frozen view this is a single load; with one, only the first
+ *    write to a chunk copies it.
+ */
+inline void InventoryStore::preserveUnits(const int itemNum) const {
+    FrozenUnits* view = frozen.load(memory_order_acquire);
+    if (view == nullptr || itemNum >= view->itemCount) {
+        return;
+    }
+    const size_t chunk = static_cast<size_t>(itemNum) / SPAN_SIZE;
+    if (view->copies[chunk].load(memory_order_acquire) == nullptr) {
+        view->preserveChunk(chunk, true);
+    }
+}
+
+template <typename Visit>
+void FrozenUnits::forEachSpan(Visit&& visit) {
+    const size_t total = static_cast<size_t>(itemCount);
+    for (size_t first = 0, chunk = 0; first < total; first += InventoryStore::SPAN_SIZE, ++chunk) {
+        InventoryStore::ColumnSpan span;
+        span.firstItem = static_cast<int>(first);
+        span.count = min(InventoryStore::SPAN_SIZE, total - first);
+        span.costs = store.costs.chunk(chunk);
+        span.units = preserveChunk(chunk, false);
+        span.descriptions = store.descriptions.chunk(chunk);
+        if (span.units == nullptr) continue;
+        visit(span);
+        releaseChunk(chunk);
+    }
+}
+
+/*
+ * forEachSpan function definition:
+ *  - Reads the item count once, so a concurrent writer's new items are simply not
+ *    part of this scan. Unit counts are read as they are at that moment; each one
+ *    is either before or after any concurrent change, never a mix.
+ */
+template <typename Visit>
+void InventoryStore::forEachSpan(Visit&& visit, const size_t limit) const {
+    const size_t total = min(static_cast<size_t>(size()), limit);
+    for (size_t first = 0, chunk = 0; first < total; first += SPAN_SIZE, ++chunk) {
+        ColumnSpan span;
+        span.firstItem = static_cast<int>(first);
+        span.count = min(SPAN_SIZE, total - first);
+        span.costs = costs.chunk(chunk);
+        span.units = reinterpret_cast<const int*>(units.chunk(chunk));
+        span.descriptions = descriptions.chunk(chunk);
+        visit(span);
+    }
+}
+
+#endif // INVENTORYSTORE_H
@@ -0,0 +1,545 @@
+// Implementation File -> Journal.cpp
+#include "Journal.h"
+#include "BinarySnapshot.h"
+#include "BulkLoader.h"
+#include "Metrics.h"
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define JOURNAL_POSIX 1
+#endif
+
+using namespace std;
+
+static constexpr char JOURNAL_MAGIC[8] = {'I', 'N', 'V', 'J', 'R', 'N', 'L', '\0'};
+static constexpr uint32_t JOURNAL_VERSION = 1;
+
+// Record types (first payload byte). RECORD_NEW_ITEM (cost as a double) is no
+// longer written but still replayed, for journals written before costs were cents.
+static constexpr uint8_t RECORD_UNITS_DELTA = 1;
+static constexpr uint8_t RECORD_NEW_ITEM = 2;
+static constexpr uint8_t RECORD_TRANSACTION = 3;
+static constexpr uint8_t RECORD_NEW_ITEM_CENTS = 4;
+
+// Largest payload accepted on replay; anything bigger is a corrupt length field.
+static constexpr uint32_t MAX_RECORD_PAYLOAD = 1 << 20;
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t baseChecksum; // Checksum of the snapshot this journal applies to (0 = none)
+};
+
+struct RecordPrefix {
+    uint32_t payloadSize;
+    uint32_t checksum;
+};
+
+static_assert(sizeof(JournalHeader) == 24, "JournalHeader layout is part of the file format");
+static_assert(sizeof(RecordPrefix) == 8, "RecordPrefix layout is part of the file format");
+
+static uint32_t recordChecksum(const string_view payload) {
+    return static_cast<uint32_t>(snapshotChecksum(payload));
+}
+
+static int64_t nowNanoseconds() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+template <typename T>
+static void putValue(char*& out, const T value) {
+    memcpy(out, &value, sizeof(value));
+    out += sizeof(value);
+}
+
+template <typename T>
+static bool takeValue(string_view& in, T& value) {
+    if (in.size() < sizeof(value)) {
+        return false;
+    }
+    memcpy(&value, in.data(), sizeof(value));
+    in.remove_prefix(sizeof(value));
+    return true;
+}
+
+/*
+ * writeAll function definition:
+ *  - Writes every byte, retrying short writes. Returns false on any error.
+ */
+static bool writeAll(const int fd, const char* data, size_t size) {
+#ifdef JOURNAL_POSIX
+    countMetric(MetricCounter::BytesWritten, size);
+    while (size > 0) {
+        const ssize_t count = ::write(fd, data, size);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+#else
+    (void)fd; (void)data; (void)size;
+    return false;
+#endif
+}
+
+/*
+ * applyRecord function definition:
+ *  - Decodes one payload and applies it to the inventory.
+ *  - Returns false if the payload is malformed or cannot apply (e.g. an item
+ *    number that does not exist); replay stops there.
+ */
+static bool applyRecord(string_view payload, InventoryStore& inventory) {
+    uint8_t type = 0;
+    int64_t timestamp = 0;
+    if (!takeValue(payload, type) || !takeValue(payload, timestamp)) {
+        return false;
+    }
+
+    if (type == RECORD_UNITS_DELTA) {
+        int32_t itemNum = 0;
+        int32_t delta = 0;
+        if (!takeValue(payload, itemNum) || !takeValue(payload, delta) || !payload.empty()) {
+            return false;
+        }
+        if (!inventory.contains(itemNum)) {
+            return false;
+        }
+        const long long units = static_cast<long long>(inventory.getUnits(itemNum)) + delta;
+        if (units < 0 || units > MAX_UNITS) {
+            return false;
+        }
+        inventory.setUnits(itemNum, static_cast<int>(units));
+        return true;
+    }
+
+    if (type == RECORD_NEW_ITEM_CENTS) {
+        int64_t cents = 0;
+        int32_t units = 0;
+        uint32_t length = 0;
+        if (!takeValue(payload, cents) || !takeValue(payload, units) || !takeValue(payload, length) ||
+            payload.size() != length) {
+            return false;
+        }
+        return inventory.addItem(payload, Money::fromCents(cents), units) >= 0;
+    }
+
+    if (type == RECORD_NEW_ITEM) {
+        double cost = 0.0;
+        int32_t units = 0;
+        uint32_t length = 0;
+        if (!takeValue(payload, cost) || !takeValue(payload, units) || !takeValue(payload, length) ||
+            payload.size() != length || !isfinite(cost)) {
+            return false;
+        }
+        return inventory.addItem(payload, Money::fromDouble(cost), units) >= 0;
+    }
+
+    if (type == RECORD_TRANSACTION) {
+        uint32_t count = 0;
+        if (!takeValue(payload, count) || count > MAX_TRANSACTION_CHANGES ||
+            payload.size() != count * 2 * sizeof(int32_t)) {
+            return false;
+        }
+        vector<StockChange> changes(count);
+        for (StockChange& change : changes) {
+            int32_t itemNum = 0;
+            int32_t delta = 0;
+            takeValue(payload, itemNum);
+            takeValue(payload, delta);
+            change = {itemNum, delta};
+        }
+        return inventory.applyChanges(changes.data(), changes.size()) == StockResult::Ok;
+    }
+
+    return false;
+}
+
+Journal::~Journal() {
+    close();
+}
+
+/*
+ * recover function definition:
+ *  - Loads the snapshot (remembering its checksum) into the empty inventory.
+ *  - Replays the journal only if its header names that same snapshot; a journal
+ *    left behind by an interrupted checkpoint is older than the snapshot and is
+ *    replaced by an empty one.
+ *  - Replay stops at the first torn or corrupt record (short, or its checksum
+ *    does not match); the file is cut back to the last good record before new
+ *    records are appended.
+ *  - A record that is intact but cannot be applied (e.g. an unknown item) means
+ *    the journal does not belong to this inventory: recovery fails and the file
+ *    is left as it is, so nothing after it is lost.
+ *  - Starts observing the inventory only after replay, so replayed changes are
+ *    not written a second time.
+ */
+bool Journal::recover(const string& snapshotFile, const string& journalFile, InventoryStore& inventory,
+                      RecoveryReport& report) {
+    const auto start = chrono::steady_clock::now();
+    close();
+    snapshotPath = snapshotFile;
+    journalPath = journalFile;
+
+    uint64_t baseChecksum = 0;
+    error_code exists;
+    if (filesystem::exists(snapshotPath, exists)) {
+        const SnapshotResult result = loadSnapshotFile(snapshotPath, inventory, &baseChecksum);
+        if (result != SnapshotResult::Ok) {
+            report.error = "snapshot \"" + snapshotPath + "\": " + describeSnapshotResult(result);
+            return false;
+        }
+        report.snapshotLoaded = true;
+        report.snapshotItems = static_cast<size_t>(inventory.size());
+    }
+
+    MappedFile file;
+    if (!file.open(journalPath)) {
+        if (filesystem::exists(journalPath, exists)) {
+            report.error = "cannot open journal \"" + journalPath + "\"";
+            return false;
+        }
+        return startObserving(startFresh(baseChecksum), inventory, report, start);
+    }
+
+    string_view data = file.view();
+    JournalHeader header{};
+    if (data.size() < sizeof(header) || memcmp(data.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0) {
+        report.error = "\"" + journalPath + "\" is not a journal file";
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.version != JOURNAL_VERSION) {
+        report.error = "unsupported journal version";
+        return false;
+    }
+    if (header.baseChecksum != baseChecksum) {
+        if (!report.snapshotLoaded) {
+            report.error = "journal was written on top of snapshot \"" + snapshotPath + "\", which is missing";
+            return false;
+        }
+        report.journalStale = true;
+        file.close();
+        return startObserving(startFresh(baseChecksum), inventory, report, start);
+    }
+
+    size_t position = sizeof(header);
+    while (data.size() - position >= sizeof(RecordPrefix)) {
+        RecordPrefix prefix{};
+        memcpy(&prefix, data.data() + position, sizeof(prefix));
+        if (prefix.payloadSize > MAX_RECORD_PAYLOAD ||
+            data.size() - position - sizeof(prefix) < prefix.payloadSize) {
+            break;
+        }
+        const string_view payload = data.substr(position + sizeof(prefix), prefix.payloadSize);
+        if (recordChecksum(payload) != prefix.checksum) {
+            break;
+        }
+        if (!applyRecord(payload, inventory)) {
+            report.error = "journal record " + to_string(report.recordsReplayed + 1) + " in \"" + journalPath +
+                           "\" cannot be applied (the journal is left unchanged)";
+            return false;
+        }
+        position += sizeof(prefix) + prefix.payloadSize;
+        ++report.recordsReplayed;
+    }
+    report.bytesDiscarded = data.size() - position;
+    file.close();
+
+#ifdef JOURNAL_POSIX
+    fd = ::open(journalPath.c_str(), O_WRONLY | O_APPEND);
+    if (fd < 0 || (report.bytesDiscarded > 0 && ftruncate(fd, static_cast<off_t>(position)) != 0)) {
+        report.error = "cannot reopen journal \"" + journalPath + "\"";
+        close();
+        return false;
+    }
+#endif
+    fileBytes = position;
+    records = report.recordsReplayed;
+    failed = false;
+    lastSync = chrono::steady_clock::now();
+    return startObserving(fd >= 0, inventory, report, start);
+}
+
+/*
+ * startObserving function definition:
+ *  - Final step of every recovery path: attaches the journal to the inventory
+ *    if the journal file is ready, and records the elapsed time.
+ */
+bool Journal::startObserving(const bool ready, InventoryStore& inventory, RecoveryReport& report,
+                             const chrono::steady_clock::time_point start) {
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!ready) {
+        if (report.error.empty()) report.error = "cannot create journal \"" + journalPath + "\"";
+        return false;
+    }
+    observed = &inventory;
+    inventory.addObserver(this);
+    return true;
+}
+
+/*
+ * startFresh function definition:
+ *  - Writes a header-only journal next to the old one, syncs it and renames it
+ *    into place, so the journal file is always either the old or the new one.
+ */
+bool Journal::startFresh(const uint64_t baseChecksum) {
+#ifdef JOURNAL_POSIX
+    JournalHeader header{};
+    memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    header.version = JOURNAL_VERSION;
+    header.baseChecksum = baseChecksum;
+
+    const string temporary = journalPath + ".tmp";
+    const int newFd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (newFd < 0) {
+        return false;
+    }
+    error_code renameError;
+    if (!writeAll(newFd, reinterpret_cast<const char*>(&header), sizeof(header)) || fsync(newFd) != 0 ||
+        (filesystem::rename(temporary, journalPath, renameError), renameError)) {
+        ::close(newFd);
+        filesystem::remove(temporary, renameError);
+        return false;
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    fd = newFd;
+    fileBytes = sizeof(header);
+    records = 0;
+    failed = false;
+    lastSync = chrono::steady_clock::now();
+    return true;
+#else
+    (void)baseChecksum;
+    return false;
+#endif
+}
+
+/*
+ * appendRecord function definition:
+ *  - Adds size + checksum + payload to the in-memory group; a full group is
+ *    written immediately (without forcing an fsync).
+ */
+void Journal::appendRecord(const char* payload, const size_t size) {
+    const RecordPrefix prefix{static_cast<uint32_t>(size), recordChecksum(string_view(payload, size))};
+    const char* prefixBytes = reinterpret_cast<const char*>(&prefix);
+    lock_guard lock(bufferMutex);
+    pending.insert(pending.end(), prefixBytes, prefixBytes + sizeof(prefix));
+    pending.insert(pending.end(), payload, payload + size);
+    ++records;
+
+    if (pending.size() >= options.groupBytes && fd >= 0 && !failed) {
+        failed = !writeAll(fd, pending.data(), pending.size());
+        fileBytes += pending.size();
+        pending.clear();
+    }
+}
+
+void Journal::onUnitsChanged(const InventoryStore& /*store*/, const int itemNum, const int oldUnits,
+                             const int newUnits) {
+    char payload[sizeof(uint8_t) + sizeof(int64_t) + 2 * sizeof(int32_t)];
+    char* out = payload;
+    putValue(out, RECORD_UNITS_DELTA);
+    putValue(out, nowNanoseconds());
+    putValue(out, static_cast<int32_t>(itemNum));
+    putValue(out, static_cast<int32_t>(newUnits - oldUnits));
+    appendRecord(payload, sizeof(payload));
+}
+
+/*
+ * onUnitsChangedTogether function definition:
+ *  - A whole transaction becomes one record, so it is replayed completely or (if
+ *    the record was torn by a crash) not at all.
+ */
+void Journal::onUnitsChangedTogether(const InventoryStore& /*store*/, const UnitsChange* changes,
+                                     const size_t count) {
+    vector<char> payload(sizeof(uint8_t) + sizeof(int64_t) + sizeof(uint32_t) + count * 2 * sizeof(int32_t));
+    char* out = payload.data();
+    putValue(out, RECORD_TRANSACTION);
+    putValue(out, nowNanoseconds());
+    putValue(out, static_cast<uint32_t>(count));
+    for (size_t i = 0; i < count; ++i) {
+        putValue(out, static_cast<int32_t>(changes[i].itemNum));
+        putValue(out, static_cast<int32_t>(changes[i].newUnits - changes[i].oldUnits));
+    }
+    appendRecord(payload.data(), payload.size());
+}
+
+void Journal::onItemsAdded(const InventoryStore& store, const int firstItem, const int count) {
+    const int64_t timestamp = nowNanoseconds();
+    vector<char> payload;
+    for (int itemNum = firstItem; itemNum < firstItem + count; ++itemNum) {
+        const string_view description = store.getDescription(itemNum);
+        payload.resize(sizeof(uint8_t) + 2 * sizeof(int64_t) + 2 * sizeof(int32_t) + description.size());
+        char* out = payload.data();
+        putValue(out, RECORD_NEW_ITEM_CENTS);
+        putValue(out, timestamp);
+        putValue(out, store.getCost(itemNum).cents);
+        putValue(out, static_cast<int32_t>(store.getUnits(itemNum)));
+        putValue(out, static_cast<uint32_t>(description.size()));
+        if (!description.empty()) {
+            memcpy(out, description.data(), description.size());
+        }
+        appendRecord(payload.data(), payload.size());
+    }
+}
+
+/*
+ * commit function definition:
+ *  - One write call for every record buffered since the last commit.
+ *  - fsync when syncInterval has passed since the last one (0 = always); until
+ *    then the data is safe from a program crash but not from a power failure.
+ */
+bool Journal::commit() {
+#ifdef JOURNAL_POSIX
+    if (fd < 0) {
+        return false;
+    }
+    lock_guard lock(bufferMutex);
+    if (!pending.empty() && !failed) {
+        failed = !writeAll(fd, pending.data(), pending.size());
+        fileBytes += pending.size();
+    }
+    pending.clear();
+
+    const auto now = chrono::steady_clock::now();
+    if (!failed && options.syncInterval.count() >= 0 && now - lastSync >= options.syncInterval) {
+        failed = fsync(fd) != 0;
+        lastSync = now;
+    }
+#endif
+    return !failed;
+}
+
+/*
+ * checkpoint function definition:
+ *  - Writes the buffered records first, so nothing is lost if the snapshot fails.
+ *  - Saves the snapshot atomically, then replaces the journal with an empty one
+ *    based on it. A crash between the two steps leaves a stale journal, which
+ *    recovery recognizes by its base checksum and discards.
+ */
+bool Journal::checkpoint(const InventoryStore& inventory) {
+    if (!commit()) {
+        return false;
+    }
+    uint64_t checksum = 0;
+    if (!saveSnapshotFile(inventory, snapshotPath, &checksum)) {
+        return false;
+    }
+    return startFresh(checksum);
+}
+
+void Journal::close() {
+    if (observed != nullptr) {
+        observed->removeObserver(this);
+        observed = nullptr;
+    }
+#ifdef JOURNAL_POSIX
+    if (fd >= 0) {
+        options.syncInterval = chrono::milliseconds(0);
+        commit();
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+    pending.clear();
+}
+
+namespace {
+unique_ptr<Journal> activeJournal;
+}
+
+/*
+ * startJournal function definition:
+ *  - Recovers the inventory from snapshot + journal and prints what was restored.
+ */
+bool startJournal(const string& snapshotFile, const string& journalFile, InventoryStore& inventory,
+                  const JournalOptions& options) {
+    activeJournal = make_unique<Journal>(options);
+    RecoveryReport report;
+    if (!activeJournal->recover(snapshotFile, journalFile, inventory, report)) {
+        cout << "Error: Could not recover the inventory: " << report.error << ".\n";
+        activeJournal.reset();
+        return false;
+    }
+
+    if (report.snapshotLoaded) {
+        cout << "Loaded snapshot \"" << snapshotFile << "\" (" << report.snapshotItems << " item(s)).\n";
+    }
+    if (report.journalStale) {
+        cout << "Journal \"" << journalFile << "\" predates the snapshot and was discarded.\n";
+    }
+    if (report.recordsReplayed > 0) {
+        cout << "Replayed " << report.recordsReplayed << " journal record(s) from \"" << journalFile << "\".\n";
+    }
+    if (report.bytesDiscarded > 0) {
+        cout << "Discarded " << report.bytesDiscarded << " byte(s) of incomplete journal data.\n";
+    }
+    cout << "Journaling to \"" << journalFile << "\" (" << inventory.size() << " item(s) recovered in "
+         << fixed << setprecision(2) << report.seconds * 1000.0 << " ms).\n";
+    return true;
+}
+
+/*
+ * commitJournal function definition:
+ *  - Called at every command boundary; also compacts the journal into a new
+ *    snapshot once it has grown past the configured size.
+ */
+void commitJournal(const InventoryStore& inventory) {
+    if (!activeJournal) {
+        return;
+    }
+    if (!activeJournal->commit()) {
+        cout << "Error: Could not write to the journal. Changes are not being saved.\n";
+        return;
+    }
+    if (activeJournal->needsCompaction() && !activeJournal->checkpoint(inventory)) {
+        cout << "Error: Could not compact the journal into a snapshot.\n";
+    }
+}
+
+/*
+ * syncJournal function definition:
+ *  - Server workers call this once per batch of requests. Compaction is left to
+ *    the 'j' command and to the next console session, because a checkpoint
+ *    snapshots the whole store while other workers may still be changing it.
+ */
+bool syncJournal() {
+    return !activeJournal || activeJournal->commit();
+}
+
+/*
+ * checkpointJournal function definition:
+ *  - 'j' command: folds everything journaled so far into the snapshot.
+ */
+void checkpointJournal(const InventoryStore& inventory) {
+    if (!activeJournal) {
+        cout << "Journaling is off. Start the program with --journal <file> to enable it.\n";
+        return;
+    }
+    const size_t records = activeJournal->recordsSinceCheckpoint();
+    const uint64_t bytes = activeJournal->journalBytes();
+    if (!activeJournal->checkpoint(inventory)) {
+        cout << "Error: Checkpoint failed. The journal was kept.\n";
+        return;
+    }
+    cout << "Checkpoint complete: " << inventory.size() << " item(s) saved, " << records
+         << " journal record(s) (" << bytes << " bytes) folded into the snapshot.\n";
+}
+
+void stopJournal() {
+    activeJournal.reset();
+}
@@ -0,0 +1,160 @@
+// Specification File -> Journal.h
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "InventoryStore.h"
+
+using namespace std;
+
+/*
+    Journal (write-ahead log of stock mutations)
+    -----------------------------
+    Description:
+    An append-only file that records every change made to the inventory since the
+    last snapshot, so nothing is lost if the program stops unexpectedly. The journal
+    observes the InventoryStore (see InventoryObserver) and encodes each change as a
+    small record:
+
+        uint32 payloadSize | uint32 checksum(payload) | payload
+        payload = uint8 type | int64 timestamp (ns since epoch) | ...
+            type 1 (units delta): int32 item#, int32 delta
+            type 2 (new item):    float64 cost, int32 units, uint32 length, description
+            type 3 (transaction): uint32 count, count x (int32 item#, int32 delta)
+            type 4 (new item):    int64 cost in cents, int32 units, uint32 length, description
+
+    New items are written as type 4, so a cost comes back to the cent exactly as
+    it was stored; type 2 is only read, from journals written before type 4.
+
+    The file starts with a header naming the snapshot it applies on top of (by that
+    snapshot's checksum; 0 = empty inventory). Recovery loads the snapshot and
+    replays the records in order. A journal whose header names a different snapshot
+    is stale (its changes are already in the snapshot) and is discarded.
+
+    Group commit: records collect in memory and reach the file with one write call
+    per commit(), when the buffer fills, or at a command boundary. fsync is issued at
+    most once per syncInterval (0 = every commit, negative = never). Records may be
+    added from several threads at once (see InventoryStore's concurrency notes);
+    the group buffer is protected by a mutex. Checkpoints must run while no other
+    thread is changing stock.
+
+    Compaction (checkpoint): writes a new snapshot of the whole inventory, then
+    starts an empty journal based on it. This happens on request ('j') or whenever
+    the journal grows past compactBytes.
+
+    In Simpler Terms:
+    A diary of every stock movement. After a crash, the program reads the last save
+    and then re-plays the diary to get back to exactly where it was.
+*/
+
+// Tuning knobs for the journal.
+struct JournalOptions {
+    size_t groupBytes = 64 * 1024;                       // Commit when this much is buffered
+    chrono::milliseconds syncInterval{0};                // Minimum time between fsyncs
+    uint64_t compactBytes = 64ull * 1024 * 1024;         // Checkpoint when the journal exceeds this
+};
+
+// What happened while recovering at startup.
+struct RecoveryReport {
+    bool snapshotLoaded = false;
+    size_t snapshotItems = 0;
+    bool journalStale = false;     // Journal belonged to an older snapshot and was discarded
+    size_t recordsReplayed = 0;
+    size_t bytesDiscarded = 0;     // Torn/corrupt tail removed from the journal
+    double seconds = 0.0;
+    string error;                  // Non-empty if recovery could not proceed
+};
+
+class Journal : public InventoryObserver {
+public:
+    explicit Journal(JournalOptions options = {}) : options(options) {}
+    ~Journal() override;
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    /*
+        Loads snapshotFile (if it exists) into the empty inventory, replays
+        journalFile on top of it (if it exists and matches the snapshot), truncates
+        any torn tail and opens the journal for appending. Afterwards the journal
+        observes the inventory. Returns false (with report.error) on failure.
+    */
+    bool recover(const string& snapshotFile, const string& journalFile, InventoryStore& inventory,
+                 RecoveryReport& report);
+
+    // Writes buffered records with one write call; fsyncs according to syncInterval.
+    bool commit();
+
+    // Writes a fresh snapshot and restarts the journal on top of it.
+    bool checkpoint(const InventoryStore& inventory);
+
+    // True once the journal file has grown past options.compactBytes.
+    bool needsCompaction() const { return journalBytes() > options.compactBytes; }
+
+    // Commits, syncs and stops observing the inventory.
+    void close();
+
+    bool isOpen() const { return fd >= 0; }
+    uint64_t journalBytes() const {
+        lock_guard lock(bufferMutex);
+        return fileBytes + pending.size();
+    }
+    size_t recordsSinceCheckpoint() const {
+        lock_guard lock(bufferMutex);
+        return records;
+    }
+
+    void onItemsAdded(const InventoryStore& store, int firstItem, int count) override;
+    void onUnitsChanged(const InventoryStore& store, int itemNum, int oldUnits, int newUnits) override;
+    void onUnitsChangedTogether(const InventoryStore& store, const UnitsChange* changes, size_t count) override;
+
+private:
+    JournalOptions options;
+    string snapshotPath;
+    string journalPath;
+    InventoryStore* observed = nullptr;
+    int fd = -1;
+    mutable mutex bufferMutex; // Guards pending, fileBytes, records and failed
+    vector<char> pending;
+    uint64_t fileBytes = 0;
+    size_t records = 0;
+    bool failed = false;
+    chrono::steady_clock::time_point lastSync{};
+
+    bool startFresh(uint64_t baseChecksum);
+    bool startObserving(bool ready, InventoryStore& inventory, RecoveryReport& report,
+                        chrono::steady_clock::time_point start);
+    void appendRecord(const char* payload, size_t size);
+};
+
+/*
+    Application-level journal
+    -----------------------------
+    The program uses at most one journal, owned here so the command handlers and
+    main() can reach it without passing it through every function.
+*/
+
+// Recovers and starts journaling (called from main for --journal). Prints a report.
+bool startJournal(const string& snapshotFile, const string& journalFile, InventoryStore& inventory,
+                  const JournalOptions& options);
+
+// Commits buffered records and compacts if the journal has grown too large.
+// Called after each command; does nothing when no journal is active.
+void commitJournal(const InventoryStore& inventory);
+
+// Commits buffered records without compacting. Safe to call from several threads
+// (server workers); returns false if the journal could not be written.
+bool syncJournal();
+
+// 'j' command handler: checkpoints (snapshot + empty journal) and reports the result.
+void checkpointJournal(const InventoryStore& inventory);
+
+// Commits and closes the active journal (called at exit).
+void stopJournal();
+
+#endif // JOURNAL_H
@@ -1,56 +1,127 @@
 // Implementation File -> Menu.cpp
 #include "Menu.h"
 #include "InventoryItem.h"
-#include "SplitLineToArray.h"
+#include "BulkLoader.h"
+#include "ColumnKernels.h"
+#include "BatchMode.h"
+#include "RecordWriter.h"
+#include "ParallelIngest.h"
+#include "BinarySnapshot.h"
+#include "Journal.h"
+#include "SearchIndex.h"
+#include "StockStats.h"
+#include "Report.h"
+#include "PagedStore.h"
+#include "ImportValidator.h"
+#include "Metrics.h"
+#include "DeltaExport.h"
+#include "ShardedInventory.h"
 #include <iostream>
 #include <iomanip>
 #include <limits>
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <type_traits>
 
 using namespace std;
 
+// Most rows the 'f' command prints; the total number of matches is always reported.
+static constexpr size_t FIND_ROWS_SHOWN = 50;
+
+// Rejected lines 'i' shows on the console; the reject file has all of them.
+static constexpr size_t REJECTS_SHOWN = 5;
+
 /*
  * Switch Statement:
  *  - Processes a single-character user command and performs the corresponding action.
  *
  * Parameters:
  *  - command: The user's selected command (as a lowercase character).
- *  - inventory: Reference to the inventory vector storing InventoryItem objects.
- *  - itemCount: Reference to the current number of items in the inventory.
+ *  - inventory: Reference to the InventoryStore holding all inventory items.
+ *  - arguments: The rest of the command line (used by 'i', 'p', 'k', 'f', 'o', 'd' and 'm').
  *
  * Command Actions:
  *  - 'h': Displays the help menu with a list of available commands.
- *  - 'i': Loads inventory items from a file (appends to current inventory).
+ *  - 'i': Loads inventory items from a file (appends to current inventory), rejects to a file.
+ *  - 'b': Bulk-loads a large file through the memory-mapped loader and reports throughput.
+ *  - 'l': Loads a list of files (or wildcard patterns) in parallel.
  *  - 'n': Prompts user to create a new inventory item (with description, cost, and quantity).
  *  - 'a': Adds parts (quantity) to an existing inventory item, ensuring constraints.
  *  - 'r': Removes parts (quantity) from an inventory item, validating the quantity.
- *  - 'p': Prints a formatted list of all current inventory items.
+ *  - 'k': Applies a pick list file: many add/remove lines, all applied or none.
+ *  - 'p': Prints a formatted list of the inventory items (paged, sorted or filtered on request).
+ *  - 'f': Finds items by description text or by a range of units or cost.
  *  - 'o': Saves the current inventory to a file in a standardized format.
+ *  - 'd': Writes only the items changed or added since the last 'o' or 'd' (a delta file).
+ *  - 's': Saves the inventory as a binary snapshot (fast to load back with 'i'/'b'/'l').
+ *  - 'v': Prints a stock valuation report computed from the cost/units columns.
+ *  - 't': Prints the running stock statistics (no scan of the items).
+ *  - 'x': Executes a transaction file in batch mode (no prompts per transaction).
+ *  - 'w': Writes the inventory to a file on a background thread.
+ *  - 'j': Checkpoints the journal (new snapshot, empty journal) when journaling is on.
+ *  - 'm': Prints the built-in metrics, or exports them to a file (INVENTORY_METRICS builds).
  *  - 'q': Displays exit message (actual program termination is handled in main()).
  *  - default: Displays an error for unrecognized or invalid commands.
  */
-void handleCommand(const char command, vector<InventoryItem>& inventory, int& itemCount) {
+void handleCommand(const char command, InventoryStore& inventory, const string_view arguments) {
     switch (command) {
         case 'h':
             showMenu();
             break;
         case 'i':
-            inputFromFile(inventory, itemCount);
+            inputFromFile(inventory, arguments);
+            break;
+        case 'b':
+            bulkInputFromFile(inventory);
+            break;
+        case 'l':
+            loadManyFiles(inventory);
             break;
         case 'n':
-            createNewItem(inventory, itemCount);
+            createNewItem(inventory);
             break;
         case 'a':
-            addParts(inventory, itemCount);
+            addParts(inventory);
             break;
         case 'r':
-            removeParts(inventory, itemCount);
+            removeParts(inventory);
+            break;
+        case 'k':
+            runPickList(inventory, arguments);
             break;
         case 'p':
-            printInventory(inventory, itemCount);
+            printInventory(inventory, arguments);
+            break;
+        case 'f':
+            findItems(inventory, arguments);
             break;
         case 'o':
-            outputToFile(inventory, itemCount);
+            outputToFile(inventory, arguments);
+            break;
+        case 'd':
+            exportDelta(inventory, arguments);
+            break;
+        case 's':
+            saveSnapshot(inventory);
+            break;
+        case 'v':
+            printValuation(inventory);
+            break;
+        case 't':
+            printStockStats();
+            break;
+        case 'x':
+            runBatch(inventory);
+            break;
+        case 'w':
+            outputToFileInBackground(inventory);
+            break;
+        case 'j':
+            checkpointJournal(inventory);
+            break;
+        case 'm':
+            printMetrics(arguments);
             break;
         case 'q':
             cout << "Exiting program.\n";
@@ -70,12 +141,24 @@ void handleCommand(const char command, vector<InventoryItem>& inventory, int& it
 void showMenu() {
     cout << "Supported commands:\n"
      << "  h -> Print Help text\n"
-     << "  i -> Input inventory data from a file\n"
+     << "  i -> Input inventory data from a file (i [file [vendor]]; rejected lines go to <file>.rejects)\n"
+     << "  b -> Bulk input from a large file (fast, summary only)\n"
+     << "  l -> Load many files (or patterns like *.txt) in parallel\n"
      << "  n -> New inventory Item\n"
      << "  a -> Add parts\n"
      << "  r -> Remove parts\n"
-     << "  p -> Print inventory list\n"
-     << "  o -> Output inventory data to a file\n"
+     << "  k -> Kit / pick list from a file (k [file]; every line applies or none)\n"
+     << "  p -> Print inventory list (p [first [count]] [by cost|units|description [desc]] [> file] [filter])\n"
+     << "  f -> Find items (f [text | units < 5 | cost between 2 and 4])\n"
+     << "  o -> Output inventory data to a file (o [file])\n"
+     << "  d -> Delta output: only items changed or added since the last o/d (d [file])\n"
+     << "  s -> Save a binary snapshot of the inventory\n"
+     << "  v -> Valuation report (total stock value, cost range, low stock)\n"
+     << "  t -> Stock statistics (kept up to date, instant at any size)\n"
+     << "  x -> Execute a transaction file in batch mode\n"
+     << "  w -> Write inventory data to a file in the background\n"
+     << "  j -> Journal checkpoint (fold logged changes into the snapshot)\n"
+     << "  m -> Metrics (m [text|prometheus|json] [> file]; latencies, throughput, I/O)\n"
      << "  q -> Quit (end the program)\n";
 }
 
@@ -84,76 +167,141 @@ void showMenu() {
  *  - Loads inventory items from a specified input file into the inventory array.
  *
  * Parameters:
- *  - inventory: Reference to the vector of InventoryItem objects.
- *  - itemCount: Reference to the current number of items in inventory (will be updated).
+ *  - inventory: Reference to the InventoryStore or PagedStore (new items are appended to it).
+ *  - arguments: What followed 'i' on the command line: the file name, if given,
+ *    and the record layout ("vendor"; see RecordSchema.h) if it is not the usual one.
  *
  * Behavior:
- *  - Prompts the user to enter the name of the input file.
- *  - Repeats prompt until a valid file is successfully opened.
- *  - Reads the file line by line, expecting the format: index|description|cost|units.
- *  - Skips malformed lines or lines with invalid formats.
- *  - Validates:
- *      - Exactly 4 fields must be present.
- *      - Units must be within 0–30.
- *      - File parsing must succeed (no conversion errors).
- *  - Limits total inventory to 100 items.
- *  - Appends successfully loaded items to the inventory array.
+ *  - Prompts for the file name (unless given) and repeats until one can be opened.
+ *  - If the file is a binary snapshot (see BinarySnapshot.h), loads it as a whole
+ *    (in-memory store only).
+ *  - Otherwise checks every line (index|description|cost|units, or the layout
+ *    given) against the import rules (see ImportValidator.h), in parallel, and appends the valid records.
+ *  - Nothing is printed per bad line: the rejects are counted by reason, the first
+ *    few are shown, and all of them go to "<file>.rejects" (line|reason|text) in
+ *    one write.
  *  - Outputs the number of valid records loaded to the user.
  */
-void inputFromFile(vector<InventoryItem>& inventory, int& itemCount) {
+template <typename Store>
+static void inputFromFileInto(Store& inventory, const string_view arguments) {
     string filename;
-    ifstream inputFile;
+    RecordLayout layout = RecordLayout::Inventory;
+    if (const size_t first = arguments.find_first_not_of(" \t"); first != string_view::npos) {
+        const size_t end = min(arguments.find_first_of(" \t", first), arguments.size());
+        filename = string(arguments.substr(first, end - first));
+        if (const size_t next = arguments.find_first_not_of(" \t", end); next != string_view::npos) {
+            const string_view name = arguments.substr(next, arguments.find_first_of(" \t", next) - next);
+            if (!parseRecordLayout(name, layout)) {
+                cout << "Error: Unknown record layout \"" << name << "\" (inventory or vendor).\n";
+                return;
+            }
+        }
+    }
 
     // Loop until a valid file is opened
+    MappedFile inputFile;
     while (true) {
-        cout << "Enter name of input file: ";
-        cin >> filename;
-
-        inputFile.open(filename);
-        if (inputFile.is_open()) {
+        if (filename.empty()) {
+            cout << "Enter name of input file: ";
+            cin >> filename;
+        }
+        if (inputFile.open(filename)) {
             break; // valid file found, exit loop
         }
 
         cout << "Error: Could not open file \"" << filename << "\". Please try again.\n";
-        inputFile.clear(); // reset any error state
+        filename.clear();
+        if (!cin) return;
     }
 
-    string line;
-    int linesLoaded = 0;
-
-    while (getline(inputFile, line)) {
-        if (itemCount >= 100) {
-            cout << "Inventory full (100 items max). Remaining file data ignored.\n";
-            break;
+    if (isSnapshotData(inputFile.view())) {
+        if constexpr (is_same_v<Store, InventoryStore>) {
+            const int before = inventory.size();
+            if (const SnapshotResult result = loadSnapshotData(inputFile.view(), inventory); result != SnapshotResult::Ok) {
+                cout << "Error: \"" << filename << "\": " << describeSnapshotResult(result) << ".\n";
+                return;
+            }
+            cout << inventory.size() - before << " record(s) loaded to inventory from snapshot.\n";
+        } else {
+            cout << "Error: \"" << filename << "\" is a snapshot; snapshots load into memory, not into a page file.\n";
         }
+        return;
+    }
 
-        string fields[4];
+    const ImportSummary summary = importRecords(inputFile.view(), inventory, importRules(), 0, layout);
+    cout << summary.recordsLoaded << " record(s) loaded to inventory.\n";
+    if (summary.rejects.empty()) {
+        return;
+    }
 
-        if (int numFields = splitLineToArray(line, "|", fields, 4); numFields != 4) {
-            cout << "Warning: Skipping malformed line: " << line << '\n';
-            continue;
+    cout << summary.rejects.size() << " line(s) rejected (rules: " << describeImportRules(importRules()) << "):\n";
+    for (size_t reason = 0; reason < REJECT_REASONS; ++reason) {
+        if (summary.rejectsByReason[reason] > 0) {
+            cout << "  " << setw(10) << summary.rejectsByReason[reason] << "  "
+                 << describeRejectReason(static_cast<RejectReason>(reason)) << '\n';
         }
+    }
+    for (size_t i = 0; i < min(summary.rejects.size(), REJECTS_SHOWN); ++i) {
+        const ImportReject& reject = summary.rejects[i];
+        cout << "  Line " << reject.line << " (" << describeRejectReason(reject.reason) << "): " << reject.text << '\n';
+    }
 
-        try {
-            string description = fields[1];
-            double cost = stod(fields[2]);
-            int units = stoi(fields[3]);
+    const string rejectFile = filename + ".rejects";
+    if (writeRejectFile(rejectFile, summary.rejects)) {
+        cout << "All rejected lines were written to \"" << rejectFile << "\".\n";
+    } else {
+        cout << "Error: Could not write \"" << rejectFile << "\".\n";
+    }
+}
 
-            if (units < 0 || units > 30) {
-                cout << "Warning: Invalid units (" << units << ") on line: " << line << '\n';
-                continue;
-            }
+void inputFromFile(InventoryStore& inventory, const string_view arguments) {
+    inputFromFileInto(inventory, arguments);
+}
+
+void inputFromFile(PagedStore& inventory, const string_view arguments) {
+    inputFromFileInto(inventory, arguments);
+}
 
-            inventory[itemCount] = InventoryItem(description, cost, units);
-            itemCount++;
-            linesLoaded++;
-        } catch (...) {
-            cout << "Warning: Skipping line with invalid number format: " << line << '\n';
+/*
+ * bulkInputFromFile function definition:
+ *  - Loads a (possibly very large) inventory file through the memory-mapped bulk loader.
+ *
+ * Parameters:
+ *  - inventory: Reference to the InventoryStore (new items are appended to it).
+ *
+ * Behavior:
+ *  - Prompts for the file name until one can be opened, like inputFromFile.
+ *  - Applies the same validation rules as inputFromFile, but instead of printing a
+ *    warning per bad line it reports a single count of skipped records.
+ *  - Prints the number of records loaded and the load throughput (MB/s, records/s).
+ */
+void bulkInputFromFile(InventoryStore& inventory) {
+    string filename;
+    BulkLoadStats stats;
+
+    while (true) {
+        cout << "Enter name of input file: ";
+        cin >> filename;
+
+        if (bulkLoadFile(filename, inventory, stats)) {
+            break;
         }
+
+        cout << "Error: Could not open file \"" << filename << "\". Please try again.\n";
+    }
+
+    if (stats.formatError != nullptr) {
+        cout << "Error: \"" << filename << "\": " << stats.formatError << ".\n";
+        return;
+    }
+    if (stats.recordsRejected > 0) {
+        cout << "Warning: Skipped " << stats.recordsRejected << " malformed or invalid record(s).\n";
     }
 
-    inputFile.close();
-    cout << linesLoaded << " record(s) loaded to array.\n";
+    cout << stats.recordsLoaded << " record(s) loaded to inventory.\n"
+         << fixed << setprecision(2)
+         << "Scanned " << stats.bytesScanned << " bytes in " << stats.seconds * 1000.0 << " ms ("
+         << stats.megabytesPerSecond() << " MB/s, " << stats.recordsPerSecond() << " records/s).\n";
 }
 
 /*
@@ -161,27 +309,21 @@ void inputFromFile(vector<InventoryItem>& inventory, int& itemCount) {
  *  - Prompts the user to create and add a new inventory item.
  *
  * Parameters:
- *  - inventory: Reference to the vector of InventoryItem objects.
- *  - itemCount: Reference to the number of current inventory items (will be incremented).
+ *  - inventory: Reference to the InventoryStore or PagedStore (the new item is appended to it).
  *
  * Behavior:
- *  - First checks if inventory has reached the 100-item limit.
- *      - If full, displays an error and exits the function.
  *  - Prompts user to enter a description, cost, and quantity.
  *      - Uses getline() for description to allow spaces.
  *      - Validates unit cost:
  *          - Must be numeric and non-negative.
  *      - Validates quantity:
  *          - Must be an integer between 0 and 30.
- *  - Adds the validated item to the inventory array.
+ *  - Appends the validated item to the inventory store.
  *  - Displays confirmation of the newly added item and updated inventory count.
+ *  - Returns the new item's number, or -1 if the store refused the item.
  */
-void createNewItem(vector<InventoryItem>& inventory, int& itemCount) {
-    if (itemCount >= 100) {
-        cout << "Error: Inventory is full (100 items max).\n";
-        return;
-    }
-
+template <typename Store>
+static int createNewItemIn(Store& inventory) {
     string desc;
     double cost;
     int units;
@@ -205,7 +347,7 @@ void createNewItem(vector<InventoryItem>& inventory, int& itemCount) {
     // Validate quantity input
     cout << "Enter initial quantity for the new Item: ";
     cin >> units;
-    while (cin.fail() || units < 0 || units > 30) {
+    while (cin.fail() || units < 0 || units > MAX_UNITS) {
         cin.clear();
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
         cout << "ERROR: Initial quantity must be an integer between 0 - 30.\n"
@@ -213,12 +355,25 @@ void createNewItem(vector<InventoryItem>& inventory, int& itemCount) {
         cin >> units;
     }
 
-    inventory[itemCount] = InventoryItem(desc, cost, units);
+    const int itemNum = inventory.addItem(InventoryItem(desc, cost, units));
+    if (itemNum < 0) {
+        cout << "Error: Could not add the item (" << inventory.lastFailure() << ").\n";
+        return -1;
+    }
     cout << "Announcing a new inventory Item: " << desc << endl;
 
-    itemCount++;
+    const int itemCount = inventory.size();
     cout << "We now have " << itemCount << " different inventory Item"
          << (itemCount == 1 ? ".\n" : "s in stock!\n");
+    return itemNum;
+}
+
+int createNewItem(InventoryStore& inventory) {
+    return createNewItemIn(inventory);
+}
+
+int createNewItem(PagedStore& inventory) {
+    return createNewItemIn(inventory);
 }
 
 /*
@@ -226,21 +381,21 @@ void createNewItem(vector<InventoryItem>& inventory, int& itemCount) {
  *  - Adds parts to an existing inventory item.
  *
  * Parameters:
- *  - inventory: Reference to the vector of InventoryItem objects.
- *  - itemCount: Current number of items in inventory.
+ *  - inventory: Reference to the InventoryStore or PagedStore holding all inventory items.
  *
  * Behavior:
  *  - If the inventory is empty, displays an error and exits early.
  *  - Prompts user for an item number:
- *      - Validates that the input is numeric and within the valid range (0 to itemCount - 1).
+ *      - Validates that the input is numeric and within the valid range (0 to size - 1).
  *  - Prompts user for quantity to add:
  *      - Validates that input is numeric and non-negative.
  *      - Ensures total quantity after addition does not exceed 30.
  *  - Updates the item’s quantity accordingly.
  *  - Displays a confirmation message showing how many units were added and to which item.
  */
-void addParts(vector<InventoryItem>& inventory, const int itemCount) {
-    if (itemCount == 0) {
+template <typename Store>
+static void addPartsTo(Store& inventory) {
+    if (inventory.empty()) {
         cout << "Error: Inventory is empty. No items to modify.\n";
         return;
     }
@@ -249,11 +404,11 @@ void addParts(vector<InventoryItem>& inventory, const int itemCount) {
     cout << "Choose an Item Number: ";
     cin >> itemNum;
 
-    while (cin.fail() || itemNum < 0 || itemNum >= itemCount) {
+    while (cin.fail() || !inventory.contains(itemNum)) {
         cin.clear();
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
         cout << "Error: Invalid item number.\n"
-             << "Please enter a valid item number (0 to " << itemCount - 1 << "): ";
+             << "Please enter a valid item number (0 to " << inventory.size() - 1 << "): ";
         cin >> itemNum;
     }
 
@@ -261,7 +416,7 @@ void addParts(vector<InventoryItem>& inventory, const int itemCount) {
     cout << "How many parts to add? ";
     cin >> quantityToAdd;
 
-    while (cin.fail() || quantityToAdd < 0 || inventory[itemNum].getUnits() + quantityToAdd > 30) {
+    while (cin.fail() || quantityToAdd < 0 || inventory.getUnits(itemNum) + quantityToAdd > MAX_UNITS) {
         cin.clear();
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
 
@@ -275,22 +430,29 @@ void addParts(vector<InventoryItem>& inventory, const int itemCount) {
         cin >> quantityToAdd;
     }
 
-    inventory[itemNum].setUnits(inventory[itemNum].getUnits() + quantityToAdd);
+    inventory.addUnits(itemNum, quantityToAdd);
     cout << quantityToAdd << " units added to item #" << itemNum << ".\n";
 }
 
+void addParts(InventoryStore& inventory) {
+    addPartsTo(inventory);
+}
+
+void addParts(PagedStore& inventory) {
+    addPartsTo(inventory);
+}
+
 /*
  * removeParts function definition:
  *  - Removes parts (units) from an existing inventory item.
  *
  * Parameters:
- *  - inventory: Reference to the vector of InventoryItem objects.
- *  - itemCount: Current number of items in the inventory.
+ *  - inventory: Reference to the InventoryStore or PagedStore holding all inventory items.
  *
  * Behavior:
  *  - If the inventory is empty, displays an error and exits early.
  *  - Prompts user to enter an item number:
- *      - Validates that input is numeric and within the valid item index range (0 to itemCount - 1).
+ *      - Validates that input is numeric and within the valid item index range (0 to size - 1).
  *  - Prompts user to enter quantity to remove:
  *      - Validates that the input is numeric and non-negative.
  *      - Ensures user does not remove more units than currently available.
@@ -298,8 +460,9 @@ void addParts(vector<InventoryItem>& inventory, const int itemCount) {
  *  - Displays a confirmation message showing how many units were removed,
  *    from which item, and what the new quantity is.
  */
-void removeParts(vector<InventoryItem>& inventory, const int itemCount) {
-    if (itemCount == 0) {
+template <typename Store>
+static void removePartsFrom(Store& inventory) {
+    if (inventory.empty()) {
         cout << "Error: Inventory is empty. No items to modify.\n";
         return;
     }
@@ -308,11 +471,11 @@ void removeParts(vector<InventoryItem>& inventory, const int itemCount) {
     cout << "Enter item number: ";
     cin >> itemNum;
 
-    while (cin.fail() || itemNum < 0 || itemNum >= itemCount) {
+    while (cin.fail() || !inventory.contains(itemNum)) {
         cin.clear();
         cin.ignore(numeric_limits<streamsize>::max(), '\n');
         cout << "Error: Invalid item number.\n"
-             << "Please enter a valid item number (must be between 0 and " << itemCount - 1 << "): ";
+             << "Please enter a valid item number (must be between 0 and " << inventory.size() - 1 << "): ";
         cin >> itemNum;
     }
 
@@ -320,7 +483,7 @@ void removeParts(vector<InventoryItem>& inventory, const int itemCount) {
     cout << "Enter quantity to remove: ";
     cin >> quantityToRemove;
 
-    while (cin.fail() || quantityToRemove < 0 || quantityToRemove > inventory[itemNum].getUnits()) {
+    while (cin.fail() || quantityToRemove < 0 || quantityToRemove > inventory.getUnits(itemNum)) {
         if (cin.fail()) {
             cout << "Error: Invalid input. Please enter a numeric value.\n";
         } else if (quantityToRemove < 0) {
@@ -336,45 +499,146 @@ void removeParts(vector<InventoryItem>& inventory, const int itemCount) {
         cin >> quantityToRemove;
     }
 
-    const int newUnits = inventory[itemNum].getUnits() - quantityToRemove;
-    inventory[itemNum].setUnits(newUnits);
+    inventory.removeUnits(itemNum, quantityToRemove);
+    const int newUnits = inventory.getUnits(itemNum);
     cout << quantityToRemove << " unit(s) removed from item #" << itemNum
          << ". New quantity: " << newUnits << ".\n";
 }
 
+void removeParts(InventoryStore& inventory) {
+    removePartsFrom(inventory);
+}
+
+void removeParts(PagedStore& inventory) {
+    removePartsFrom(inventory);
+}
+
 /*
  * printInventory function definition:
- *  - Displays the current inventory list in a tabular format.
+ *  - Displays the inventory list in a tabular format.
  *
  * Parameters:
- *  - inventory: A constant reference to the vector of InventoryItem objects.
- *  - itemCount: The total number of items currently in the inventory.
+ *  - inventory: A constant reference to the InventoryStore or PagedStore holding all inventory items.
+ *  - arguments: What was typed after 'p' (see parseReportRequest in Report.h), e.g.
+ *    "1000 50" (50 rows from row 1000), "by cost desc", "units < 5", "> report.txt".
  *
  * Behavior:
- *  - Prints column headers for item number, description, cost, and quantity.
- *  - Draws a visual separator line beneath the headers.
- *  - Iterates through the inventory vector up to itemCount:
- *      - Formats each record with appropriate spacing and alignment.
- *      - Uses left/right alignment and fixed-point precision for clean output.
- *  - At the end, displays the number of records printed with correct pluralization.
+ *  - Prints column headers for item number, description, cost, and quantity,
+ *    then the requested rows, then how many records there are.
+ *  - The rows are formatted by writeReport into a large buffer that is written in
+ *    one piece per megabyte; the console is never flushed row by row.
+ *  - With "> file" the same report goes to that file instead (replaced
+ *    atomically), and only a one-line confirmation is printed.
+ *  - A paged store takes first/count and "> file" but no order or filter.
  */
-void printInventory(const vector<InventoryItem>& inventory, const int itemCount) {
-    cout << left << setw(10) << "Item #"
-         << setw(45) << "Description"
-         << right << setw(8) << "Cost"
-         << setw(10) << "Quantity" << endl;
+template <typename Store>
+static void printInventoryOf(const Store& inventory, const string_view arguments) {
+    ReportRequest request;
+    const char* reason = nullptr;
+    if (!parseReportRequest(arguments, request, reason)) {
+        cout << "Error: " << reason << ".\n";
+        return;
+    }
+    if constexpr (is_same_v<Store, PagedStore>) {
+        if (request.order != ReportRequest::Order::ItemNumber || request.descending || request.filtered) {
+            cout << "Error: a paged store is listed in item-number order only (no sorting or filters).\n";
+            return;
+        }
+    }
+
+    if (request.outputFile.empty()) {
+        writeReport(inventory, request, [](const string_view text) {
+            cout.write(text.data(), static_cast<streamsize>(text.size()));
+        });
+        cout.flush();
+        return;
+    }
+
+    const auto start = chrono::steady_clock::now();
+    AtomicFileWriter writer;
+    if (!writer.open(request.outputFile)) {
+        cout << "Error: Could not create file \"" << request.outputFile << "\".\n";
+        return;
+    }
+    const ReportSummary summary = writeReport(inventory, request, [&writer](const string_view text) {
+        writer.append(text);
+    });
+    if (!writer.commit()) {
+        cout << "Error: Could not write file \"" << request.outputFile << "\".\n";
+        return;
+    }
+    const double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << summary.rowsShown << " row(s) written to \"" << request.outputFile << "\" in " << fixed
+         << setprecision(2) << milliseconds << " ms.\n";
+}
+
+void printInventory(const InventoryStore& inventory, const string_view arguments) {
+    printInventoryOf(inventory, arguments);
+}
+
+void printInventory(const PagedStore& inventory, const string_view arguments) {
+    printInventoryOf(inventory, arguments);
+}
+
+/*
+ * findItems function definition:
+ *  - Finds items by description text or by a range of units or cost.
+ *
+ * Parameters:
+ *  - inventory: Reference to the InventoryStore holding all inventory items.
+ *  - arguments: What was typed after 'f', e.g. "hex bolt" or "units < 5".
+ *
+ * Behavior:
+ *  - If inventory is empty, notifies the user and returns.
+ *  - Searches for the arguments, or reads one line if there are none: text to
+ *    look for in the descriptions (any case), or a range such as "units < 5",
+ *    "units = 0", "cost >= 10" or "cost between 2 and 4".
+ *  - Answers from the search index (built on the first search, then kept up to
+ *    date), prints the first FIND_ROWS_SHOWN matches in the printInventory layout,
+ *    and reports how many items matched and how long the search took.
+ */
+void findItems(InventoryStore& inventory, const string_view arguments) {
+    if (inventory.empty()) {
+        cout << "Inventory is empty. Nothing to search.\n";
+        return;
+    }
 
-    cout << string(73, '_') << endl;
+    string line;
+    if (const size_t first = arguments.find_first_not_of(" \t"); first != string_view::npos) {
+        line = string(arguments.substr(first));
+    } else {
+        cout << "Find (text, \"units < 5\" or \"cost between 2 and 4\"): ";
+        getline(cin, line);
+    }
 
-    for (int i = 0; i < itemCount; ++i) {
-        cout << left << setw(10) << i
-             << setw(45) << inventory[i].getDescription()
-             << right << fixed << setprecision(2)
-             << setw(8) << inventory[i].getCost()
-             << setw(10) << inventory[i].getUnits() << endl;
+    SearchQuery query;
+    const char* reason = nullptr;
+    if (!parseSearchQuery(line, query, reason)) {
+        cout << "Error: " << reason << ".\n";
+        return;
     }
 
-    cout << itemCount << " record" << (itemCount == 1 ? ".\n" : "s.\n");
+    const auto start = chrono::steady_clock::now();
+    const SearchResult result = searchIndexFor(inventory).search(query, FIND_ROWS_SHOWN);
+    const double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    if (result.total == 0) {
+        cout << "No items match.\n";
+        return;
+    }
+
+    string rows;
+    appendReportHeader(rows);
+    for (const int i : result.items) {
+        appendReportRow(rows, i, inventory.getDescription(i), inventory.getCost(i), inventory.getUnits(i));
+    }
+    cout << rows;
+
+    cout << result.total << " matching item" << (result.total == 1 ? "" : "s");
+    if (result.total > result.items.size()) {
+        cout << " (first " << result.items.size() << " shown)";
+    }
+    cout << " found in " << fixed << setprecision(3) << milliseconds << " ms.\n";
 }
 
 /*
@@ -382,47 +646,511 @@ void printInventory(const vector<InventoryItem>& inventory, const int itemCount)
  *  - Outputs the current inventory data to a user-specified file in pipe-delimited format.
  *
  * Parameters:
- *  - inventory: A constant reference to the vector of InventoryItem objects.
- *  - itemCount: The total number of items currently in the inventory.
+ *  - inventory: A constant reference to the InventoryStore or PagedStore holding all inventory items.
+ *  - arguments: What was typed after 'o': the file name, if given.
  *
  * Behavior:
  *  - If inventory is empty, notifies the user and aborts the write operation.
- *  - Repeatedly prompts the user until a valid file can be opened for output.
- *  - Each inventory item is written in the format: index|description|cost|units.
- *      - Uses fixed-point notation with 2 decimal places for cost values.
- *  - Once all items are written, the file is closed and a confirmation message is printed.
+ *  - Writes to the file named in the arguments, or prompts until a valid file can
+ *    be opened for output.
+ *  - Writes the records through writeInventoryFile (buffered, replaced atomically).
+ *  - For the in-memory store, clears the pending changes first: the next 'd'
+ *    starts from this export. If the named file cannot be written they are
+ *    pending again.
+ *  - Once all items are written, a confirmation message is printed.
  */
-void outputToFile(const vector<InventoryItem>& inventory, const int itemCount) {
+template <typename Store>
+static void outputToFileFrom(const Store& inventory, const string_view arguments) {
+    const int itemCount = inventory.size();
     if (itemCount == 0) {
         cout << "Inventory is empty. Nothing to write.\n";
         return;
     }
 
+    vector<int> pending;
+    if constexpr (is_same_v<Store, InventoryStore>) {
+        pending = clearPendingChanges();
+    }
+
     string filename;
-    ofstream outputFile;
+    if (const size_t first = arguments.find_first_not_of(" \t"); first != string_view::npos) {
+        filename = string(arguments.substr(first, arguments.find_first_of(" \t", first) - first));
+        if (!writeInventoryFile(inventory, filename)) {
+            if constexpr (is_same_v<Store, InventoryStore>) {
+                restorePendingChanges(pending);
+            }
+            cout << "Error: Could not create file \"" << filename << "\".\n";
+            return;
+        }
+    } else {
+        // Prompt until a valid file is successfully opened and written
+        while (true) {
+            cout << "Enter name of output file: ";
+            cin >> filename;
 
-    // Prompt until a valid file is successfully opened for writing
-    while (true) {
-        cout << "Enter name of output file: ";
-        cin >> filename;
+            if (writeInventoryFile(inventory, filename)) break;
+
+            cout << "Error: Could not create file \"" << filename << "\". Please try again.\n";
+        }
+    }
 
-        outputFile.open(filename);
+    cout << itemCount << " record(s) written to \"" << filename << "\".\n";
+}
 
-        outputFile.open(filename);
-        if (outputFile) break;
+void outputToFile(const InventoryStore& inventory, const string_view arguments) {
+    outputToFileFrom(inventory, arguments);
+}
 
-        cout << "Error: Could not create file \"" << filename << "\". Please try again.\n";
-        outputFile.clear(); // Reset error flags
+void outputToFile(const PagedStore& inventory, const string_view arguments) {
+    outputToFileFrom(inventory, arguments);
+}
+
+/*
+ * outputToFileInBackground function definition:
+ *  - Starts writing the inventory to a user-specified file on a worker thread.
+ *
+ * Parameters:
+ *  - inventory: A constant reference to the InventoryStore holding all inventory items.
+ *
+ * Behavior:
+ *  - If inventory is empty, notifies the user and aborts the write operation.
+ *  - If a background write is still running, tells the user to try again later.
+ *  - Otherwise prompts for the file name, freezes the stock levels (copy-on-write,
+ *    nothing is copied up front) and returns to the command loop immediately; the
+ *    outcome is reported after a later command.
+ *  - The file contains the inventory as it was when the command was entered.
+ */
+void outputToFileInBackground(const InventoryStore& inventory) {
+    if (inventory.empty()) {
+        cout << "Inventory is empty. Nothing to write.\n";
+        return;
     }
 
-    // Write each inventory item to the file in pipe-delimited format
-    for (int i = 0; i < itemCount; ++i) {
-        outputFile << i << "|"
-                   << inventory[i].getDescription() << "|"
-                   << fixed << setprecision(2) << inventory[i].getCost() << "|"
-                   << inventory[i].getUnits() << '\n';
+    string filename;
+    cout << "Enter name of output file: ";
+    cin >> filename;
+
+    if (!startBackgroundExport(inventory, filename)) {
+        cout << "Error: A background write is already in progress. Please try again later.\n";
+        return;
     }
 
-    outputFile.close();
-    cout << itemCount << " record(s) written to \"" << filename << "\".\n";
+    cout << "Writing " << inventory.size() << " record(s) to \"" << filename << "\" in the background.\n";
+}
+
+/*
+ * printValuation function definition:
+ *  - Prints a stock valuation summary for the whole inventory.
+ *
+ * Parameters:
+ *  - inventory: A constant reference to the InventoryStore holding all inventory items.
+ *
+ * Behavior:
+ *  - If inventory is empty, notifies the user and returns.
+ *  - Prompts for a low-stock threshold (0–30 units).
+ *  - Computes total units, total stock value (cost × units), the cheapest and most
+ *    expensive unit cost, and the number of items at or below the threshold.
+ *  - All figures come from the column kernels, which scan only the cost and units
+ *    columns, never the descriptions.
+ */
+void printValuation(const InventoryStore& inventory) {
+    if (inventory.empty()) {
+        cout << "Inventory is empty. Nothing to value.\n";
+        return;
+    }
+
+    int threshold;
+    cout << "Enter low-stock threshold (units): ";
+    cin >> threshold;
+    while (cin.fail() || threshold < 0 || threshold > MAX_UNITS) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Error: Threshold must be an integer between 0 - " << MAX_UNITS << ".\n"
+             << "Please enter low-stock threshold: ";
+        cin >> threshold;
+    }
+
+    const size_t count = static_cast<size_t>(inventory.size());
+    const CostRange range = minMaxCost(inventory);
+
+    cout << fixed << setprecision(2)
+         << "Items:               " << count << '\n'
+         << "Total units:         " << totalUnits(inventory) << '\n'
+         << "Total stock value:   " << totalStockValue(inventory) << '\n'
+         << "Unit cost range:     " << range.minimum << " - " << range.maximum << '\n'
+         << "Low stock (<= " << threshold << "):  "
+         << countUnitsAtMost(inventory, threshold)<< " item(s)\n";
+}
+
+/*
+ * handlePagedCommand function definition:
+ *  - The command switch of paged mode (--paged). The item commands are the
+ *    same handlers as in handleCommand, working on the page file; 'c' prints the
+ *    buffer cache counters and 'm' the metrics, page cache included.
+ *  - Commands that need the in-memory store (bulk and parallel loads, pick
+ *    lists, search, snapshots, statistics, batch files, background writes,
+ *    journal) are refused with a short note.
+ */
+void handlePagedCommand(const char command, PagedStore& inventory, const string_view arguments) {
+    switch (command) {
+        case 'h':
+            showPagedMenu();
+            break;
+        case 'i':
+            inputFromFile(inventory, arguments);
+            break;
+        case 'n':
+            createNewItem(inventory);
+            break;
+        case 'a':
+            addParts(inventory);
+            break;
+        case 'r':
+            removeParts(inventory);
+            break;
+        case 'p':
+            printInventory(inventory, arguments);
+            break;
+        case 'o':
+            outputToFile(inventory, arguments);
+            break;
+        case 'c':
+            printCacheStats(inventory);
+            break;
+        case 'm':
+            printMetrics(arguments);
+            break;
+        case 'q':
+            cout << "Exiting program.\n";
+            break;
+        case 'b': case 'l': case 'k': case 'f': case 'd': case 's': case 'v': case 't': case 'x': case 'w': case 'j':
+            cout << "This command is not available in paged mode.\n";
+            break;
+        default:
+            cout << "Invalid command.\n";
+    }
+}
+
+// Help text of paged mode.
+void showPagedMenu() {
+    cout << "Supported commands (paged mode):\n"
+     << "  h -> Print Help text\n"
+     << "  i -> Input inventory data from a file (i [file [vendor]]; rejected lines go to <file>.rejects)\n"
+     << "  n -> New inventory Item\n"
+     << "  a -> Add parts\n"
+     << "  r -> Remove parts\n"
+     << "  p -> Print inventory list (p [first [count]] [> file])\n"
+     << "  o -> Output inventory data to a file (o [file])\n"
+     << "  c -> Cache statistics (pages cached, hits, misses, write-backs)\n"
+     << "  m -> Metrics (m [text|prometheus|json] [> file]; latencies, throughput, I/O)\n"
+     << "  q -> Quit (end the program)\n";
+}
+
+/*
+ * printCacheStats function definition:
+ *  - 'c' command in paged mode: how full the buffer cache is and how well it is
+ *    doing since the page file was opened.
+ */
+void printCacheStats(const PagedStore& inventory) {
+    const CacheStats stats = inventory.cacheStats();
+    const uint64_t fetches = stats.hits + stats.misses;
+    cout << fixed << setprecision(2)
+         << "Items:               " << inventory.size() << '\n'
+         << "Pages cached:        " << stats.pagesCached << " of " << stats.capacityPages << " ("
+         << static_cast<double>(stats.capacityPages * BufferCache::PAGE_SIZE) / (1024.0 * 1024.0) << " MB)\n"
+         << "Hits / misses:       " << stats.hits << " / " << stats.misses << " ("
+         << (fetches == 0 ? 0.0 : 100.0 * static_cast<double>(stats.hits) / static_cast<double>(fetches))
+         << "% hits)\n"
+         << "Evictions:           " << stats.evictions << '\n'
+         << "Pages written back:  " << stats.writeBacks << '\n';
+}
+
+// Name of the warehouse in the arguments, or asked for when there are none.
+static string warehouseArgument(const string_view arguments) {
+    if (const size_t first = arguments.find_first_not_of(" \t"); first != string_view::npos) {
+        return string(arguments.substr(first, arguments.find_first_of(" \t", first) - first));
+    }
+    string name;
+    cout << "Warehouse: ";
+    cin >> name;
+    return name;
+}
+
+// The arguments after the warehouse name ("plumbing out.txt" -> " out.txt").
+static string_view argumentsAfterWarehouse(const string_view arguments) {
+    const size_t first = arguments.find_first_not_of(" \t");
+    const size_t rest = first == string_view::npos ? arguments.size() : arguments.find_first_of(" \t", first);
+    return arguments.substr(min(rest, arguments.size()));
+}
+
+/*
+ * handleWarehouseCommand function definition:
+ *  - The command switch of warehouse mode (--warehouses). Items are named
+ *    warehouse:number; 'v' and 'f' ask every warehouse at once, the other item
+ *    commands run the usual handlers on one warehouse's store.
+ */
+void handleWarehouseCommand(const char command, ShardedInventory& inventory, const string_view arguments) {
+    switch (command) {
+        case 'h':
+            showWarehouseMenu();
+            break;
+        case 'w':
+            listWarehouses(inventory);
+            break;
+        case 'i':
+            inputIntoWarehouse(inventory, arguments);
+            break;
+        case 'n':
+            createWarehouseItem(inventory, arguments);
+            break;
+        case 'a':
+            changeWarehouseUnits(inventory, true);
+            break;
+        case 'r':
+            changeWarehouseUnits(inventory, false);
+            break;
+        case 'p':
+            printWarehouses(inventory, arguments);
+            break;
+        case 'v':
+            printWarehouseValuation(inventory);
+            break;
+        case 'f':
+            findLowStock(inventory, arguments);
+            break;
+        case 'o': {
+            const int shard = inventory.findShard(warehouseArgument(arguments));
+            if (shard < 0) {
+                cout << "Error: No such warehouse.\n";
+                break;
+            }
+            outputToFile(inventory.store(shard), argumentsAfterWarehouse(arguments));
+            break;
+        }
+        case 'm':
+            printMetrics(arguments);
+            break;
+        case 'q':
+            cout << "Exiting program.\n";
+            break;
+        case 'b': case 'l': case 'k': case 'd': case 's': case 't': case 'x': case 'j': case 'c':
+            cout << "This command is not available in warehouse mode.\n";
+            break;
+        default:
+            cout << "Invalid command.\n";
+    }
+}
+
+// Help text of warehouse mode.
+void showWarehouseMenu() {
+    cout << "Supported commands (warehouse mode; items are warehouse:number, e.g. plumbing:3):\n"
+     << "  h -> Print Help text\n"
+     << "  w -> List the warehouses\n"
+     << "  i -> Input a file into a warehouse (i [warehouse=]file; named after the file by default)\n"
+     << "  n -> New inventory Item in a warehouse (n [warehouse])\n"
+     << "  a -> Add parts\n"
+     << "  r -> Remove parts\n"
+     << "  p -> Print inventory list (p [warehouse] [first [count]] [by ...] [> file])\n"
+     << "  v -> Valuation of every warehouse and in total\n"
+     << "  f -> Find low stock in every warehouse (f [units], default 5)\n"
+     << "  o -> Output a warehouse's inventory to a file (o [warehouse] [file])\n"
+     << "  m -> Metrics (m [text|prometheus|json] [> file]; latencies, throughput, I/O)\n"
+     << "  q -> Quit (end the program)\n";
+}
+
+void listWarehouses(const ShardedInventory& inventory) {
+    for (int shard = 0; shard < inventory.shardCount(); ++shard) {
+        cout << "  " << setw(3) << shard << "  " << left << setw(20) << inventory.shardName(shard) << right
+             << setw(10) << inventory.store(shard).size() << " item(s)\n";
+    }
+    cout << inventory.shardCount() << " warehouse(s), " << inventory.totalItems() << " item(s) in total.\n";
+}
+
+/*
+ * inputIntoWarehouse function definition:
+ *  - 'i' in warehouse mode: "i plumbing.txt" appends to warehouse "plumbing"
+ *    (added if new), "i east=stock.txt" to warehouse "east". The file is then
+ *    imported by inputFromFile, rules and reject file included.
+ */
+void inputIntoWarehouse(ShardedInventory& inventory, const string_view arguments) {
+    string spec = warehouseArgument(arguments);
+    string warehouse;
+    if (const size_t equals = spec.find('='); equals != string::npos) {
+        warehouse = spec.substr(0, equals);
+        spec.erase(0, equals + 1);
+    } else {
+        warehouse = filesystem::path(spec).stem().string();
+    }
+
+    const int shard = inventory.addShard(warehouse);
+    if (shard < 0) {
+        cout << "Error: A warehouse name must not be empty or contain ':'.\n";
+        return;
+    }
+    cout << "Warehouse \"" << warehouse << "\": ";
+    inputFromFile(inventory.store(shard), spec + string(argumentsAfterWarehouse(arguments)));
+}
+
+// 'n' in warehouse mode: createNewItem on the named or chosen (possibly new)
+// warehouse; prints the ID of the item it added, if it added one.
+void createWarehouseItem(ShardedInventory& inventory, const string_view arguments) {
+    const string warehouse = warehouseArgument(arguments);
+    const int shard = inventory.addShard(warehouse);
+    if (shard < 0) {
+        cout << "Error: A warehouse name must not be empty or contain ':'.\n";
+        return;
+    }
+    const int itemNum = createNewItem(inventory.store(shard));
+    if (itemNum < 0) {
+        return;
+    }
+    cout << "Item ID: " << inventory.formatItemId({shard, itemNum}) << '\n';
+}
+
+/*
+ * changeWarehouseUnits function definition:
+ *  - 'a' and 'r' in warehouse mode: asks for an item as warehouse:number and a
+ *    quantity, and applies the change to that warehouse's store only. A bad
+ *    item or quantity is reported, not asked for again.
+ */
+void changeWarehouseUnits(ShardedInventory& inventory, const bool adding) {
+    string text;
+    cout << "Item (warehouse:number): ";
+    cin >> text;
+
+    ItemId id;
+    const char* reason = nullptr;
+    if (!inventory.parseItemId(text, id, reason)) {
+        cout << "Error: " << reason << ".\n";
+        return;
+    }
+
+    int quantity = 0;
+    cout << (adding ? "How many parts to add? " : "How many parts to remove? ");
+    cin >> quantity;
+    if (cin.fail()) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Error: Quantity must be a non-negative integer.\n";
+        return;
+    }
+
+    int unitsAfter = 0;
+    const StockResult result = adding ? inventory.addUnits(id, quantity, &unitsAfter)
+                                      : inventory.removeUnits(id, quantity, &unitsAfter);
+    if (result != StockResult::Ok) {
+        cout << "Error: " << describeStockResult(result) << ".\n";
+        return;
+    }
+    cout << quantity << " unit(s) " << (adding ? "added to " : "removed from ") << inventory.formatItemId(id)
+         << ". New quantity: " << unitsAfter << ".\n";
+}
+
+/*
+ * printWarehouses function definition:
+ *  - "p plumbing ..." prints one warehouse with printInventory and the rest of
+ *    the arguments; without a warehouse name every warehouse is printed in turn
+ *    under its own heading (to the console only).
+ */
+void printWarehouses(const ShardedInventory& inventory, const string_view arguments) {
+    const size_t first = arguments.find_first_not_of(" \t");
+    if (first != string_view::npos) {
+        const size_t end = min(arguments.find_first_of(" \t", first), arguments.size());
+        if (const int shard = inventory.findShard(arguments.substr(first, end - first)); shard >= 0) {
+            printInventory(inventory.store(shard), arguments.substr(end));
+            return;
+        }
+    }
+    if (arguments.find('>') != string_view::npos) {
+        cout << "Error: Name the warehouse to write a report to a file (p <warehouse> ... > file).\n";
+        return;
+    }
+    for (int shard = 0; shard < inventory.shardCount(); ++shard) {
+        cout << "Warehouse " << inventory.shardName(shard) << ":\n";
+        printInventory(inventory.store(shard), arguments);
+    }
+}
+
+/*
+ * printWarehouseValuation function definition:
+ *  - Asks for the low-stock threshold as 'v' does, then values every warehouse
+ *    in parallel (ShardedInventory::valuation) and prints a line per warehouse
+ *    and the total.
+ */
+void printWarehouseValuation(const ShardedInventory& inventory) {
+    if (inventory.totalItems() == 0) {
+        cout << "Inventory is empty. Nothing to value.\n";
+        return;
+    }
+
+    int threshold;
+    cout << "Enter low-stock threshold (units): ";
+    cin >> threshold;
+    while (cin.fail() || threshold < 0 || threshold > MAX_UNITS) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        cout << "Error: Threshold must be an integer between 0 - " << MAX_UNITS << ".\n"
+             << "Please enter low-stock threshold: ";
+        cin >> threshold;
+    }
+
+    const auto start = chrono::steady_clock::now();
+    ShardValuation total;
+    const vector<ShardValuation> shards = inventory.valuation(threshold, total);
+    const double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    const auto printRow = [](const string& name, const ShardValuation& value) {
+        cout << left << setw(20) << name << right << setw(10) << value.items << setw(12) << value.totalUnits
+             << setw(16) << value.stockValue << setw(10) << value.minCost << " - " << left << setw(10)
+             << value.maxCost << right << setw(10) << value.lowStock << '\n';
+    };
+    cout << fixed << setprecision(2) << left << setw(20) << "Warehouse" << right << setw(10) << "Items" << setw(12)
+         << "Units" << setw(16) << "Stock value" << setw(23) << "Unit cost range" << setw(10)
+         << ("<= " + to_string(threshold)) << '\n'
+         << string(91, '_') << '\n';
+    for (int shard = 0; shard < inventory.shardCount(); ++shard) {
+        printRow(inventory.shardName(shard), shards[static_cast<size_t>(shard)]);
+    }
+    printRow("Total", total);
+    cout << inventory.shardCount() << " warehouse(s) valued in " << setprecision(3) << milliseconds << " ms.\n";
+}
+
+/*
+ * findLowStock function definition:
+ *  - "f [units]": every item at or below the threshold (default
+ *    DEFAULT_REORDER_THRESHOLD) in every warehouse, collected in parallel; the
+ *    first FIND_ROWS_SHOWN are printed with their item IDs.
+ */
+void findLowStock(const ShardedInventory& inventory, const string_view arguments) {
+    int threshold = DEFAULT_REORDER_THRESHOLD;
+    if (const size_t first = arguments.find_first_not_of(" \t"); first != string_view::npos) {
+        const string_view text = arguments.substr(first, arguments.find_last_not_of(" \t") + 1 - first);
+        if (!parseUnitsField(text, threshold) || threshold < 0 || threshold > MAX_UNITS) {
+            cout << "Error: The threshold must be a number of units (0 - " << MAX_UNITS << ").\n";
+            return;
+        }
+    }
+
+    const auto start = chrono::steady_clock::now();
+    const vector<ItemId> items = inventory.lowStock(threshold);
+    const double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    if (items.empty()) {
+        cout << "No items at or below " << threshold << " unit(s).\n";
+        return;
+    }
+    cout << left << setw(24) << "Item ID" << setw(45) << "Description" << right << setw(8) << "Cost" << setw(10)
+         << "Quantity" << '\n'
+         << string(87, '_') << '\n' << fixed << setprecision(2);
+    for (size_t i = 0; i < items.size() && i < FIND_ROWS_SHOWN; ++i) {
+        const InventoryStore& store = inventory.store(items[i].shard);
+        cout << left << setw(24) << inventory.formatItemId(items[i]) << setw(45)
+             << store.getDescription(items[i].index) << right << setw(8) << store.getCost(items[i].index)
+             << setw(10) << store.getUnits(items[i].index) << '\n';
+    }
+    cout << items.size() << " item(s) at or below " << threshold << " unit(s)";
+    if (items.size() > FIND_ROWS_SHOWN) {
+        cout << " (first " << FIND_ROWS_SHOWN << " shown)";
+    }
+    cout << " found in " << setprecision(3) << milliseconds << " ms.\n";
 }
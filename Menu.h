@@ -2,8 +2,10 @@
 #ifndef MENU_H
 #define MENU_H
 
-#include <vector>
-#include "InventoryItem.h"
+#include <string_view>
+#include "InventoryStore.h"
+#include "PagedStore.h"
+#include "ShardedInventory.h"
 
 using namespace std;
 
@@ -23,8 +25,8 @@ void showMenu();
 
     Parameters:
     - command: Single-character command input by the user.
-    - inventory: Reference to the vector storing inventory items.
-    - itemCount: Reference to the number of items currently in inventory.
+    - inventory: Reference to the InventoryStore holding all inventory items.
+    - arguments: Anything typed on the same line after the command (e.g. "p 1000 50").
 
     Purpose:
     Acts as the command dispatcher inside the main loop, promoting modular design
@@ -35,7 +37,7 @@ void showMenu();
     and calls the function that does the job. It keeps track of the list and updates
     it when needed.
 */
-void handleCommand(char command, vector<InventoryItem>& inventory, int& itemCount);
+void handleCommand(char command, InventoryStore& inventory, string_view arguments = {});
 
 /*
     Inventory Command Functions
@@ -44,7 +46,8 @@ void handleCommand(char command, vector<InventoryItem>& inventory, int& itemCoun
     These functions define the core operations for interacting with the inventory system.
     They allow the user to modify item quantities, create new items, read from files,
     write to files, and view the current inventory. All functions operate on the inventory
-    vector by reference to ensure direct, in-place modifications.
+    store by reference to ensure direct, in-place modifications. The ones that also
+    make sense for a page file (paged mode) have a PagedStore overload.
 
     In Simpler Terms:
     These are the main things the program can do when a user types a command.
@@ -52,21 +55,104 @@ void handleCommand(char command, vector<InventoryItem>& inventory, int& itemCoun
 */
 
 // Adds units to an existing inventory item.
-void addParts(vector<InventoryItem>& inventory, int itemCount);
+void addParts(InventoryStore& inventory);
+void addParts(PagedStore& inventory);
 
 // Removes units from an existing inventory item.
-void removeParts(vector<InventoryItem>& inventory, int itemCount);
+void removeParts(InventoryStore& inventory);
+void removeParts(PagedStore& inventory);
 
-// Loads inventory data from a file (appends to current list).
-void inputFromFile(vector<InventoryItem>& inventory, int& itemCount);
+// Loads inventory data from a file (appends to current list); arguments may
+// name the file. Rejected lines are reported and written to <file>.rejects.
+void inputFromFile(InventoryStore& inventory, string_view arguments = {});
+void inputFromFile(PagedStore& inventory, string_view arguments = {});
 
-// Saves inventory data to a file in pipe-delimited format.
-void outputToFile(const vector<InventoryItem>& inventory, int itemCount);
+// Saves inventory data to a file in pipe-delimited format; the file name is
+// taken from the arguments, or asked for when there are none.
+void outputToFile(const InventoryStore& inventory, string_view arguments = {});
+void outputToFile(const PagedStore& inventory, string_view arguments = {});
 
-// Displays all inventory items in a formatted table view.
-void printInventory(const vector<InventoryItem>& inventory, int itemCount);
+// Saves inventory data to a file on a background thread (returns immediately).
+void outputToFileInBackground(const InventoryStore& inventory);
 
-// Creates and appends a new inventory item from user input.
-void createNewItem(vector<InventoryItem>& inventory, int& itemCount);
+// Displays the inventory items in a formatted table view; arguments select rows,
+// order, filter and an optional output file (see Report.h).
+void printInventory(const InventoryStore& inventory, string_view arguments = {});
+void printInventory(const PagedStore& inventory, string_view arguments = {});
+
+// Finds items by description text or by a units/cost range, using the search index;
+// the query is taken from the arguments, or asked for when there are none.
+void findItems(InventoryStore& inventory, string_view arguments = {});
+
+// Loads a large inventory file via the memory-mapped bulk loader and reports throughput.
+void bulkInputFromFile(InventoryStore& inventory);
+
+// Prints total stock value, cost range and low-stock count.
+void printValuation(const InventoryStore& inventory);
+
+// Creates and appends a new inventory item from user input. Returns its item
+// number, or -1 if the store refused it (the reason is printed).
+int createNewItem(InventoryStore& inventory);
+int createNewItem(PagedStore& inventory);
+
+/*
+    Paged Mode
+    -----------------------------
+    Description:
+    With --paged the items live in a page file (see PagedStore.h) instead of in
+    memory. handlePagedCommand is the command dispatcher of that mode: the item
+    commands (i, n, a, r, p, o) run the same handlers as above on the page file,
+    'c' reports the buffer cache, and commands that need the in-memory store are
+    refused.
+
+    In Simpler Terms:
+    The same commands for an inventory too big to keep in memory.
+*/
+void handlePagedCommand(char command, PagedStore& inventory, string_view arguments = {});
+
+// Displays the commands supported in paged mode.
+void showPagedMenu();
+
+// Prints the buffer cache counters (pages cached, hits, misses, evictions, write-backs).
+void printCacheStats(const PagedStore& inventory);
+
+/*
+    Warehouse Mode
+    -----------------------------
+    Description:
+    With --warehouses the inventory is split into one store per warehouse (see
+    ShardedInventory.h) and items are named warehouse:number, so the category
+    files keep their own item numbers. handleWarehouseCommand is the command
+    dispatcher of that mode: 'w' lists the warehouses, 'v' and 'f' (low stock)
+    ask every warehouse at once, and i, n, a, r, p and o work on one warehouse.
+
+    In Simpler Terms:
+    The same commands for several warehouses kept apart.
+*/
+void handleWarehouseCommand(char command, ShardedInventory& inventory, string_view arguments = {});
+
+// Displays the commands supported in warehouse mode.
+void showWarehouseMenu();
+
+// Lists the warehouses with their item counts.
+void listWarehouses(const ShardedInventory& inventory);
+
+// Loads a file into a warehouse: i [warehouse=]file.
+void inputIntoWarehouse(ShardedInventory& inventory, string_view arguments = {});
+
+// Creates a new item in a chosen warehouse (n [warehouse]) and prints its item ID.
+void createWarehouseItem(ShardedInventory& inventory, string_view arguments = {});
+
+// Adds (adding = true) or removes parts of an item named warehouse:number.
+void changeWarehouseUnits(ShardedInventory& inventory, bool adding);
+
+// Prints one warehouse (p <warehouse> ...) or all of them.
+void printWarehouses(const ShardedInventory& inventory, string_view arguments = {});
+
+// Prints the valuation of every warehouse and the total, computed in parallel.
+void printWarehouseValuation(const ShardedInventory& inventory);
+
+// Lists the items at or below a number of units in every warehouse: f [units].
+void findLowStock(const ShardedInventory& inventory, string_view arguments = {});
 
 #endif // MENU_H
@@ -0,0 +1,492 @@
+// Implementation File -> Metrics.cpp
+#include "Metrics.h"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <iostream>
+#include <vector>
+#include "PagedStore.h"
+#include "RecordWriter.h"
+
+#ifdef INVENTORY_METRICS
+#include "AllocationCounter.h"
+#endif
+
+using namespace std;
+
+#ifdef INVENTORY_METRICS
+
+array<atomic<uint64_t>, static_cast<size_t>(MetricCounter::Count)> metrics_detail::counters{};
+
+// One histogram per command letter a-z, plus one for anything else.
+static constexpr size_t OTHER_COMMAND = 26;
+static array<LatencyHistogram, OTHER_COMMAND + 1> commandLatency;
+
+static atomic<const PagedStore*> watchedStore{nullptr};
+
+static size_t histogramOf(const char command) {
+    return command >= 'a' && command <= 'z' ? static_cast<size_t>(command - 'a') : OTHER_COMMAND;
+}
+
+static char commandOf(const size_t histogram) {
+    return histogram == OTHER_COMMAND ? '?' : static_cast<char>('a' + histogram);
+}
+
+void metrics_detail::recordLatency(const char command, const uint64_t nanoseconds) {
+    LatencyHistogram& histogram = commandLatency[histogramOf(command)];
+    const size_t bucket = min<size_t>(bit_width(nanoseconds / 1000), LATENCY_BUCKETS - 1);
+    histogram.buckets[bucket].fetch_add(1, memory_order_relaxed);
+    histogram.count.fetch_add(1, memory_order_relaxed);
+    histogram.totalNanoseconds.fetch_add(nanoseconds, memory_order_relaxed);
+    uint64_t seen = histogram.maxNanoseconds.load(memory_order_relaxed);
+    while (seen < nanoseconds && !histogram.maxNanoseconds.compare_exchange_weak(seen, nanoseconds, memory_order_relaxed)) {
+    }
+}
+
+#endif
+
+void watchPageCache(const PagedStore* store) {
+#ifdef INVENTORY_METRICS
+    watchedStore.store(store, memory_order_release);
+#else
+    (void)store;
+#endif
+}
+
+#ifdef INVENTORY_METRICS
+
+// The figures of one histogram, read once so every format agrees with itself.
+struct LatencyFigures {
+    char command = '?';
+    array<uint64_t, LATENCY_BUCKETS> buckets{};
+    uint64_t count = 0;                // Sum of buckets
+    double totalSeconds = 0.0;
+    double maxSeconds = 0.0;
+};
+
+// Everything appendMetrics reports.
+struct MetricsFigures {
+    vector<LatencyFigures> commands;   // Commands run at least once, in letter order
+    array<uint64_t, static_cast<size_t>(MetricCounter::Count)> counters{};
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    bool paged = false;
+    CacheStats cache;
+};
+
+static MetricsFigures readMetrics() {
+    MetricsFigures figures;
+    for (size_t i = 0; i < commandLatency.size(); ++i) {
+        const LatencyHistogram& histogram = commandLatency[i];
+        LatencyFigures command;
+        command.command = commandOf(i);
+        for (size_t b = 0; b < LATENCY_BUCKETS; ++b) {
+            command.buckets[b] = histogram.buckets[b].load(memory_order_relaxed);
+            command.count += command.buckets[b];
+        }
+        if (command.count == 0) continue;
+        command.totalSeconds = static_cast<double>(histogram.totalNanoseconds.load(memory_order_relaxed)) / 1e9;
+        command.maxSeconds = static_cast<double>(histogram.maxNanoseconds.load(memory_order_relaxed)) / 1e9;
+        figures.commands.push_back(command);
+    }
+    for (size_t i = 0; i < figures.counters.size(); ++i) {
+        figures.counters[i] = metrics_detail::counters[i].load(memory_order_relaxed);
+    }
+    figures.allocations = allocationCount();
+    figures.allocatedBytes = allocatedBytes();
+    if (const PagedStore* store = watchedStore.load(memory_order_acquire)) {
+        figures.paged = true;
+        figures.cache = store->cacheStats();
+    }
+    return figures;
+}
+
+// Upper bound of histogram bucket b, in seconds (the last bucket has none).
+static double bucketBound(const size_t bucket) {
+    return static_cast<double>(uint64_t{1} << bucket) / 1e6;
+}
+
+// The bound of the bucket holding the given fraction of the commands, capped at the slowest.
+static double percentile(const LatencyFigures& command, const double fraction) {
+    const uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(command.count) + 0.5));
+    uint64_t seen = 0;
+    for (size_t b = 0; b + 1 < LATENCY_BUCKETS; ++b) {
+        seen += command.buckets[b];
+        if (seen >= rank) return min(bucketBound(b), command.maxSeconds);
+    }
+    return command.maxSeconds;
+}
+
+static uint64_t counterOf(const MetricsFigures& figures, const MetricCounter counter) {
+    return figures.counters[static_cast<size_t>(counter)];
+}
+
+static void appendNumber(string& out, const uint64_t value) {
+    char digits[24];
+    const auto result = to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// Shortest form that reads back exactly (e.g. 1e-06, 0.25).
+static void appendNumber(string& out, const double value) {
+    char digits[32];
+    const auto result = to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+static void appendFixed(string& out, const double value, const int decimals, const size_t width = 0) {
+    char digits[48];
+    const auto result = to_chars(digits, digits + sizeof(digits), value, chars_format::fixed, decimals);
+    const size_t length = static_cast<size_t>(result.ptr - digits);
+    if (length < width) out.append(width - length, ' ');
+    out.append(digits, length);
+}
+
+static void appendPadded(string& out, const uint64_t value, const size_t width) {
+    char digits[24];
+    const auto result = to_chars(digits, digits + sizeof(digits), value);
+    const size_t length = static_cast<size_t>(result.ptr - digits);
+    if (length < width) out.append(width - length, ' ');
+    out.append(digits, length);
+}
+
+// "<count> in <ms> ms (<rate> <unit>/s)"
+static void appendThroughput(string& out, const uint64_t count, const uint64_t nanoseconds, const string_view unit) {
+    appendNumber(out, count);
+    if (nanoseconds == 0) {
+        out += '\n';
+        return;
+    }
+    const double seconds = static_cast<double>(nanoseconds) / 1e9;
+    out += " in ";
+    appendFixed(out, seconds * 1000.0, 2);
+    out += " ms (";
+    appendFixed(out, static_cast<double>(count) / seconds, 0);
+    out += ' ';
+    out += unit;
+    out += "/s)\n";
+}
+
+static void appendText(string& out, const MetricsFigures& figures) {
+    out += "Command latency (ms):\n";
+    if (figures.commands.empty()) {
+        out += "  No commands timed yet.\n";
+    } else {
+        out += "  Command     Count       Mean        p50        p99        Max\n";
+        for (const LatencyFigures& command : figures.commands) {
+            out += "  ";
+            out += command.command;
+            out.append(6, ' ');
+            appendPadded(out, command.count, 10);
+            appendFixed(out, command.totalSeconds * 1000.0 / static_cast<double>(command.count), 3, 11);
+            appendFixed(out, percentile(command, 0.50) * 1000.0, 3, 11);
+            appendFixed(out, percentile(command, 0.99) * 1000.0, 3, 11);
+            appendFixed(out, command.maxSeconds * 1000.0, 3, 11);
+            out += '\n';
+        }
+        out += "  (p50 and p99 are bucket bounds: powers of two microseconds)\n";
+    }
+
+    out += "Records parsed:   ";
+    appendThroughput(out, counterOf(figures, MetricCounter::RecordsParsed),
+                     counterOf(figures, MetricCounter::ParseNanoseconds), "records");
+    out += "Rows formatted:   ";
+    appendThroughput(out, counterOf(figures, MetricCounter::RowsFormatted),
+                     counterOf(figures, MetricCounter::FormatNanoseconds), "rows");
+    out += "Bytes read:       ";
+    appendNumber(out, counterOf(figures, MetricCounter::BytesRead));
+    out += "\nBytes written:    ";
+    appendNumber(out, counterOf(figures, MetricCounter::BytesWritten));
+    out += "\nAllocations:      ";
+    appendNumber(out, figures.allocations);
+    out += " (";
+    appendNumber(out, figures.allocatedBytes);
+    out += " bytes)\n";
+
+    if (figures.paged) {
+        const CacheStats& cache = figures.cache;
+        const uint64_t fetches = cache.hits + cache.misses;
+        out += "Page cache:       ";
+        appendNumber(out, cache.hits);
+        out += " hit(s), ";
+        appendNumber(out, cache.misses);
+        out += " miss(es)";
+        if (fetches > 0) {
+            out += " (";
+            appendFixed(out, 100.0 * static_cast<double>(cache.hits) / static_cast<double>(fetches), 1);
+            out += "% hits)";
+        }
+        out += ", ";
+        appendNumber(out, cache.evictions);
+        out += " eviction(s), ";
+        appendNumber(out, cache.writeBacks);
+        out += " write-back(s)\n";
+    }
+}
+
+// One Prometheus counter or gauge: HELP and TYPE lines, then the sample.
+static void appendPrometheusSample(string& out, const string_view name, const string_view type,
+                                   const string_view help, const uint64_t value) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+    out += name;
+    out += ' ';
+    appendNumber(out, value);
+    out += '\n';
+}
+
+static void appendPrometheusSeconds(string& out, const string_view name, const string_view help,
+                                    const uint64_t nanoseconds) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += " counter\n";
+    out += name;
+    out += ' ';
+    appendNumber(out, static_cast<double>(nanoseconds) / 1e9);
+    out += '\n';
+}
+
+static void appendPrometheus(string& out, const MetricsFigures& figures) {
+    if (!figures.commands.empty()) {
+        out += "# HELP inventory_command_duration_seconds Time taken by console commands.\n"
+               "# TYPE inventory_command_duration_seconds histogram\n";
+        for (const LatencyFigures& command : figures.commands) {
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < LATENCY_BUCKETS; ++b) {
+                cumulative += command.buckets[b];
+                out += "inventory_command_duration_seconds_bucket{command=\"";
+                out += command.command;
+                out += "\",le=\"";
+                if (b + 1 < LATENCY_BUCKETS) {
+                    appendNumber(out, bucketBound(b));
+                } else {
+                    out += "+Inf";
+                }
+                out += "\"} ";
+                appendNumber(out, cumulative);
+                out += '\n';
+            }
+            out += "inventory_command_duration_seconds_sum{command=\"";
+            out += command.command;
+            out += "\"} ";
+            appendNumber(out, command.totalSeconds);
+            out += "\ninventory_command_duration_seconds_count{command=\"";
+            out += command.command;
+            out += "\"} ";
+            appendNumber(out, command.count);
+            out += '\n';
+        }
+    }
+
+    appendPrometheusSample(out, "inventory_records_parsed_total", "counter", "Records loaded from inventory files.",
+                           counterOf(figures, MetricCounter::RecordsParsed));
+    appendPrometheusSeconds(out, "inventory_parse_seconds_total", "Time spent loading inventory files.",
+                            counterOf(figures, MetricCounter::ParseNanoseconds));
+    appendPrometheusSample(out, "inventory_rows_formatted_total", "counter", "Report rows and file records formatted.",
+                           counterOf(figures, MetricCounter::RowsFormatted));
+    appendPrometheusSeconds(out, "inventory_format_seconds_total", "Time spent formatting reports and files.",
+                            counterOf(figures, MetricCounter::FormatNanoseconds));
+    appendPrometheusSample(out, "inventory_read_bytes_total", "counter", "Bytes read from files.",
+                           counterOf(figures, MetricCounter::BytesRead));
+    appendPrometheusSample(out, "inventory_written_bytes_total", "counter", "Bytes written to files.",
+                           counterOf(figures, MetricCounter::BytesWritten));
+    appendPrometheusSample(out, "inventory_allocations_total", "counter", "Heap allocations made through operator new.",
+                           figures.allocations);
+    appendPrometheusSample(out, "inventory_allocated_bytes_total", "counter", "Bytes requested through operator new.",
+                           figures.allocatedBytes);
+    if (figures.paged) {
+        appendPrometheusSample(out, "inventory_page_cache_hits_total", "counter", "Pages found in the page cache.",
+                               figures.cache.hits);
+        appendPrometheusSample(out, "inventory_page_cache_misses_total", "counter", "Pages read from the page file.",
+                               figures.cache.misses);
+        appendPrometheusSample(out, "inventory_page_cache_evictions_total", "counter", "Pages dropped from the page cache.",
+                               figures.cache.evictions);
+        appendPrometheusSample(out, "inventory_page_write_backs_total", "counter", "Dirty pages written to the page file.",
+                               figures.cache.writeBacks);
+        appendPrometheusSample(out, "inventory_page_cache_pages", "gauge", "Pages held in the page cache.",
+                               figures.cache.pagesCached);
+    }
+}
+
+static void appendJsonField(string& out, const string_view name, const uint64_t value, const bool last = false) {
+    out += "    \"";
+    out += name;
+    out += "\": ";
+    appendNumber(out, value);
+    out += last ? "\n" : ",\n";
+}
+
+static void appendJson(string& out, const MetricsFigures& figures) {
+    out += "{\n  \"commands\": {";
+    bool firstCommand = true;
+    for (const LatencyFigures& command : figures.commands) {
+        out += firstCommand ? "\n" : ",\n";
+        firstCommand = false;
+        out += "    \"";
+        out += command.command;
+        out += "\": {\"count\": ";
+        appendNumber(out, command.count);
+        out += ", \"sum_seconds\": ";
+        appendNumber(out, command.totalSeconds);
+        out += ", \"max_seconds\": ";
+        appendNumber(out, command.maxSeconds);
+        out += ", \"p50_seconds\": ";
+        appendNumber(out, percentile(command, 0.50));
+        out += ", \"p99_seconds\": ";
+        appendNumber(out, percentile(command, 0.99));
+        out += ", \"buckets\": [";
+        bool firstBucket = true;
+        for (size_t b = 0; b < LATENCY_BUCKETS; ++b) {
+            if (command.buckets[b] == 0) continue;
+            out += firstBucket ? "" : ", ";
+            firstBucket = false;
+            out += "{\"le_seconds\": ";
+            if (b + 1 < LATENCY_BUCKETS) {
+                appendNumber(out, bucketBound(b));
+            } else {
+                out += "null";
+            }
+            out += ", \"count\": ";
+            appendNumber(out, command.buckets[b]);
+            out += '}';
+        }
+        out += "]}";
+    }
+    out += firstCommand ? "},\n" : "\n  },\n";
+
+    out += "  \"counters\": {\n";
+    appendJsonField(out, "records_parsed", counterOf(figures, MetricCounter::RecordsParsed));
+    appendJsonField(out, "parse_nanoseconds", counterOf(figures, MetricCounter::ParseNanoseconds));
+    appendJsonField(out, "rows_formatted", counterOf(figures, MetricCounter::RowsFormatted));
+    appendJsonField(out, "format_nanoseconds", counterOf(figures, MetricCounter::FormatNanoseconds));
+    appendJsonField(out, "bytes_read", counterOf(figures, MetricCounter::BytesRead));
+    appendJsonField(out, "bytes_written", counterOf(figures, MetricCounter::BytesWritten));
+    appendJsonField(out, "allocations", figures.allocations);
+    appendJsonField(out, "allocated_bytes", figures.allocatedBytes, !figures.paged);
+    if (figures.paged) {
+        appendJsonField(out, "page_cache_hits", figures.cache.hits);
+        appendJsonField(out, "page_cache_misses", figures.cache.misses);
+        appendJsonField(out, "page_cache_evictions", figures.cache.evictions);
+        appendJsonField(out, "page_write_backs", figures.cache.writeBacks);
+        appendJsonField(out, "page_cache_pages", figures.cache.pagesCached, true);
+    }
+    out += "  }\n}\n";
+}
+
+#endif
+
+/*
+ * appendMetrics function definition:
+ *  - Reads every figure once, then formats them; appends nothing when metrics
+ *    are not compiled in.
+ */
+void appendMetrics(string& out, const MetricsFormat format) {
+#ifdef INVENTORY_METRICS
+    const MetricsFigures figures = readMetrics();
+    switch (format) {
+        case MetricsFormat::Text:
+            appendText(out, figures);
+            break;
+        case MetricsFormat::Prometheus:
+            appendPrometheus(out, figures);
+            break;
+        case MetricsFormat::Json:
+            appendJson(out, figures);
+            break;
+    }
+#else
+    (void)out;
+    (void)format;
+#endif
+}
+
+static string_view trimFront(string_view text) {
+    while (!text.empty() && isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+    return text;
+}
+
+// Removes and returns the next whitespace-separated word of text.
+static string_view takeWord(string_view& text) {
+    text = trimFront(text);
+    size_t length = 0;
+    while (length < text.size() && !isspace(static_cast<unsigned char>(text[length]))) ++length;
+    const string_view word = text.substr(0, length);
+    text.remove_prefix(length);
+    return word;
+}
+
+/*
+ * printMetrics function definition:
+ *  - Arguments: an optional format (text, prometheus or json; text by default),
+ *    then optionally "> file".
+ *  - The file is written through an AtomicFileWriter, so a scraper reading it
+ *    never sees half an export.
+ */
+void printMetrics(const string_view arguments) {
+    if constexpr (!METRICS_ENABLED) {
+        cout << "Metrics are not compiled in (configure with -DINVENTORY_METRICS=ON).\n";
+        return;
+    }
+
+    string_view rest = trimFront(arguments);
+    MetricsFormat format = MetricsFormat::Text;
+    if (!rest.empty() && rest.front() != '>') {
+        const string_view word = takeWord(rest);
+        if (word == "text") {
+            format = MetricsFormat::Text;
+        } else if (word == "prometheus") {
+            format = MetricsFormat::Prometheus;
+        } else if (word == "json") {
+            format = MetricsFormat::Json;
+        } else {
+            cout << "Error: Unknown format \"" << word << "\" (expected text, prometheus or json).\n";
+            return;
+        }
+    }
+
+    string outputFile;
+    rest = trimFront(rest);
+    if (!rest.empty() && rest.front() == '>') {
+        rest.remove_prefix(1);
+        outputFile = string(takeWord(rest));
+        if (outputFile.empty()) {
+            cout << "Error: Expected a file name after \">\".\n";
+            return;
+        }
+    }
+    if (!trimFront(rest).empty()) {
+        cout << "Error: Unexpected \"" << trimFront(rest) << "\" (usage: m [text|prometheus|json] [> file]).\n";
+        return;
+    }
+
+    string text;
+    appendMetrics(text, format);
+    if (outputFile.empty()) {
+        cout << text;
+        return;
+    }
+
+    AtomicFileWriter writer;
+    if (!writer.open(outputFile)) {
+        cout << "Error: Could not create file \"" << outputFile << "\".\n";
+        return;
+    }
+    writer.append(text);
+    if (!writer.commit()) {
+        cout << "Error: Could not write file \"" << outputFile << "\".\n";
+        return;
+    }
+    cout << "Metrics written to \"" << outputFile << "\".\n";
+}
@@ -0,0 +1,143 @@
+// Specification File -> Metrics.h
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+class PagedStore;
+
+/*
+    Metrics
+    -----------------------------
+    Description:
+    Built-in instrumentation, compiled in only when the project is configured
+    with -DINVENTORY_METRICS=ON. It records:
+      - a latency histogram per command letter (console commands, timed from
+        the moment the command is read until its handler returns);
+      - records parsed and the time spent parsing them ('i', 'b', 'l', --load);
+      - report rows and file records formatted, and the time spent ('p', 'o');
+      - bytes read from and written to files (loads, snapshots, exports, the
+        journal, the page file);
+      - heap allocations (the counting operator new of AllocationCounter.cpp);
+      - page cache hits, misses, evictions and write-backs (--paged).
+    The 'm' command prints them or exports them in Prometheus text or JSON form.
+
+    Nothing is counted per item or per row: loads, reports and writes add their
+    totals once when they finish, and page cache figures are read from the
+    cache itself when asked for. The only per-event costs are two clock reads
+    per console command and a relaxed atomic add per allocation and per file
+    write, well under 1% of any command.
+
+    Without INVENTORY_METRICS, METRICS_ENABLED is false and every recording
+    call below is an empty inline function: no code, no counters, no clock.
+
+    In Simpler Terms:
+    A dashboard of how fast each command ran and how much work it did, which
+    weighs nothing unless it is switched on at build time.
+*/
+
+#ifdef INVENTORY_METRICS
+constexpr bool METRICS_ENABLED = true;
+#else
+constexpr bool METRICS_ENABLED = false;
+#endif
+
+// Totals kept by the instrumentation.
+enum class MetricCounter {
+    RecordsParsed,
+    ParseNanoseconds,
+    RowsFormatted,
+    FormatNanoseconds,
+    BytesRead,
+    BytesWritten,
+    Count
+};
+
+// Latency histogram bucket b counts commands that took under 2^b microseconds;
+// the last bucket takes everything slower.
+constexpr size_t LATENCY_BUCKETS = 28;
+
+struct LatencyHistogram {
+    array<atomic<uint64_t>, LATENCY_BUCKETS> buckets{};
+    atomic<uint64_t> count{0};
+    atomic<uint64_t> totalNanoseconds{0};
+    atomic<uint64_t> maxNanoseconds{0};
+};
+
+namespace metrics_detail {
+    extern array<atomic<uint64_t>, static_cast<size_t>(MetricCounter::Count)> counters;
+    void recordLatency(char command, uint64_t nanoseconds);
+
+    inline uint64_t nanosecondsSince(const chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start).count());
+    }
+}
+
+// Adds amount to a counter.
+inline void countMetric(const MetricCounter counter, const uint64_t amount) {
+    if constexpr (METRICS_ENABLED) {
+        metrics_detail::counters[static_cast<size_t>(counter)].fetch_add(amount, memory_order_relaxed);
+    }
+}
+
+// Adds the time since start to a nanoseconds counter (ParseNanoseconds, FormatNanoseconds).
+inline void countMetricTime(const MetricCounter counter, const chrono::steady_clock::time_point start) {
+    if constexpr (METRICS_ENABLED) {
+        countMetric(counter, metrics_detail::nanosecondsSince(start));
+    }
+}
+
+// The clock reading to pass to countMetricTime later (none when metrics are off).
+inline chrono::steady_clock::time_point metricClock() {
+    if constexpr (METRICS_ENABLED) {
+        return chrono::steady_clock::now();
+    } else {
+        return {};
+    }
+}
+
+/*
+    CommandTimer
+    -----------------------------
+    Records how long it lives in the histogram of one command letter; main()
+    puts one around every handleCommand call.
+*/
+class CommandTimer {
+public:
+    explicit CommandTimer(const char command) : command(command), start(metricClock()) {}
+    ~CommandTimer() {
+        if constexpr (METRICS_ENABLED) {
+            metrics_detail::recordLatency(command, metrics_detail::nanosecondsSince(start));
+        }
+    }
+
+    CommandTimer(const CommandTimer&) = delete;
+    CommandTimer& operator=(const CommandTimer&) = delete;
+
+private:
+    const char command;
+    const chrono::steady_clock::time_point start;
+};
+
+// The page store whose cache figures are reported (nullptr = none).
+void watchPageCache(const PagedStore* store);
+
+enum class MetricsFormat { Text, Prometheus, Json };
+
+// Appends every metric in the given format to out.
+void appendMetrics(string& out, MetricsFormat format);
+
+// 'm' command handler: [text|prometheus|json] [> file]. Prints the metrics, or
+// writes them to the file; says so when metrics are not compiled in.
+void printMetrics(string_view arguments);
+
+#endif // METRICS_H
@@ -0,0 +1,90 @@
+// Implementation File -> Money.cpp
+#include "Money.h"
+#include <charconv>
+
+using namespace std;
+
+// Whole-number digits read exactly; longer amounts are read as a double.
+static constexpr int MAX_EXACT_DIGITS = 16;
+
+/*
+ * parseMoney function definition:
+ *  - Fast path: accumulates the whole part and up to two decimals as integers
+ *    in one pass, no locale, allocation or floating point involved.
+ *  - Anything the fast path does not take (exponents, very long numbers) falls
+ *    back to std::from_chars; the result must be finite and fit in cents.
+ */
+bool parseMoney(const string_view text, Money& value) {
+    const char* p = text.data();
+    const char* const end = p + text.size();
+    const bool negative = p != end && *p == '-';
+    if (negative) ++p;
+
+    uint64_t whole = 0;
+    int wholeDigits = 0;
+    while (p != end && *p >= '0' && *p <= '9' && wholeDigits < MAX_EXACT_DIGITS) {
+        whole = whole * 10 + static_cast<uint64_t>(*p++ - '0');
+        ++wholeDigits;
+    }
+
+    uint64_t fraction = 0;
+    int fractionDigits = 0;
+    bool roundUp = false;
+    if (p != end && *p == '.') {
+        for (++p; p != end && *p >= '0' && *p <= '9'; ++p, ++fractionDigits) {
+            if (fractionDigits < Money::DECIMALS) {
+                fraction = fraction * 10 + static_cast<uint64_t>(*p - '0');
+            } else if (fractionDigits == Money::DECIMALS) {
+                roundUp = *p >= '5';
+            }
+        }
+    }
+
+    if (p == end && wholeDigits + fractionDigits > 0) {
+        for (int digits = fractionDigits; digits < Money::DECIMALS; ++digits) {
+            fraction *= 10;
+        }
+        const auto cents = static_cast<int64_t>(whole * Money::SCALE + fraction + (roundUp ? 1 : 0));
+        value.cents = negative ? -cents : cents;
+        return true;
+    }
+
+    double number = 0.0;
+    const auto [last, error] = from_chars(text.data(), end, number);
+    if (error != errc() || last != end || !isfinite(number) ||
+        !(fabs(number) * static_cast<double>(Money::SCALE) < 9.2e18)) {
+        return false;
+    }
+    value = Money::fromDouble(number);
+    return true;
+}
+
+/*
+ * formatMoney function definition:
+ *  - Splits the magnitude into whole units and cents with one division; the whole
+ *    part goes through std::to_chars, the cents are two table-free digits.
+ */
+char* formatMoney(char* out, const Money value) {
+    uint64_t magnitude = static_cast<uint64_t>(value.cents);
+    if (value.cents < 0) {
+        *out++ = '-';
+        magnitude = 0 - magnitude;
+    }
+    const uint64_t whole = magnitude / Money::SCALE;
+    const auto fraction = static_cast<unsigned>(magnitude % Money::SCALE);
+    out = to_chars(out, out + MONEY_CHARS, whole).ptr;
+    *out++ = '.';
+    *out++ = static_cast<char>('0' + fraction / 10);
+    *out++ = static_cast<char>('0' + fraction % 10);
+    return out;
+}
+
+string toString(const Money value) {
+    char text[MONEY_CHARS];
+    return string(text, formatMoney(text, value));
+}
+
+ostream& operator<<(ostream& out, const Money value) {
+    char text[MONEY_CHARS];
+    return out << string_view(text, static_cast<size_t>(formatMoney(text, value) - text));
+}
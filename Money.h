@@ -0,0 +1,79 @@
+// Specification File -> Money.h
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cmath>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+/*
+    Money
+    -----------------------------
+    Description:
+    An amount of money as a whole number of cents (fixed point with DECIMALS
+    decimal places). This is how the store keeps item costs: "12.34" is read
+    straight into 1234 without going through a double, is written back as the
+    same text, and sums and products of costs and units are integer arithmetic,
+    so a stock valuation is exact to the cent whatever the order of the items.
+
+    Amounts go up to about 92 quadrillion (dollars) either way, which also
+    bounds the totals. InventoryItem keeps its double cost; fromDouble and
+    toDouble convert at that boundary, rounding to the nearest cent.
+
+    In Simpler Terms:
+    Prices counted in cents, so adding them up never loses a penny.
+*/
+struct Money {
+    static constexpr int DECIMALS = 2;
+    static constexpr int64_t SCALE = 100;
+
+    int64_t cents = 0;
+
+    static constexpr Money fromCents(const int64_t cents) { return Money{cents}; }
+    static Money fromDouble(const double value) { return Money{llround(value * static_cast<double>(SCALE))}; }
+    double toDouble() const { return static_cast<double>(cents) / static_cast<double>(SCALE); }
+
+    // The smallest and largest amounts, used as "no limit" by range checks.
+    static constexpr Money lowest() { return Money{numeric_limits<int64_t>::min()}; }
+    static constexpr Money highest() { return Money{numeric_limits<int64_t>::max()}; }
+
+    friend constexpr auto operator<=>(Money, Money) = default;
+    constexpr Money& operator+=(const Money other) { cents += other.cents; return *this; }
+    constexpr Money& operator-=(const Money other) { cents -= other.cents; return *this; }
+    friend constexpr Money operator+(Money a, const Money b) { return a += b; }
+    friend constexpr Money operator-(Money a, const Money b) { return a -= b; }
+    friend constexpr Money operator*(const Money a, const int64_t count) { return Money{a.cents * count}; }
+};
+
+static_assert(sizeof(Money) == sizeof(int64_t), "Cost columns are scanned as plain int64 arrays");
+
+// Longest text formatMoney writes ("-92233720368547758.08").
+constexpr size_t MONEY_CHARS = 24;
+
+/*
+    parseMoney: reads an amount written [-]digits[.digits], e.g. "12.34", "7",
+    "-0.5" or ".99", digit by digit; a third decimal rounds half away from zero
+    and any further ones are ignored. Other spellings a number can have ("1e3")
+    are read as a double and rounded to the cent. Returns false (value
+    unchanged) if text is not a finite number in range or has anything around
+    it, blanks included.
+*/
+bool parseMoney(string_view text, Money& value);
+
+// Writes value with exactly two decimals ("12.34", "-0.05", "7.00") to out,
+// which must have room for MONEY_CHARS characters; returns the end of the text.
+char* formatMoney(char* out, Money value);
+
+string toString(Money value);
+
+// Streams the formatted amount; setw and left/right apply as for a string.
+ostream& operator<<(ostream& out, Money value);
+
+#endif // MONEY_H
@@ -0,0 +1,452 @@
+// Implementation File -> PagedStore.cpp
+#include "PagedStore.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PAGEDSTORE_POSIX 1
+#endif
+
+using namespace std;
+
+namespace {
+// Layout of page 0.
+constexpr char PAGE_FILE_MAGIC[8] = {'I', 'N', 'V', 'P', 'A', 'G', 'E', 'S'};
+constexpr uint32_t PAGE_FILE_VERSION = 2;  // 2: costs in whole cents (Money)
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pageSize;
+    uint32_t recordSize;
+    uint32_t reserved;
+    uint64_t itemCount;
+};
+
+// The cache never holds fewer pages than this, whatever size was asked for.
+constexpr size_t MIN_CACHE_PAGES = 16;
+}
+
+PageFile::~PageFile() {
+    close();
+}
+
+bool PageFile::open(const string& filename) {
+    close();
+#ifdef PAGEDSTORE_POSIX
+    fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    return fd >= 0;
+#else
+    stream = fopen(filename.c_str(), "r+b");
+    if (stream == nullptr) {
+        stream = fopen(filename.c_str(), "w+b");
+    }
+    return stream != nullptr;
+#endif
+}
+
+void PageFile::close() {
+#ifdef PAGEDSTORE_POSIX
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#else
+    if (stream != nullptr) {
+        fclose(stream);
+        stream = nullptr;
+    }
+#endif
+}
+
+bool PageFile::isOpen() const {
+    return fd >= 0 || stream != nullptr;
+}
+
+uint64_t PageFile::pageCount() const {
+#ifdef PAGEDSTORE_POSIX
+    struct stat status {};
+    if (fstat(fd, &status) != 0) return 0;
+    const auto bytes = static_cast<uint64_t>(status.st_size);
+#else
+    if (fseek(stream, 0, SEEK_END) != 0) return 0;
+    const auto bytes = static_cast<uint64_t>(ftell(stream));
+#endif
+    return (bytes + PAGE_SIZE - 1) / PAGE_SIZE;
+}
+
+/*
+ * readPage function definition:
+ *  - Reads one page; whatever lies past the end of the file reads as zeros.
+ *  - Retries short and interrupted reads.
+ */
+bool PageFile::readPage(const uint64_t pageNum, char* data) {
+    size_t done = 0;
+#ifdef PAGEDSTORE_POSIX
+    while (done < PAGE_SIZE) {
+        const ssize_t count = ::pread(fd, data + done, PAGE_SIZE - done,
+                                      static_cast<off_t>(pageNum * PAGE_SIZE + done));
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (count == 0) break;
+        done += static_cast<size_t>(count);
+    }
+#else
+    if (fseek(stream, static_cast<long>(pageNum * PAGE_SIZE), SEEK_SET) != 0) return false;
+    done = fread(data, 1, PAGE_SIZE, stream);
+    if (ferror(stream)) return false;
+#endif
+    countMetric(MetricCounter::BytesRead, done);
+    memset(data + done, 0, PAGE_SIZE - done);
+    return true;
+}
+
+bool PageFile::writePage(const uint64_t pageNum, const char* data) {
+#ifdef PAGEDSTORE_POSIX
+    size_t done = 0;
+    while (done < PAGE_SIZE) {
+        const ssize_t count = ::pwrite(fd, data + done, PAGE_SIZE - done,
+                                       static_cast<off_t>(pageNum * PAGE_SIZE + done));
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(count);
+    }
+    countMetric(MetricCounter::BytesWritten, PAGE_SIZE);
+    return true;
+#else
+    if (fseek(stream, static_cast<long>(pageNum * PAGE_SIZE), SEEK_SET) != 0) return false;
+    if (fwrite(data, 1, PAGE_SIZE, stream) != PAGE_SIZE) return false;
+    countMetric(MetricCounter::BytesWritten, PAGE_SIZE);
+    return true;
+#endif
+}
+
+bool PageFile::sync() {
+#ifdef PAGEDSTORE_POSIX
+    return ::fsync(fd) == 0;
+#else
+    return fflush(stream) == 0;
+#endif
+}
+
+BufferCache::BufferCache(PageFile& file, const size_t capacityPages)
+    : file(file), capacity(max(capacityPages, MIN_CACHE_PAGES)) {
+    frames.reserve(capacity);
+    frameOf.reserve(capacity);
+    counters.capacityPages = capacity;
+}
+
+void BufferCache::unlink(const int frame) {
+    Frame& f = frames[static_cast<size_t>(frame)];
+    if (f.newer >= 0) frames[static_cast<size_t>(f.newer)].older = f.older;
+    else newest = f.older;
+    if (f.older >= 0) frames[static_cast<size_t>(f.older)].newer = f.newer;
+    else oldest = f.newer;
+    f.newer = f.older = -1;
+}
+
+void BufferCache::linkNewest(const int frame) {
+    Frame& f = frames[static_cast<size_t>(frame)];
+    f.newer = -1;
+    f.older = newest;
+    if (newest >= 0) frames[static_cast<size_t>(newest)].newer = frame;
+    newest = frame;
+    if (oldest < 0) oldest = frame;
+}
+
+void BufferCache::linkOldest(const int frame) {
+    Frame& f = frames[static_cast<size_t>(frame)];
+    f.older = -1;
+    f.newer = oldest;
+    if (oldest >= 0) frames[static_cast<size_t>(oldest)].older = frame;
+    oldest = frame;
+    if (newest < 0) newest = frame;
+}
+
+bool BufferCache::writeBack(const int frame) {
+    Frame& f = frames[static_cast<size_t>(frame)];
+    if (!f.dirty) return true;
+    if (!file.writePage(f.pageNum, f.data.get())) return false;
+    f.dirty = false;
+    ++counters.writeBacks;
+    return true;
+}
+
+/*
+ * fetch function definition:
+ *  - A hit moves the page to the recent end of the list (unless the fetch is part
+ *    of a sequential scan, which leaves it where it is).
+ *  - A miss takes a fresh frame while the cache is below capacity, otherwise the
+ *    least recently used one (writing it back first if dirty), then reads the page.
+ *    Scan pages go in at the cold end, so the next miss reuses their frame.
+ */
+char* BufferCache::fetch(const uint64_t pageNum, const bool forWrite, const bool sequential) {
+    if (const auto found = frameOf.find(pageNum); found != frameOf.end()) {
+        ++counters.hits;
+        const int frame = found->second;
+        if (!sequential && frame != newest) {
+            unlink(frame);
+            linkNewest(frame);
+        }
+        Frame& f = frames[static_cast<size_t>(frame)];
+        f.dirty = f.dirty || forWrite;
+        return f.data.get();
+    }
+
+    ++counters.misses;
+    int frame;
+    unordered_map<uint64_t, int>::node_type reused;
+    if (!spareFrames.empty()) {
+        frame = spareFrames.back();
+        spareFrames.pop_back();
+    } else if (frames.size() < capacity) {
+        frame = static_cast<int>(frames.size());
+        frames.emplace_back();
+        frames.back().data = make_unique<char[]>(PAGE_SIZE);
+    } else {
+        frame = oldest;
+        if (!writeBack(frame)) return nullptr;
+        unlink(frame);
+        reused = frameOf.extract(frames[static_cast<size_t>(frame)].pageNum);
+        ++counters.evictions;
+    }
+
+    Frame& f = frames[static_cast<size_t>(frame)];
+    if (!file.readPage(pageNum, f.data.get())) {
+        // The frame stays empty until the next miss takes it.
+        f.dirty = false;
+        spareFrames.push_back(frame);
+        return nullptr;
+    }
+    f.pageNum = pageNum;
+    f.dirty = forWrite;
+    if (reused) {
+        // Re-key the evicted page's map node instead of allocating a new one
+        reused.key() = pageNum;
+        frameOf.insert(move(reused));
+    } else {
+        frameOf[pageNum] = frame;
+    }
+    if (sequential) linkOldest(frame);
+    else linkNewest(frame);
+    return f.data.get();
+}
+
+void BufferCache::markDirty(const uint64_t pageNum) {
+    if (const auto found = frameOf.find(pageNum); found != frameOf.end()) {
+        frames[static_cast<size_t>(found->second)].dirty = true;
+    }
+}
+
+bool BufferCache::flush() {
+    bool ok = true;
+    for (size_t frame = 0; frame < frames.size(); ++frame) {
+        ok = writeBack(static_cast<int>(frame)) && ok;
+    }
+    return ok;
+}
+
+CacheStats BufferCache::stats() const {
+    CacheStats copy = counters;
+    copy.pagesCached = frameOf.size();
+    return copy;
+}
+
+PagedStore::~PagedStore() {
+    flush();
+}
+
+/*
+ * open function definition:
+ *  - An empty (new) file gets a header page; an existing one must carry the
+ *    same format, page size and record size, and be long enough for its items.
+ */
+bool PagedStore::open(const string& filename, const size_t cacheBytes, const char*& reason) {
+    lock_guard lock(storeMutex);
+    cache.reset();
+    itemCount = 0;
+    if (!file.open(filename)) {
+        reason = "cannot open or create the page file";
+        return false;
+    }
+    cache = make_unique<BufferCache>(file, cacheBytes / BufferCache::PAGE_SIZE);
+
+    const uint64_t pages = file.pageCount();
+    const char* page = cache->fetch(0, pages == 0);
+    if (page == nullptr) {
+        reason = "cannot read the page file";
+        return false;
+    }
+    if (pages == 0) {
+        headerDirty = true;
+        return writeHeader();
+    }
+
+    FileHeader header;
+    memcpy(&header, page, sizeof(header));
+    if (memcmp(header.magic, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC)) != 0) {
+        reason = "not a page file";
+    } else if (header.version == 1) {
+        reason = "page file is from before costs were kept in cents; re-import it from a text export";
+    } else if (header.version != PAGE_FILE_VERSION || header.pageSize != BufferCache::PAGE_SIZE
+               || header.recordSize != RECORD_SIZE) {
+        reason = "page file has an unsupported format";
+    } else if (header.itemCount > static_cast<uint64_t>(INT32_MAX)
+               || (header.itemCount + RECORDS_PER_PAGE - 1) / RECORDS_PER_PAGE + 1 > pages) {
+        reason = "page file is truncated";
+    } else {
+        itemCount = static_cast<int>(header.itemCount);
+        return true;
+    }
+    cache.reset();
+    file.close();
+    return false;
+}
+
+// Puts the item count into page 0 (in the cache; flush() writes it).
+bool PagedStore::writeHeader() {
+    char* page = cache->fetch(0, true);
+    if (page == nullptr) return false;
+    FileHeader header {};
+    memcpy(header.magic, PAGE_FILE_MAGIC, sizeof(PAGE_FILE_MAGIC));
+    header.version = PAGE_FILE_VERSION;
+    header.pageSize = BufferCache::PAGE_SIZE;
+    header.recordSize = RECORD_SIZE;
+    header.itemCount = static_cast<uint64_t>(itemCount);
+    memcpy(page, &header, sizeof(header));
+    headerDirty = false;
+    return true;
+}
+
+/*
+ * flush function definition:
+ *  - Writes the record pages first and the header (with the item count) after
+ *    them, so a crash in between leaves a file whose count only covers records
+ *    already on disk.
+ *  - The records are synced before the header is written: otherwise the kernel
+ *    may put the new count on disk before the records it counts.
+ */
+bool PagedStore::flush() {
+    lock_guard lock(storeMutex);
+    if (!cache) return true;
+    if (!cache->flush()) return false;
+    if (headerDirty && (!file.sync() || !writeHeader())) return false;
+    return cache->flush() && file.sync();
+}
+
+int PagedStore::size() const {
+    lock_guard lock(storeMutex);
+    return itemCount;
+}
+
+PagedStore::Record* PagedStore::recordOf(const int itemNum, const bool forWrite, const bool sequential) const {
+    const auto item = static_cast<uint64_t>(itemNum);
+    char* page = cache->fetch(1 + item / RECORDS_PER_PAGE, forWrite, sequential);
+    if (page == nullptr) return nullptr;
+    return reinterpret_cast<Record*>(page + (item % RECORDS_PER_PAGE) * RECORD_SIZE);
+}
+
+int PagedStore::addItem(const string_view description, const Money cost, const int unitCount) {
+    lock_guard lock(storeMutex);
+    if (!cache) {
+        failure = "no page file is open";
+        return -1;
+    }
+    if (description.size() > MAX_DESCRIPTION) {
+        failure = "description is longer than a page record holds";
+        return -1;
+    }
+    Record* record = recordOf(itemCount, true);
+    if (record == nullptr) {
+        failure = "cannot write the page file";
+        return -1;
+    }
+    *record = Record{};
+    record->cost = cost;
+    record->units = unitCount;
+    record->descriptionLength = static_cast<uint16_t>(description.size());
+    memcpy(record->description, description.data(), description.size());
+    headerDirty = true;
+    return itemCount++;
+}
+
+int PagedStore::addItem(const InventoryItem& item) {
+    return addItem(item.getDescription(), Money::fromDouble(item.getCost()), item.getUnits());
+}
+
+/*
+ * Item accessors:
+ *  - Each one fetches the item's page (usually a cache hit for recently used
+ *    items). On an I/O error they return an empty item rather than stale data.
+ */
+InventoryItem PagedStore::at(const int itemNum) const {
+    lock_guard lock(storeMutex);
+    const Record* record = recordOf(itemNum, false);
+    if (record == nullptr) return InventoryItem();
+    return InventoryItem(string(record->description, record->descriptionLength), record->cost.toDouble(),
+                         record->units);
+}
+
+string PagedStore::getDescription(const int itemNum) const {
+    lock_guard lock(storeMutex);
+    const Record* record = recordOf(itemNum, false);
+    return record == nullptr ? string() : string(record->description, record->descriptionLength);
+}
+
+Money PagedStore::getCost(const int itemNum) const {
+    lock_guard lock(storeMutex);
+    const Record* record = recordOf(itemNum, false);
+    return record == nullptr ? Money() : record->cost;
+}
+
+int PagedStore::getUnits(const int itemNum) const {
+    lock_guard lock(storeMutex);
+    const Record* record = recordOf(itemNum, false);
+    return record == nullptr ? 0 : record->units;
+}
+
+StockResult PagedStore::addUnits(const int itemNum, const int quantity, int* unitsAfter) {
+    if (!contains(itemNum)) return StockResult::NoSuchItem;
+    if (quantity < 0) return StockResult::NegativeQuantity;
+    return changeUnits(itemNum, quantity, unitsAfter);
+}
+
+StockResult PagedStore::removeUnits(const int itemNum, const int quantity, int* unitsAfter) {
+    if (!contains(itemNum)) return StockResult::NoSuchItem;
+    if (quantity < 0) return StockResult::NegativeQuantity;
+    return changeUnits(itemNum, -quantity, unitsAfter);
+}
+
+/*
+ * changeUnits function definition:
+ *  - Checks the 0..MAX_UNITS rule and updates the record under the store lock;
+ *    the page is only marked dirty when the change is made.
+ */
+StockResult PagedStore::changeUnits(const int itemNum, const int delta, int* unitsAfter) {
+    lock_guard lock(storeMutex);
+    Record* record = recordOf(itemNum, false);
+    if (record == nullptr) return StockResult::NoSuchItem;
+    const int updated = record->units + delta;
+    if (updated > MAX_UNITS) return StockResult::ExceedsMaximum;
+    if (updated < 0) return StockResult::InsufficientUnits;
+
+    record->units = updated;
+    cache->markDirty(1 + static_cast<uint64_t>(itemNum) / RECORDS_PER_PAGE);
+    if (unitsAfter != nullptr) {
+        *unitsAfter = updated;
+    }
+    return StockResult::Ok;
+}
+
+CacheStats PagedStore::cacheStats() const {
+    lock_guard lock(storeMutex);
+    return cache ? cache->stats() : CacheStats{};
+}
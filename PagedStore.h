@@ -0,0 +1,244 @@
+// Specification File -> PagedStore.h
+#ifndef PAGEDSTORE_H
+#define PAGEDSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "InventoryItem.h"
+#include "InventoryStore.h"
+
+using namespace std;
+
+// Counters of a BufferCache since it was created.
+struct CacheStats {
+    uint64_t hits = 0;          // Page found in the cache
+    uint64_t misses = 0;        // Page read from the file
+    uint64_t evictions = 0;     // Pages dropped to make room
+    uint64_t writeBacks = 0;    // Dirty pages written to the file
+    size_t pagesCached = 0;
+    size_t capacityPages = 0;
+};
+
+/*
+    PageFile
+    -----------------------------
+    Description:
+    A file read and written in whole pages at computed offsets (pread/pwrite on
+    POSIX systems, seek + read/write elsewhere). Reading past the end of the file
+    yields zeros, so a page that was never written reads as empty.
+
+    In Simpler Terms:
+    The filing cabinet: hand it a page number, get that page back.
+*/
+class PageFile {
+public:
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    PageFile() = default;
+    ~PageFile();
+
+    PageFile(const PageFile&) = delete;
+    PageFile& operator=(const PageFile&) = delete;
+
+    // Opens filename for reading and writing, creating it if needed.
+    bool open(const string& filename);
+    void close();
+    bool isOpen() const;
+
+    // Number of whole or partial pages in the file.
+    uint64_t pageCount() const;
+
+    bool readPage(uint64_t pageNum, char* data);
+    bool writePage(uint64_t pageNum, const char* data);
+
+    // Asks the operating system to put written pages on disk.
+    bool sync();
+
+private:
+    int fd = -1;                // POSIX descriptor
+    FILE* stream = nullptr;     // Portable fallback
+};
+
+/*
+    BufferCache
+    -----------------------------
+    Description:
+    Keeps at most capacityPages pages of a page file in memory. fetch() returns
+    a page from the cache (a hit) or reads it from the file (a miss), first
+    evicting the least recently used page if the cache is full. Pages fetched
+    for writing are marked dirty and written back when they are evicted or when
+    flush() is called, so repeated changes to a hot page cost one write.
+
+    Pages fetched as part of a sequential scan are kept at the cold end of the
+    recency list: a full scan of a huge file passes through the cache without
+    pushing out the pages that are actually being worked on.
+
+    Not thread-safe; PagedStore serializes access.
+
+    In Simpler Terms:
+    A small desk next to a big filing cabinet: the pages in use stay on the
+    desk, and the one untouched the longest goes back into the cabinet.
+*/
+class BufferCache {
+public:
+    static constexpr size_t PAGE_SIZE = PageFile::PAGE_SIZE;
+
+    // file must stay open for the cache's lifetime.
+    BufferCache(PageFile& file, size_t capacityPages);
+
+    BufferCache(const BufferCache&) = delete;
+    BufferCache& operator=(const BufferCache&) = delete;
+
+    // Returns the PAGE_SIZE bytes of page pageNum (zeros past the end of the file),
+    // or nullptr on an I/O error. The pointer is valid until the next fetch.
+    char* fetch(uint64_t pageNum, bool forWrite, bool sequential = false);
+
+    // Marks a cached page (fetched since the last fetch of another page) dirty.
+    void markDirty(uint64_t pageNum);
+
+    // Writes every dirty page back. Returns false on an I/O error.
+    bool flush();
+
+    CacheStats stats() const;
+
+private:
+    struct Frame {
+        uint64_t pageNum = 0;
+        bool dirty = false;
+        int newer = -1;          // Recency list neighbours (frame numbers)
+        int older = -1;
+        unique_ptr<char[]> data;  // PAGE_SIZE bytes
+    };
+
+    PageFile& file;
+    size_t capacity;
+    vector<Frame> frames;        // Grows up to capacity as pages are first cached
+    unordered_map<uint64_t, int> frameOf;
+    vector<int> spareFrames;     // Frames left empty by a failed read
+    int newest = -1;
+    int oldest = -1;
+    CacheStats counters;
+
+    void unlink(int frame);
+    void linkNewest(int frame);
+    void linkOldest(int frame);
+    bool writeBack(int frame);
+};
+
+/*
+    PagedStore
+    -----------------------------
+    Description:
+    An inventory kept in a page file instead of in memory, for catalogs that do
+    not fit in RAM. Every item is a fixed-size record (cost, units, description)
+    at a position computed from its item number, so reaching item n means
+    fetching exactly one page through the BufferCache. Memory use is bounded by
+    the cache size, whatever the number of items.
+
+    The file starts with a header page (format, item count); records follow, 32
+    to a page. Descriptions longer than MAX_DESCRIPTION bytes do not fit a record
+    and are refused. Changes reach the file when their page is evicted or on
+    flush(), which also records the item count; main() flushes after every
+    command and at exit.
+
+    The methods mirror InventoryStore's item access (size, contains, getUnits,
+    addUnits, removeUnits, addItem, ...), so the interactive commands work on
+    either store. All methods are safe to call from several threads (one lock).
+
+    In Simpler Terms:
+    The inventory lives on disk; only the pages being used are in memory.
+*/
+class PagedStore {
+public:
+    static constexpr size_t RECORD_SIZE = 128;
+    static constexpr size_t RECORDS_PER_PAGE = BufferCache::PAGE_SIZE / RECORD_SIZE;
+    static constexpr size_t MAX_DESCRIPTION = RECORD_SIZE - 16;
+
+    PagedStore() = default;
+    ~PagedStore();
+
+    PagedStore(const PagedStore&) = delete;
+    PagedStore& operator=(const PagedStore&) = delete;
+
+    // Opens filename (creating an empty store if it does not exist) with a cache of
+    // cacheBytes (at least a few pages). On failure returns false and sets reason.
+    bool open(const string& filename, size_t cacheBytes, const char*& reason);
+
+    // Writes dirty pages and the header. Returns false on an I/O error.
+    bool flush();
+
+    int size() const;
+    bool empty() const { return size() == 0; }
+    bool contains(int itemNum) const { return itemNum >= 0 && itemNum < size(); }
+
+    // Nothing to reserve: pages are added to the file as items arrive.
+    void reserveForFile(uintmax_t /*fileBytes*/) {}
+
+    // Appends an item and returns its item number, or -1 if the description is
+    // too long or the file cannot be written (see lastFailure()).
+    int addItem(string_view description, Money cost, int unitCount);
+    int addItem(const InventoryItem& item);
+
+    // Access by item number (itemNum must satisfy contains(itemNum)).
+    InventoryItem at(int itemNum) const;
+    string getDescription(int itemNum) const;
+    Money getCost(int itemNum) const;
+    int getUnits(int itemNum) const;
+
+    // Validated stock changes with the same rules and results as InventoryStore's.
+    StockResult addUnits(int itemNum, int quantity, int* unitsAfter = nullptr);
+    StockResult removeUnits(int itemNum, int quantity, int* unitsAfter = nullptr);
+
+    // Calls visit(itemNum, description, cost, units) for items first .. first + count - 1
+    // in order, reading pages as a sequential scan (see BufferCache).
+    template <typename Visit>
+    void forEachItem(int first, int count, Visit&& visit) const;
+
+    // Why the last addItem failed.
+    const char* lastFailure() const { return failure; }
+
+    CacheStats cacheStats() const;
+
+private:
+    // A record as stored in a page.
+    struct Record {
+        Money cost;
+        int32_t units;
+        uint16_t descriptionLength;
+        uint16_t reserved;
+        char description[MAX_DESCRIPTION];
+    };
+    static_assert(sizeof(Record) == RECORD_SIZE, "Records must tile a page exactly");
+
+    PageFile file;
+    mutable unique_ptr<BufferCache> cache;
+    mutable mutex storeMutex;
+    int itemCount = 0;
+    bool headerDirty = false;
+    const char* failure = "";
+
+    // The record of itemNum inside its cached page, or nullptr on an I/O error.
+    Record* recordOf(int itemNum, bool forWrite, bool sequential = false) const;
+    StockResult changeUnits(int itemNum, int delta, int* unitsAfter);
+    bool writeHeader();
+};
+
+template <typename Visit>
+void PagedStore::forEachItem(const int first, const int count, Visit&& visit) const {
+    lock_guard lock(storeMutex);
+    const int last = min(itemCount, first + count);
+    for (int item = max(first, 0); item < last; ++item) {
+        const Record* record = recordOf(item, false, true);
+        if (record == nullptr) return;
+        visit(item, string_view(record->description, record->descriptionLength), record->cost, record->units);
+    }
+}
+
+#endif // PAGEDSTORE_H
@@ -0,0 +1,54 @@
+// ParallelFor.h
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Number of worker threads to use when the caller does not say (at least 1).
+inline unsigned defaultWorkerCount() {
+    return max(1u, thread::hardware_concurrency());
+}
+
+/*
+    parallelFor
+    -----------------------------
+    Description:
+    Runs task(i) for every i in [0, count) using up to `workers` threads and returns
+    once all of them have finished. Threads take the next unclaimed index from a
+    shared atomic counter, so uneven tasks still balance out. The calling thread
+    works too; with one worker (or one task) everything runs on the caller.
+
+    In Simpler Terms:
+    Splits a list of jobs among several helpers and waits until all jobs are done.
+*/
+template <typename Task>
+void parallelFor(const size_t count, Task&& task, unsigned workers = 0) {
+    if (workers == 0) {
+        workers = defaultWorkerCount();
+    }
+    const size_t threadCount = min<size_t>(workers, count);
+
+    atomic<size_t> next{0};
+    auto drain = [&] {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            task(i);
+        }
+    };
+
+    vector<thread> helpers;
+    for (size_t t = 1; t < threadCount; ++t) {
+        helpers.emplace_back(drain);
+    }
+    drain();
+    for (thread& helper : helpers) {
+        helper.join();
+    }
+}
+
+#endif
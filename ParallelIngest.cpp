@@ -0,0 +1,205 @@
+// Implementation File -> ParallelIngest.cpp
+#include "ParallelIngest.h"
+#include "BulkLoader.h"
+#include "BinarySnapshot.h"
+#include "ParallelFor.h"
+#include "Metrics.h"
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <glob.h>
+#endif
+
+using namespace std;
+
+// Smallest chunk worth handing to a separate thread.
+static constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+
+// One newline-aligned slice of a mapped file and the records parsed from it.
+struct IngestChunk {
+    size_t fileIndex = 0;
+    string_view text;
+    vector<ParsedRecord> records;
+    BulkLoadStats stats;
+    bool snapshot = false; // The whole file is a binary snapshot; not parsed
+};
+
+vector<string> expandFilePatterns(const vector<string>& patterns) {
+    vector<string> filenames;
+    for (const string& pattern : patterns) {
+#if defined(__unix__) || defined(__APPLE__)
+        if (pattern.find_first_of("*?[") != string::npos) {
+            glob_t matches{};
+            if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+                for (size_t i = 0; i < matches.gl_pathc; ++i) {
+                    filenames.emplace_back(matches.gl_pathv[i]);
+                }
+            }
+            globfree(&matches);
+            continue;
+        }
+#endif
+        filenames.push_back(pattern);
+    }
+    return filenames;
+}
+
+/*
+ * ingestFiles function definition:
+ *  - Maps every file and splits it into chunks of roughly equal size, each ending
+ *    just after a newline so that no record straddles two chunks.
+ *  - Parses all chunks in parallel; each worker only writes to its own chunk.
+ *  - Appends the records chunk by chunk (files in the given order), so item numbers
+ *    are the same as a sequential load.
+ */
+IngestSummary ingestFiles(const vector<string>& filenames, InventoryStore& inventory, unsigned workers) {
+    const auto start = chrono::steady_clock::now();
+
+    IngestSummary summary;
+    summary.workers = workers == 0 ? defaultWorkerCount() : workers;
+
+    vector<unique_ptr<MappedFile>> files;
+    for (const string& filename : filenames) {
+        IngestFileResult result;
+        result.filename = filename;
+        files.push_back(make_unique<MappedFile>());
+        result.opened = files.back()->open(filename);
+        result.bytes = files.back()->size();
+        summary.bytes += result.bytes;
+        summary.files.push_back(result);
+    }
+
+    const size_t chunkTarget = max(MIN_CHUNK_BYTES, summary.bytes / (summary.workers * 4 + 1));
+    vector<IngestChunk> chunks;
+    for (size_t f = 0; f < files.size(); ++f) {
+        const string_view text = files[f]->view();
+        if (isSnapshotData(text)) {
+            IngestChunk chunk;
+            chunk.fileIndex = f;
+            chunk.text = text;
+            chunk.snapshot = true;
+            chunks.push_back(move(chunk));
+            continue;
+        }
+
+        size_t position = 0;
+        while (position < text.size()) {
+            size_t end = min(text.size(), position + chunkTarget);
+            if (end < text.size()) {
+                const void* newline = memchr(text.data() + end, '\n', text.size() - end);
+                end = newline ? static_cast<size_t>(static_cast<const char*>(newline) - text.data()) + 1 : text.size();
+            }
+            IngestChunk chunk;
+            chunk.fileIndex = f;
+            chunk.text = text.substr(position, end - position);
+            chunks.push_back(move(chunk));
+            position = end;
+        }
+    }
+    summary.chunks = chunks.size();
+
+    parallelFor(chunks.size(), [&](const size_t c) {
+        IngestChunk& chunk = chunks[c];
+        if (chunk.snapshot) {
+            return;
+        }
+        chunk.records.reserve(chunk.text.size() / 32 + 1);
+        scanRecords(chunk.text, chunk.stats, [&](const ParsedRecord& record) {
+            chunk.records.push_back(record);
+            return true;
+        });
+    }, summary.workers);
+
+    inventory.reserveForFile(summary.bytes);
+    for (IngestChunk& chunk : chunks) {
+        if (chunk.snapshot) {
+            const int before = inventory.size();
+            const SnapshotResult result = loadSnapshotData(chunk.text, inventory);
+            chunk.stats.recordsLoaded = static_cast<size_t>(inventory.size() - before);
+            if (result != SnapshotResult::Ok) {
+                summary.files[chunk.fileIndex].error = describeSnapshotResult(result);
+            }
+        }
+        size_t refused = 0;
+        for (const ParsedRecord& record : chunk.records) {
+            refused += inventory.addItem(record.description, record.cost, record.units) < 0;
+        }
+        if (refused > 0) {
+            chunk.stats.recordsLoaded -= refused;
+            chunk.stats.recordsRejected += refused;
+            summary.files[chunk.fileIndex].error = inventory.lastFailure();
+        }
+        IngestFileResult& result = summary.files[chunk.fileIndex];
+        result.recordsLoaded += chunk.stats.recordsLoaded;
+        result.recordsRejected += chunk.stats.recordsRejected;
+        summary.recordsLoaded += chunk.stats.recordsLoaded;
+        summary.recordsRejected += chunk.stats.recordsRejected;
+    }
+
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    countMetric(MetricCounter::RecordsParsed, summary.recordsLoaded);
+    countMetricTime(MetricCounter::ParseNanoseconds, start);
+    return summary;
+}
+
+/*
+ * printIngestSummary function definition:
+ *  - One line per file (or an error if it could not be opened), then the totals.
+ */
+void printIngestSummary(const IngestSummary& summary) {
+    for (const IngestFileResult& file : summary.files) {
+        if (!file.opened) {
+            cout << "Error: Could not open file \"" << file.filename << "\".\n";
+            continue;
+        }
+        if (file.error != nullptr) {
+            cout << "Error: \"" << file.filename << "\": " << file.error << ".\n";
+            continue;
+        }
+        cout << "  " << file.filename << ": " << file.recordsLoaded << " record(s)";
+        if (file.recordsRejected > 0) {
+            cout << ", " << file.recordsRejected << " skipped";
+        }
+        cout << '\n';
+    }
+
+    const double megabytes = static_cast<double>(summary.bytes) / (1024.0 * 1024.0);
+    cout << summary.recordsLoaded << " record(s) loaded to inventory from " << summary.files.size()
+         << " file(s) using " << summary.workers << " thread(s) and " << summary.chunks << " chunk(s).\n"
+         << fixed << setprecision(2) << "Scanned " << summary.bytes << " bytes in " << summary.seconds * 1000.0
+         << " ms (" << (summary.seconds > 0.0 ? megabytes / summary.seconds : 0.0) << " MB/s).\n";
+}
+
+/*
+ * loadManyFiles function definition:
+ *  - Reads one line of space-separated file names and/or wildcard patterns
+ *    (e.g. "electrical.txt plumbing.txt" or "*.txt") and ingests them in parallel.
+ */
+void loadManyFiles(InventoryStore& inventory) {
+    string line;
+    vector<string> patterns;
+
+    while (patterns.empty()) {
+        cout << "Enter input file names or patterns (separated by spaces): ";
+        if (!getline(cin, line)) {
+            return;
+        }
+        istringstream words(line);
+        for (string word; words >> word;) {
+            patterns.push_back(word);
+        }
+    }
+
+    const vector<string> filenames = expandFilePatterns(patterns);
+    if (filenames.empty()) {
+        cout << "Error: No files match \"" << line << "\".\n";
+        return;
+    }
+
+    printIngestSummary(ingestFiles(filenames, inventory));
+}
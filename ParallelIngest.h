@@ -0,0 +1,62 @@
+// Specification File -> ParallelIngest.h
+#ifndef PARALLELINGEST_H
+#define PARALLELINGEST_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "InventoryStore.h"
+
+using namespace std;
+
+/*
+    Parallel Ingest
+    -----------------------------
+    Description:
+    Loads many inventory files at once. Every file is memory-mapped and cut into
+    chunks that end on a line boundary; the chunks are parsed concurrently (see
+    parallelFor), and the parsed records are then appended to the store in file
+    order and, within a file, in line order. The result is identical to loading the
+    files one after another with the 'b' command. Binary snapshots in the list are
+    recognized and loaded whole, in their place in the order.
+
+    In Simpler Terms:
+    Reads a whole list of files using every processor core, while keeping the items
+    in the same order as if the files were read one by one.
+*/
+
+// Per-file outcome of an ingest.
+struct IngestFileResult {
+    string filename;
+    bool opened = false;
+    size_t bytes = 0;
+    size_t recordsLoaded = 0;
+    size_t recordsRejected = 0;
+    const char* error = nullptr; // Set if a binary snapshot was rejected or the inventory filled up
+};
+
+// Totals for one ingest run.
+struct IngestSummary {
+    vector<IngestFileResult> files;
+    size_t bytes = 0;
+    size_t recordsLoaded = 0;
+    size_t recordsRejected = 0;
+    size_t chunks = 0;
+    unsigned workers = 0;
+    double seconds = 0.0;
+};
+
+// Expands shell-style wildcards (*, ?, [...]) in each pattern; names without
+// wildcards are passed through. Matches of one pattern are sorted by name.
+vector<string> expandFilePatterns(const vector<string>& patterns);
+
+// Loads every file into the inventory (workers = 0 uses one per hardware thread).
+IngestSummary ingestFiles(const vector<string>& filenames, InventoryStore& inventory, unsigned workers = 0);
+
+// Prints per-file counts, totals and throughput.
+void printIngestSummary(const IngestSummary& summary);
+
+// 'l' command handler: prompts for file names/patterns and loads them in parallel.
+void loadManyFiles(InventoryStore& inventory);
+
+#endif // PARALLELINGEST_H
@@ -0,0 +1,239 @@
+// Specification File -> RecordSchema.h
+#ifndef RECORDSCHEMA_H
+#define RECORDSCHEMA_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "Money.h"
+
+using namespace std;
+
+// Parses a cost/units field (surrounding blanks allowed) without allocating or throwing.
+bool parseCostField(string_view text, Money& cost);
+bool parseUnitsField(string_view text, int& units);
+
+/*
+    Record fields
+    -----------------------------
+    Description:
+    One type per column an inventory file can have. Each says what it holds
+    (Value), how to read it from the text between two '|' (parse) and how to
+    write it back (format, to anything with append(string_view), append(char),
+    appendInt and appendCost, such as AtomicFileWriter). Text columns are kept
+    as views into the line, so reading them costs nothing.
+
+    IndexField is read leniently: the store numbers items itself, so a load
+    only needs the column to be there. A value that is not a number is read as
+    -1 for the tools that match records by number (--merge).
+*/
+struct IndexField {
+    using Value = int;
+    static bool parse(const string_view text, int& value) {
+        const auto [last, error] = from_chars(text.data(), text.data() + text.size(), value);
+        if (error != errc() || last != text.data() + text.size()) value = -1;
+        return true;
+    }
+    template <typename Out>
+    static void format(Out& out, const int value) { out.appendInt(value); }
+};
+
+struct DescriptionField {
+    using Value = string_view;
+    static bool parse(const string_view text, string_view& value) { value = text; return true; }
+    template <typename Out>
+    static void format(Out& out, const string_view value) { out.append(value); }
+};
+
+// Cost in cents, written in fixed notation with two decimals.
+struct CostField {
+    using Value = Money;
+    static bool parse(const string_view text, Money& value) { return parseCostField(text, value); }
+    template <typename Out>
+    static void format(Out& out, const Money value) { out.appendCost(value); }
+};
+
+// Units as a whole number; the 0..MAX_UNITS rule is the loader's to check.
+struct UnitsField {
+    using Value = int;
+    static bool parse(const string_view text, int& value) { return parseUnitsField(text, value); }
+    template <typename Out>
+    static void format(Out& out, const int value) { out.appendInt(value); }
+};
+
+// Vendor columns the store has no room for: carried through as text.
+template <int Tag>
+struct TextField : DescriptionField {};
+using SkuField = TextField<0>;
+using SupplierField = TextField<1>;
+using BinField = TextField<2>;
+
+/*
+    RecordSchema
+    -----------------------------
+    Description:
+    A file layout written as its list of columns, in order:
+        RecordSchema<IndexField, DescriptionField, CostField, UnitsField>
+    From it the compiler generates the record type (one member per column)
+    and a parser and a formatter that are straight-line code for exactly those
+    columns: no table of field kinds is consulted at run time and nothing is
+    allocated per field. Reading and writing use the same column list, so a
+    written record always reads back the same.
+
+    Loaders take the columns they need by type (record.get<CostField>()); a
+    layout needs a DescriptionField, CostField and UnitsField to be loadable.
+    Columns past the last one are ignored on reading, as before.
+
+    In Simpler Terms:
+    Describe the columns once; the reading and writing code is made from that.
+*/
+template <typename... Fields>
+struct RecordSchema {
+    static constexpr size_t FIELDS = sizeof...(Fields);
+    static_assert(FIELDS > 0, "A record has at least one column");
+
+    // Position of a column in the layout (the first, if it appears twice).
+    template <typename Field>
+    static constexpr size_t position() {
+        constexpr bool matches[] = {is_same_v<Field, Fields>...};
+        for (size_t i = 0; i < FIELDS; ++i) {
+            if (matches[i]) return i;
+        }
+        return FIELDS;
+    }
+
+    template <typename Field>
+    static constexpr bool HAS = position<Field>() < FIELDS;
+
+    struct Record {
+        tuple<typename Fields::Value...> values;
+
+        template <typename Field>
+        auto& get() {
+            static_assert(HAS<Field>, "The layout has no such column");
+            return std::get<position<Field>()>(values);
+        }
+        template <typename Field>
+        const auto& get() const {
+            static_assert(HAS<Field>, "The layout has no such column");
+            return std::get<position<Field>()>(values);
+        }
+    };
+
+    /*
+        parseLine: the line runs from lineStart to lineEnd and pipes holds its
+        first FIELDS '|' (pipeCount of them were found; at least FIELDS - 1 must
+        be). Returns FIELDS if every column parsed, or the position of the first
+        one that did not.
+    */
+    static size_t parseLine(const char* lineStart, const char* lineEnd, const char* const* pipes, const int pipeCount,
+                            Record& record) {
+        const char* lastEnd = pipeCount >= static_cast<int>(FIELDS) ? pipes[FIELDS - 1] : lineEnd;
+        return parseFrom<0>(lineStart, lastEnd, pipes, record);
+    }
+
+    // parseLine for one line of text (without its newline); also returns FIELDS
+    // + 1 if the line has too few columns.
+    static size_t parseText(const string_view line, Record& record) {
+        const char* pipes[FIELDS];
+        int pipeCount = 0;
+        for (size_t i = 0; i < line.size() && pipeCount < static_cast<int>(FIELDS); ++i) {
+            if (line[i] == '|') pipes[pipeCount++] = line.data() + i;
+        }
+        if (pipeCount + 1 < static_cast<int>(FIELDS)) {
+            return FIELDS + 1;
+        }
+        return parseLine(line.data(), line.data() + line.size(), pipes, pipeCount, record);
+    }
+
+    // Writes the record as one line, columns separated by '|', ending in '\n'.
+    template <typename Out>
+    static void format(Out& out, const Record& record) {
+        formatAll(out, record, index_sequence_for<Fields...>{});
+        out.append('\n');
+    }
+
+private:
+    template <size_t I>
+    static size_t parseFrom(const char* lineStart, const char* lastEnd, const char* const* pipes, Record& record) {
+        if constexpr (I == FIELDS) {
+            return FIELDS;
+        } else {
+            using Field = tuple_element_t<I, tuple<Fields...>>;
+            const char* first = I == 0 ? lineStart : pipes[I - 1] + 1;
+            const char* last = I + 1 == FIELDS ? lastEnd : pipes[I];
+            if (!Field::parse(string_view(first, static_cast<size_t>(last - first)), std::get<I>(record.values))) {
+                return I;
+            }
+            return parseFrom<I + 1>(lineStart, lastEnd, pipes, record);
+        }
+    }
+
+    template <size_t I, typename Out>
+    static void formatField(Out& out, const Record& record) {
+        if constexpr (I > 0) {
+            out.append('|');
+        }
+        tuple_element_t<I, tuple<Fields...>>::format(out, std::get<I>(record.values));
+    }
+
+    template <typename Out, size_t... I>
+    static void formatAll(Out& out, const Record& record, index_sequence<I...>) {
+        (formatField<I>(out, record), ...);
+    }
+};
+
+// The program's own layout, read by 'i', 'b', 'l' and written by 'o', 'w', 'd'.
+using InventoryRecordSchema = RecordSchema<IndexField, DescriptionField, CostField, UnitsField>;
+
+// A vendor price list: SKU and supplier around the description, storage bin last.
+using VendorRecordSchema =
+    RecordSchema<IndexField, SkuField, DescriptionField, SupplierField, CostField, UnitsField, BinField>;
+
+// Layouts 'i' can read, chosen per file (i <file> [layout]).
+enum class RecordLayout : uint8_t {
+    Inventory,
+    Vendor
+};
+
+// "inventory" / "vendor" to a layout; false if the name is unknown.
+inline bool parseRecordLayout(const string_view name, RecordLayout& layout) {
+    if (name == "inventory") {
+        layout = RecordLayout::Inventory;
+    } else if (name == "vendor") {
+        layout = RecordLayout::Vendor;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+inline const char* describeRecordLayout(const RecordLayout layout) {
+    return layout == RecordLayout::Vendor ? "index|sku|description|supplier|cost|units|bin"
+                                          : "index|description|cost|units";
+}
+
+/*
+    withRecordSchema
+    -----------------------------
+    Description:
+    Calls visit(Schema{}) with the schema type of a layout. The choice is made
+    once, here; everything visit does with the schema is compiled separately
+    for each layout.
+*/
+template <typename Visit>
+decltype(auto) withRecordSchema(const RecordLayout layout, Visit&& visit) {
+    switch (layout) {
+        case RecordLayout::Vendor:
+            return visit(VendorRecordSchema{});
+        case RecordLayout::Inventory:
+            break;
+    }
+    return visit(InventoryRecordSchema{});
+}
+
+#endif // RECORDSCHEMA_H
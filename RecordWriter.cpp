@@ -0,0 +1,396 @@
+// Implementation File -> RecordWriter.cpp
+#include "RecordWriter.h"
+#include "Metrics.h"
+#include "RecordSchema.h"
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define RECORDWRITER_POSIX 1
+#endif
+
+using namespace std;
+
+AtomicFileWriter::~AtomicFileWriter() {
+    discard();
+}
+
+/*
+ * open function definition:
+ *  - Creates (or truncates) "<filename>.tmp" and allocates the reusable buffer.
+ */
+bool AtomicFileWriter::open(const string& filename) {
+    discard();
+    target = filename;
+    temporary = filename + ".tmp";
+    used = 0;
+    written = 0;
+    failed = false;
+    buffer.resize(BUFFER_SIZE);
+
+#ifdef RECORDWRITER_POSIX
+    fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    return fd >= 0;
+#else
+    stream = fopen(temporary.c_str(), "wb");
+    return stream != nullptr;
+#endif
+}
+
+/*
+ * flushBuffer function definition:
+ *  - Hands the whole buffer to the operating system, retrying short writes.
+ *  - Any error is remembered and reported by commit().
+ */
+void AtomicFileWriter::flushBuffer() {
+    const char* data = buffer.data();
+    size_t remaining = used;
+
+#ifdef RECORDWRITER_POSIX
+    while (remaining > 0 && !failed) {
+        const ssize_t count = ::write(fd, data, remaining);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            break;
+        }
+        data += count;
+        remaining -= static_cast<size_t>(count);
+    }
+#else
+    if (fwrite(data, 1, remaining, stream) != remaining) {
+        failed = true;
+    }
+#endif
+
+    countMetric(MetricCounter::BytesWritten, used);
+    written += used;
+    used = 0;
+}
+
+void AtomicFileWriter::append(const string_view text) {
+    if (text.empty()) {
+        return;
+    }
+    if (text.size() > buffer.size() - used) {
+        flushBuffer();
+        if (text.size() > buffer.size()) {
+            buffer.resize(text.size());
+        }
+    }
+    memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+}
+
+void AtomicFileWriter::append(const char c) {
+    if (used == buffer.size()) {
+        flushBuffer();
+    }
+    buffer[used++] = c;
+}
+
+void AtomicFileWriter::appendInt(const long long value) {
+    if (buffer.size() - used < MAX_FIELD) {
+        flushBuffer();
+    }
+    char* first = buffer.data() + used;
+    used += static_cast<size_t>(to_chars(first, first + MAX_FIELD, value).ptr - first);
+}
+
+/*
+ * appendCost function definition:
+ *  - Formats the cents with formatMoney: two decimals, the same text "fixed <<
+ *    setprecision(2)" produced for the old double costs, with integer
+ *    arithmetic only.
+ */
+void AtomicFileWriter::appendCost(const Money cost) {
+    if (buffer.size() - used < MAX_FIELD) {
+        flushBuffer();
+    }
+    char* first = buffer.data() + used;
+    used += static_cast<size_t>(formatMoney(first, cost) - first);
+}
+
+/*
+ * commit function definition:
+ *  - Flushes the last partial buffer, syncs the file to disk and closes it.
+ *  - Renames the temporary file over the target only if every step succeeded;
+ *    otherwise removes it and leaves the target untouched.
+ */
+bool AtomicFileWriter::commit() {
+    flushBuffer();
+
+#ifdef RECORDWRITER_POSIX
+    if (fd >= 0) {
+        if (fsync(fd) != 0) failed = true;
+        if (::close(fd) != 0) failed = true;
+        fd = -1;
+    }
+#else
+    if (stream != nullptr) {
+        if (fclose(stream) != 0) failed = true;
+        stream = nullptr;
+    }
+#endif
+
+    if (!failed) {
+        error_code renameError;
+        filesystem::rename(temporary, target, renameError);
+        failed = static_cast<bool>(renameError);
+    }
+
+    if (failed) {
+        discard();
+        return false;
+    }
+    temporary.clear();
+    return true;
+}
+
+/*
+ * discard function definition:
+ *  - Closes and deletes an uncommitted temporary file.
+ */
+void AtomicFileWriter::discard() {
+#ifdef RECORDWRITER_POSIX
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#else
+    if (stream != nullptr) {
+        fclose(stream);
+        stream = nullptr;
+    }
+#endif
+    if (!temporary.empty()) {
+        error_code ignored;
+        filesystem::remove(temporary, ignored);
+        temporary.clear();
+    }
+}
+
+void appendRecord(AtomicFileWriter& writer, const int itemNum, const string_view description,
+                  const Money cost, const int units) {
+    InventoryRecordSchema::Record record;
+    record.get<IndexField>() = itemNum;
+    record.get<DescriptionField>() = description;
+    record.get<CostField>() = cost;
+    record.get<UnitsField>() = units;
+    InventoryRecordSchema::format(writer, record);
+}
+
+// Writes count records taken straight from the three columns.
+static bool writeColumns(const string& filename, const string_view* descriptions, const Money* costs,
+                         const int* units, const size_t count) {
+    const auto start = metricClock();
+    AtomicFileWriter writer;
+    if (!writer.open(filename)) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        appendRecord(writer, static_cast<int>(i), descriptions[i], costs[i], units[i]);
+    }
+    countMetric(MetricCounter::RowsFormatted, count);
+    countMetricTime(MetricCounter::FormatNanoseconds, start);
+    return writer.commit();
+}
+
+/*
+ * writeInventoryFile function definition:
+ *  - Writes every item to filename in pipe-delimited format without any prompting.
+ *  - Each inventory item is written in the format: index|description|cost|units,
+ *    with the cost in fixed-point notation with 2 decimal places.
+ *  - The file is replaced atomically (see AtomicFileWriter).
+ */
+bool writeInventoryFile(const InventoryStore& inventory, const string& filename) {
+    const auto start = metricClock();
+    AtomicFileWriter writer;
+    if (!writer.open(filename)) {
+        return false;
+    }
+    size_t records = 0;
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        for (size_t i = 0; i < span.count; ++i) {
+            appendRecord(writer, span.firstItem + static_cast<int>(i), span.descriptions[i], span.costs[i],
+                         span.units[i]);
+        }
+        records += span.count;
+    });
+    countMetric(MetricCounter::RowsFormatted, records);
+    countMetricTime(MetricCounter::FormatNanoseconds, start);
+    return writer.commit();
+}
+
+// Same for a paged store: one sequential scan, so the cache keeps its working set.
+bool writeInventoryFile(const PagedStore& inventory, const string& filename) {
+    const auto start = metricClock();
+    AtomicFileWriter writer;
+    if (!writer.open(filename)) {
+        return false;
+    }
+    size_t records = 0;
+    inventory.forEachItem(0, inventory.size(), [&](const int itemNum, const string_view description,
+                                                   const Money cost, const int units) {
+        appendRecord(writer, itemNum, description, cost, units);
+        ++records;
+    });
+    countMetric(MetricCounter::RowsFormatted, records);
+    countMetricTime(MetricCounter::FormatNanoseconds, start);
+    return writer.commit();
+}
+
+/*
+ * writeInventoryRecords function definition:
+ *  - Same record format as writeInventoryFile, for a chosen set of items; a
+ *    handful of items costs a handful of lines, whatever the store's size.
+ */
+bool writeInventoryRecords(const InventoryStore& inventory, const vector<int>& itemNums, const string& filename,
+                           size_t* bytes) {
+    const auto start = metricClock();
+    AtomicFileWriter writer;
+    if (!writer.open(filename)) {
+        return false;
+    }
+    for (const int itemNum : itemNums) {
+        appendRecord(writer, itemNum, inventory.getDescription(itemNum), inventory.getCost(itemNum),
+                     inventory.getUnits(itemNum));
+    }
+    countMetric(MetricCounter::RowsFormatted, itemNums.size());
+    countMetricTime(MetricCounter::FormatNanoseconds, start);
+    if (bytes != nullptr) {
+        *bytes = writer.bytesWritten();
+    }
+    return writer.commit();
+}
+
+// Writes the frozen view, chunk by chunk, as writeInventoryFile would the store.
+static bool writeFrozenUnits(const string& filename, FrozenUnits& frozen) {
+    const auto start = metricClock();
+    AtomicFileWriter writer;
+    if (!writer.open(filename)) {
+        return false;
+    }
+    frozen.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        for (size_t i = 0; i < span.count; ++i) {
+            appendRecord(writer, span.firstItem + static_cast<int>(i), span.descriptions[i], span.costs[i],
+                         span.units[i]);
+        }
+    });
+    countMetric(MetricCounter::RowsFormatted, static_cast<size_t>(frozen.size()));
+    countMetricTime(MetricCounter::FormatNanoseconds, start);
+    return writer.commit();
+}
+
+/*
+ * Background export state:
+ *  - At most one worker thread; the main thread starts, polls and joins it.
+ *  - The worker writes a frozen view of the units (InventoryStore::freezeUnits):
+ *    starting costs the command loop a moment with the stripe locks held, not a
+ *    copy of the columns, and stock changes during the write only copy the
+ *    chunks they touch first. Costs and descriptions are read from the store
+ *    itself, since they never change once written.
+ *  - The view is freed by the main thread once it joins the worker: without
+ *    transactions the main thread is the one changing stock, so the view cannot
+ *    go away under one of its changes.
+ *  - A store that cannot be frozen (another view exists) gets the old column
+ *    copy instead.
+ */
+namespace {
+struct BackgroundExport {
+    thread worker;
+    unique_ptr<FrozenUnits> frozen;
+    atomic<bool> finished{false};
+    bool succeeded = false;
+    string filename;
+    size_t records = 0;
+    size_t chunksCopied = 0;
+    double seconds = 0.0;
+};
+
+BackgroundExport background;
+}
+
+bool startBackgroundExport(const InventoryStore& inventory, const string& filename) {
+    if (background.worker.joinable() && !background.finished.load(memory_order_acquire)) {
+        return false;
+    }
+    if (background.worker.joinable()) {
+        background.worker.join();
+        background.frozen.reset();
+    }
+
+    background.finished.store(false, memory_order_relaxed);
+    background.filename = filename;
+    background.chunksCopied = 0;
+
+    if (unique_ptr<FrozenUnits> frozen = inventory.freezeUnits()) {
+        background.records = static_cast<size_t>(frozen->size());
+        background.frozen = move(frozen);
+        background.worker = thread([frozen = background.frozen.get()] {
+            const auto start = chrono::steady_clock::now();
+            background.succeeded = writeFrozenUnits(background.filename, *frozen);
+            background.chunksCopied = frozen->chunksCopiedForWriters();
+            background.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            background.finished.store(true, memory_order_release);
+        });
+        return true;
+    }
+
+    vector<string_view> descriptions;
+    vector<Money> costs;
+    vector<int> units;
+    inventory.forEachSpan([&](const InventoryStore::ColumnSpan& span) {
+        descriptions.insert(descriptions.end(), span.descriptions, span.descriptions + span.count);
+        costs.insert(costs.end(), span.costs, span.costs + span.count);
+        units.insert(units.end(), span.units, span.units + span.count);
+    });
+    background.records = units.size();
+    background.worker = thread([descriptions = move(descriptions), costs = move(costs), units = move(units)] {
+        const auto start = chrono::steady_clock::now();
+        background.succeeded = writeColumns(background.filename, descriptions.data(), costs.data(),
+                                            units.data(), descriptions.size());
+        background.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        background.finished.store(true, memory_order_release);
+    });
+    return true;
+}
+
+// Joins the finished worker, frees its view and prints its outcome.
+static void finishBackgroundExport() {
+    background.worker.join();
+    background.frozen.reset();
+
+    if (background.succeeded) {
+        cout << "Background export: " << background.records << " record(s) written to \""
+             << background.filename << "\" in " << fixed << setprecision(2)
+             << background.seconds * 1000.0 << " ms";
+        if (background.chunksCopied > 0) {
+            cout << " (" << background.chunksCopied << " block(s) of stock levels copied for changes made meanwhile)";
+        }
+        cout << ".\n";
+    } else {
+        cout << "Error: Background export to \"" << background.filename << "\" failed.\n";
+    }
+}
+
+void reportBackgroundExport() {
+    if (background.worker.joinable() && background.finished.load(memory_order_acquire)) {
+        finishBackgroundExport();
+    }
+}
+
+void waitForBackgroundExport() {
+    if (background.worker.joinable()) {
+        finishBackgroundExport();
+    }
+}
@@ -0,0 +1,104 @@
+// Specification File -> RecordWriter.h
+#ifndef RECORDWRITER_H
+#define RECORDWRITER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InventoryStore.h"
+#include "PagedStore.h"
+
+using namespace std;
+
+/*
+    AtomicFileWriter
+    -----------------------------
+    Description:
+    Buffered output file that replaces its target atomically. Data goes into a large
+    reusable buffer and reaches the operating system one whole buffer per write call.
+    Everything is written to "<filename>.tmp"; commit() flushes, syncs it to disk and
+    renames it over filename, so readers see either the old file or the complete new
+    one, never a half-written file. If commit() is never reached the temporary file
+    is removed.
+
+    In Simpler Terms:
+    Writes the file off to the side in big pieces, then swaps it into place at the end.
+*/
+class AtomicFileWriter {
+public:
+    static constexpr size_t BUFFER_SIZE = 1 << 20; // 1 MiB per write call
+
+    AtomicFileWriter() = default;
+    ~AtomicFileWriter();
+
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    // Creates the temporary file next to filename. Returns false on failure.
+    bool open(const string& filename);
+
+    // Appends raw text / a whole number / a cost with exactly two decimals.
+    void append(string_view text);
+    void append(char c);
+    void appendInt(long long value);
+    void appendCost(Money cost);
+
+    // Flushes, syncs and renames the temporary file over the target. Returns false on any I/O error.
+    bool commit();
+
+    size_t bytesWritten() const { return written + used; }
+
+private:
+    string target;
+    string temporary;
+    vector<char> buffer;
+    size_t used = 0;
+    size_t written = 0;
+    bool failed = false;
+    int fd = -1;              // POSIX descriptor
+    FILE* stream = nullptr;   // Used instead of fd on other platforms
+
+    // Room for the longest single formatted value appended without a bounds check.
+    static constexpr size_t MAX_FIELD = 64;
+
+    void flushBuffer();
+    void discard();
+};
+
+// Appends one "index|description|cost|units\n" record to the writer (the
+// InventoryRecordSchema formatter, so 'i' reads back exactly what is written).
+void appendRecord(AtomicFileWriter& writer, int itemNum, string_view description, Money cost, int units);
+
+// Writes every item to filename in pipe-delimited format (no prompts). Returns false on failure.
+bool writeInventoryFile(const InventoryStore& inventory, const string& filename);
+bool writeInventoryFile(const PagedStore& inventory, const string& filename);
+
+// Writes only the given items (in the order given) in the same format, as a delta
+// file (see DeltaExport.h). Sets bytes to the file size when it is not null.
+bool writeInventoryRecords(const InventoryStore& inventory, const vector<int>& itemNums, const string& filename,
+                           size_t* bytes = nullptr);
+
+/*
+    Background Export
+    -----------------------------
+    Description:
+    Writes the inventory as it was when the export started on a worker thread,
+    so the command loop can continue while a large file is written. Starting
+    does not copy the inventory: the stock levels are frozen copy-on-write (see
+    FrozenUnits), so stock changes made during the write cost at most a block
+    copy the first time they touch a block. Only one background export runs at
+    a time.
+*/
+
+// Starts writing the inventory as it is now to filename. Returns false if an export is already running.
+bool startBackgroundExport(const InventoryStore& inventory, const string& filename);
+
+// Prints a one-line report if a background export has finished since the last call.
+void reportBackgroundExport();
+
+// Blocks until any running background export finishes, then reports it.
+void waitForBackgroundExport();
+
+#endif // RECORDWRITER_H
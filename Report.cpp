@@ -0,0 +1,405 @@
+// Implementation File -> Report.cpp
+#include "Report.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+using namespace std;
+
+// Rows a sorted view puts in order on its first read (growing on each further read).
+static constexpr size_t FIRST_SORT_BLOCK = 4096;
+
+// Rows fetched from the view at a time while formatting.
+static constexpr size_t ROWS_PER_READ = 1024;
+
+// Column widths of the printInventory layout.
+static constexpr size_t ITEM_WIDTH = 10;
+static constexpr size_t DESCRIPTION_WIDTH = 45;
+static constexpr size_t COST_WIDTH = 8;
+static constexpr size_t UNITS_WIDTH = 10;
+
+static string_view trimFront(string_view text) {
+    while (!text.empty() && isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+    return text;
+}
+
+// Removes and returns the next whitespace-separated word of text.
+static string_view takeWord(string_view& text) {
+    text = trimFront(text);
+    size_t length = 0;
+    while (length < text.size() && !isspace(static_cast<unsigned char>(text[length]))) ++length;
+    const string_view word = text.substr(0, length);
+    text.remove_prefix(length);
+    return word;
+}
+
+static bool sameWord(const string_view word, const string_view expected) {
+    return word.size() == expected.size() &&
+           equal(word.begin(), word.end(), expected.begin(),
+                 [](const char a, const char b) { return tolower(static_cast<unsigned char>(a)) == b; });
+}
+
+static bool allDigits(const string_view word) {
+    return !word.empty() && all_of(word.begin(), word.end(), [](const char c) { return c >= '0' && c <= '9'; });
+}
+
+/*
+ * parseReportRequest function definition:
+ *  - Takes the parts in a fixed order: up to two numbers, "by" and its key, "> file".
+ *  - Whatever is left is handed to parseSearchQuery as the filter. A filter
+ *    cannot start with a plain number (it would be read as the first row).
+ */
+bool parseReportRequest(const string_view input, ReportRequest& request, const char*& reason) {
+    ReportRequest parsed;
+    string_view rest = input;
+
+    for (int number = 0; number < 2; ++number) {
+        string_view next = rest;
+        const string_view word = takeWord(next);
+        if (!allDigits(word)) break;
+        size_t value = 0;
+        if (from_chars(word.data(), word.data() + word.size(), value).ec != errc()) {
+            reason = "row number is too large";
+            return false;
+        }
+        (number == 0 ? parsed.first : parsed.count) = value;
+        rest = next;
+    }
+
+    string_view next = rest;
+    if (sameWord(takeWord(next), "by")) {
+        const string_view key = takeWord(next);
+        if (sameWord(key, "cost")) {
+            parsed.order = ReportRequest::Order::Cost;
+        } else if (sameWord(key, "units")) {
+            parsed.order = ReportRequest::Order::Units;
+        } else if (sameWord(key, "description")) {
+            parsed.order = ReportRequest::Order::Description;
+        } else if (sameWord(key, "item")) {
+            parsed.order = ReportRequest::Order::ItemNumber;
+        } else {
+            reason = "expected cost, units, description or item after \"by\"";
+            return false;
+        }
+        rest = next;
+
+        const string_view direction = takeWord(next);
+        if (sameWord(direction, "desc") || sameWord(direction, "descending")) {
+            parsed.descending = true;
+            rest = next;
+        } else if (sameWord(direction, "asc") || sameWord(direction, "ascending")) {
+            rest = next;
+        }
+    }
+
+    rest = trimFront(rest);
+    if (!rest.empty() && rest.front() == '>') {
+        rest.remove_prefix(1);
+        parsed.outputFile = string(takeWord(rest));
+        if (parsed.outputFile.empty()) {
+            reason = "expected a file name after \">\"";
+            return false;
+        }
+    }
+
+    rest = trimFront(rest);
+    if (!rest.empty()) {
+        if (!parseSearchQuery(rest, parsed.filter, reason)) {
+            return false;
+        }
+        parsed.filtered = true;
+    }
+
+    request = move(parsed);
+    return true;
+}
+
+/*
+ * ReportView constructor definition:
+ *  - One pass over the items: applies the filter and collects what the order
+ *    needs (nothing, item numbers, or (key, item number) pairs). Sorting waits
+ *    until rows are read.
+ */
+ReportView::ReportView(const InventoryStore& store, const ReportRequest& request)
+    : order(request.order), descending(request.descending), filtered(request.filtered),
+      itemCount(store.size()), nextBlock(FIRST_SORT_BLOCK) {
+    const SearchFilter filter(request.filter);
+    const auto passes = [&](const int item) {
+        return !filtered ||
+               filter.matches(store.getDescription(item), store.getCost(item), store.getUnits(item));
+    };
+
+    switch (order) {
+        case ReportRequest::Order::Cost:
+        case ReportRequest::Order::Units:
+            numberKeys.reserve(filtered ? 0 : static_cast<size_t>(itemCount));
+            for (int item = 0; item < itemCount; ++item) {
+                if (passes(item)) {
+                    numberKeys.emplace_back(order == ReportRequest::Order::Cost ? store.getCost(item).cents
+                                                                                : store.getUnits(item), item);
+                }
+            }
+            rows = numberKeys.size();
+            break;
+        case ReportRequest::Order::Description:
+            textKeys.reserve(filtered ? 0 : static_cast<size_t>(itemCount));
+            for (int item = 0; item < itemCount; ++item) {
+                if (passes(item)) {
+                    const string_view description = store.getDescription(item);
+                    DescriptionKey key{0, description};
+                    for (size_t i = 0; i < sizeof(key.prefix); ++i) {
+                        key.prefix <<= 8;
+                        if (i < description.size()) key.prefix |= static_cast<unsigned char>(description[i]);
+                    }
+                    textKeys.emplace_back(key, item);
+                }
+            }
+            rows = textKeys.size();
+            break;
+        default:
+            if (filtered) {
+                for (int item = 0; item < itemCount; ++item) {
+                    if (passes(item)) matches.push_back(item);
+                }
+                rows = matches.size();
+            } else {
+                rows = static_cast<size_t>(itemCount);
+            }
+    }
+}
+
+size_t ReportView::read(const size_t first, size_t count, int* itemNums) {
+    if (first >= rows) {
+        return 0;
+    }
+    count = min(count, rows - first);
+
+    switch (order) {
+        case ReportRequest::Order::Cost:
+        case ReportRequest::Order::Units:
+            return readSorted(numberKeys, first, count, itemNums);
+        case ReportRequest::Order::Description:
+            return readSorted(textKeys, first, count, itemNums);
+        default:
+            for (size_t i = 0; i < count; ++i) {
+                const size_t row = descending ? rows - 1 - (first + i) : first + i;
+                itemNums[i] = filtered ? matches[row] : static_cast<int>(row);
+            }
+            return count;
+    }
+}
+
+/*
+ * readSorted function definition:
+ *  - A read that does not continue the ordered rows first splits off everything
+ *    before `first` (nth_element), leaving those rows unsorted.
+ *  - Then rows from the end of the ordered block up to the end of the read (or
+ *    further, in blocks that grow 4x with every forward read) are split off
+ *    the same way and sorted. Once the block would reach past half of the
+ *    unsorted rows, all of them are sorted at once, so a forward scan costs
+ *    little more than one sort.
+ */
+template <typename Key>
+size_t ReportView::readSorted(vector<pair<Key, int>>& keys, const size_t first, const size_t count, int* itemNums) {
+    const auto before = [this](const pair<Key, int>& a, const pair<Key, int>& b) {
+        if (a.first != b.first) return descending ? b.first < a.first : a.first < b.first;
+        return a.second < b.second;
+    };
+    const auto at = [&keys](const size_t row) { return keys.begin() + static_cast<ptrdiff_t>(row); };
+
+    if (first < orderedFrom || first > orderedTo) {
+        if (first >= settled) {
+            nth_element(at(settled), at(first), keys.end(), before);
+            settled = first;
+        } else {
+            nth_element(at(0), at(first), at(settled), before);
+        }
+        orderedFrom = orderedTo = first;
+        nextBlock = FIRST_SORT_BLOCK;
+    }
+
+    const size_t last = first + count;
+    if (last > orderedTo) {
+        size_t target = min(rows, max(last, orderedTo + nextBlock));
+        if (target - orderedTo > (rows - orderedTo) / 2) {
+            target = rows;
+        }
+        if (target > settled) {
+            if (target < rows) nth_element(at(settled), at(target), keys.end(), before);
+            settled = target;
+        } else {
+            nth_element(at(orderedTo), at(target), at(settled), before);
+        }
+        sort(at(orderedTo), at(target), before);
+        orderedTo = target;
+        nextBlock *= 4;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        itemNums[i] = keys[first + i].second;
+    }
+    return count;
+}
+
+static void appendPadding(string& out, const size_t length, const size_t width) {
+    if (length < width) out.append(width - length, ' ');
+}
+
+// Appends text left-aligned (padRight) or right-aligned in a column of width characters.
+static void appendColumn(string& out, const string_view text, const size_t width, const bool padRight) {
+    if (!padRight) appendPadding(out, text.size(), width);
+    out += text;
+    if (padRight) appendPadding(out, text.size(), width);
+}
+
+void appendReportHeader(string& out) {
+    appendColumn(out, "Item #", ITEM_WIDTH, true);
+    appendColumn(out, "Description", DESCRIPTION_WIDTH, true);
+    appendColumn(out, "Cost", COST_WIDTH, false);
+    appendColumn(out, "Quantity", UNITS_WIDTH, false);
+    out += '\n';
+    out.append(ITEM_WIDTH + DESCRIPTION_WIDTH + COST_WIDTH + UNITS_WIDTH, '_');
+    out += '\n';
+}
+
+/*
+ * appendReportRow function definition:
+ *  - Produces exactly what the stream manipulators of the old printInventory
+ *    did (left << setw(10), setw(45), right << fixed << setprecision(2) <<
+ *    setw(8), setw(10)): numbers are formatted with to_chars and formatMoney and
+ *    padded by hand.
+ */
+void appendReportRow(string& out, const int itemNum, const string_view description, const Money cost,
+                     const int units) {
+    char digits[MONEY_CHARS];
+    appendColumn(out, string_view(digits, static_cast<size_t>(to_chars(digits, digits + sizeof(digits), itemNum).ptr - digits)),
+                 ITEM_WIDTH, true);
+    appendColumn(out, description, DESCRIPTION_WIDTH, true);
+    appendColumn(out, string_view(digits, static_cast<size_t>(formatMoney(digits, cost) - digits)), COST_WIDTH, false);
+    appendColumn(out, string_view(digits, static_cast<size_t>(to_chars(digits, digits + sizeof(digits), units).ptr - digits)),
+                 UNITS_WIDTH, false);
+    out += '\n';
+}
+
+static void appendNumber(string& out, const size_t value) {
+    char digits[24];
+    out.append(digits, static_cast<size_t>(to_chars(digits, digits + sizeof(digits), value).ptr - digits));
+}
+
+/*
+ * appendReportFooter function definition:
+ *  - A plain listing of everything ends as it always has ("N records.").
+ *  - Pages and filtered listings say which rows were shown, out of how many.
+ */
+static void appendReportFooter(string& out, const ReportRequest& request, const ReportSummary& summary) {
+    const char* plural = summary.rowsMatching == 1 ? "" : "s";
+    if (!request.filtered && summary.firstRow == 0 && summary.rowsShown == summary.rowsMatching) {
+        appendNumber(out, summary.rowsMatching);
+        out += " record";
+        out += plural;
+        out += ".\n";
+        return;
+    }
+
+    if (summary.rowsShown == 0) {
+        out += "No rows from row ";
+        appendNumber(out, request.first);
+        out += " on; ";
+    } else {
+        out += "Rows ";
+        appendNumber(out, summary.firstRow);
+        out += '-';
+        appendNumber(out, summary.firstRow + summary.rowsShown - 1);
+        out += " of ";
+    }
+    appendNumber(out, summary.rowsMatching);
+    out += request.filtered ? " matching record" : " record";
+    out += plural;
+    if (request.filtered) {
+        out += " (";
+        appendNumber(out, static_cast<size_t>(summary.items));
+        out += " in total)";
+    }
+    out += ".\n";
+}
+
+/*
+ * writeReport function definition:
+ *  - Reads the rows from a ReportView ROWS_PER_READ at a time and formats them
+ *    into one string, handed to sink whenever it holds REPORT_BUFFER_SIZE bytes.
+ */
+ReportSummary writeReport(const InventoryStore& inventory, const ReportRequest& request,
+                          const function<void(string_view)>& sink) {
+    const auto start = metricClock();
+    ReportView view(inventory, request);
+    ReportSummary summary;
+    summary.items = view.storeItems();
+    summary.rowsMatching = view.size();
+    summary.firstRow = min(request.first, view.size());
+    summary.rowsShown = min(request.count, view.size() - summary.firstRow);
+
+    string out;
+    out.reserve(REPORT_BUFFER_SIZE + 4096);
+    appendReportHeader(out);
+
+    // Sorted rows visit the columns in random order: fetching a whole batch in a
+    // tight loop first lets those cache misses overlap instead of queueing up
+    // behind the formatting of each row.
+    int rowItems[ROWS_PER_READ];
+    string_view descriptions[ROWS_PER_READ];
+    Money costs[ROWS_PER_READ];
+    int units[ROWS_PER_READ];
+    const size_t lastRow = summary.firstRow + summary.rowsShown;
+    for (size_t row = summary.firstRow; row < lastRow;) {
+        const size_t read = view.read(row, min(ROWS_PER_READ, lastRow - row), rowItems);
+        for (size_t i = 0; i < read; ++i) {
+            descriptions[i] = inventory.getDescription(rowItems[i]);
+            costs[i] = inventory.getCost(rowItems[i]);
+            units[i] = inventory.getUnits(rowItems[i]);
+        }
+        for (size_t i = 0; i < read; ++i) {
+            appendReportRow(out, rowItems[i], descriptions[i], costs[i], units[i]);
+        }
+        row += read;
+        if (out.size() >= REPORT_BUFFER_SIZE) {
+            sink(out);
+            out.clear();
+        }
+    }
+
+    appendReportFooter(out, request, summary);
+    sink(out);
+    countMetric(MetricCounter::RowsFormatted, summary.rowsShown);
+    countMetricTime(MetricCounter::FormatNanoseconds, start);
+    return summary;
+}
+
+ReportSummary writeReport(const PagedStore& inventory, const ReportRequest& request,
+                          const function<void(string_view)>& sink) {
+    const auto start = metricClock();
+    ReportSummary summary;
+    summary.items = inventory.size();
+    summary.rowsMatching = static_cast<size_t>(summary.items);
+    summary.firstRow = min(request.first, summary.rowsMatching);
+    summary.rowsShown = min(request.count, summary.rowsMatching - summary.firstRow);
+
+    string out;
+    out.reserve(REPORT_BUFFER_SIZE + 4096);
+    appendReportHeader(out);
+    inventory.forEachItem(static_cast<int>(summary.firstRow), static_cast<int>(summary.rowsShown),
+                          [&](const int itemNum, const string_view description, const Money cost,
+                              const int units) {
+        appendReportRow(out, itemNum, description, cost, units);
+        if (out.size() >= REPORT_BUFFER_SIZE) {
+            sink(out);
+            out.clear();
+        }
+    });
+
+    appendReportFooter(out, request, summary);
+    sink(out);
+    countMetric(MetricCounter::RowsFormatted, summary.rowsShown);
+    countMetricTime(MetricCounter::FormatNanoseconds, start);
+    return summary;
+}
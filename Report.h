@@ -0,0 +1,140 @@
+// Specification File -> Report.h
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "InventoryStore.h"
+#include "PagedStore.h"
+#include "SearchIndex.h"
+
+using namespace std;
+
+// Rows of the report are formatted into a buffer of about this size before it
+// is handed on (to the console or a file) in one piece.
+constexpr size_t REPORT_BUFFER_SIZE = 1 << 20;
+
+// What to list: which rows, in which order, which items, and where to.
+struct ReportRequest {
+    enum class Order { ItemNumber, Cost, Units, Description };
+
+    size_t first = 0;              // First row shown (0 = top of the list)
+    size_t count = SIZE_MAX;       // Rows shown from there (SIZE_MAX = all)
+    Order order = Order::ItemNumber;
+    bool descending = false;
+    bool filtered = false;
+    SearchQuery filter;            // Used when filtered (same forms as 'f')
+    string outputFile;             // Empty = the console
+};
+
+/*
+ * Parses what the user typed after 'p':
+ *   [first [count]] [by cost|units|description|item [asc|desc]] [> file] [filter]
+ * e.g. "1000 50", "by cost desc", "0 20 by units units < 5", "> report.txt hex".
+ * Anything after the recognised parts is a filter, written as for 'f'.
+ * On failure returns false and sets reason.
+ */
+bool parseReportRequest(string_view input, ReportRequest& request, const char*& reason);
+
+/*
+    ReportView
+    -----------------------------
+    Description:
+    The rows of a report: the items of a store (as they were when the view was
+    made) that pass the filter, in the requested order. Nothing about the items
+    is copied up front except what the order needs:
+      - in item-number order without a filter the view is just a counter;
+      - with a filter it keeps the matching item numbers;
+      - sorted, it keeps one (key, item number) pair per row and sorts lazily.
+        Rows are put in order only when they are read: rows skipped over are
+        just partitioned off (nth_element), and reading continues in growing
+        blocks (the rest is sorted in one go once most of it is wanted). A page
+        in the middle of a million sorted rows costs one linear pass plus
+        sorting the page itself; reading the whole view costs about one full
+        sort. Descriptions sort in byte order; equal keys keep item-number order.
+
+    In Simpler Terms:
+    A list of what to print, sorted only as far as anyone actually looks.
+*/
+class ReportView {
+public:
+    ReportView(const InventoryStore& store, const ReportRequest& request);
+
+    // Number of rows (items passing the filter).
+    size_t size() const { return rows; }
+
+    // Number of items the store held when the view was made.
+    int storeItems() const { return itemCount; }
+
+    // Copies the item numbers of rows [first, first + count) into itemNums (cut
+    // off at size()) and returns how many were copied. Cheapest when reads move
+    // forward through the view.
+    size_t read(size_t first, size_t count, int* itemNums);
+
+private:
+    // A description with its first 8 bytes packed big-endian in front, so most
+    // comparisons are one integer compare instead of a string compare.
+    struct DescriptionKey {
+        uint64_t prefix = 0;
+        string_view text;
+
+        friend bool operator==(const DescriptionKey& a, const DescriptionKey& b) {
+            return a.prefix == b.prefix && a.text == b.text;
+        }
+        friend bool operator<(const DescriptionKey& a, const DescriptionKey& b) {
+            return a.prefix != b.prefix ? a.prefix < b.prefix : a.text < b.text;
+        }
+    };
+
+    const ReportRequest::Order order;
+    const bool descending;
+    const bool filtered;
+    int itemCount = 0;
+    size_t rows = 0;
+
+    // Sorted views: rows [orderedFrom, orderedTo) are in their final order, and
+    // every row before `settled` ranks below every row from `settled` on.
+    size_t orderedFrom = 0;
+    size_t orderedTo = 0;
+    size_t settled = 0;
+    size_t nextBlock = 0;          // Rows put in order by the next forward read
+    vector<int> matches;                         // Filtered, item-number order
+    vector<pair<int64_t, int>> numberKeys;       // Sorted by cost (cents) or units
+    vector<pair<DescriptionKey, int>> textKeys;  // Sorted by description
+
+    template <typename Key>
+    size_t readSorted(vector<pair<Key, int>>& keys, size_t first, size_t count, int* itemNums);
+};
+
+// What writeReport showed.
+struct ReportSummary {
+    size_t firstRow = 0;
+    size_t rowsShown = 0;
+    size_t rowsMatching = 0;       // Rows in the view (after filtering)
+    int items = 0;                 // Items in the store
+};
+
+/*
+ * Formats the requested rows in the printInventory layout: header, rows and a
+ * footer line. The text goes to sink in pieces of about REPORT_BUFFER_SIZE,
+ * never one row at a time.
+ */
+ReportSummary writeReport(const InventoryStore& inventory, const ReportRequest& request,
+                          const function<void(string_view)>& sink);
+
+// The same for a paged store, which lists in item-number order only (no sorting
+// or filtering: those would need every row in memory). Rows are read with one
+// sequential scan, so printing does not push the working set out of the cache.
+ReportSummary writeReport(const PagedStore& inventory, const ReportRequest& request,
+                          const function<void(string_view)>& sink);
+
+// Appends the column header / one row of the printInventory layout.
+void appendReportHeader(string& out);
+void appendReportRow(string& out, int itemNum, string_view description, Money cost, int units);
+
+#endif // REPORT_H
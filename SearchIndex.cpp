@@ -0,0 +1,440 @@
+// Implementation File -> SearchIndex.cpp
+#include "SearchIndex.h"
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+using namespace std;
+
+// Trigrams are coded from 6-bit character classes: letters (either case), digits,
+// space, and 27 buckets shared by everything else. Sharing only costs a few extra
+// candidates, which the final check removes.
+static constexpr int GRAM_BITS = 6;
+static constexpr size_t TRIGRAM_CODES = size_t{1} << (3 * GRAM_BITS);
+
+// The cost index keeps recent items in a small sorted list and folds them into
+// the main list once there are more than this many (or 1/64 of the main list).
+static constexpr size_t RECENT_COSTS_MIN = 1024;
+
+static uint32_t gramClass(const unsigned char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= '0' && c <= '9') return 26 + (c - '0');
+    if (c == ' ') return 36;
+    return 37 + c % 27;
+}
+
+static uint32_t trigramCode(const string_view text, const size_t at) {
+    return gramClass(static_cast<unsigned char>(text[at])) << (2 * GRAM_BITS) |
+           gramClass(static_cast<unsigned char>(text[at + 1])) << GRAM_BITS |
+           gramClass(static_cast<unsigned char>(text[at + 2]));
+}
+
+// part must already be lower case.
+static bool containsIgnoringCase(const string_view text, const string_view part) {
+    const auto lower = [](const char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c; };
+    for (size_t at = 0; at + part.size() <= text.size(); ++at) {
+        size_t matched = 0;
+        while (matched < part.size() && lower(text[at + matched]) == part[matched]) ++matched;
+        if (matched == part.size()) return true;
+    }
+    return false;
+}
+
+// First position at or after `from` holding a value >= item: doubling steps, then
+// a binary search inside the last step. Cheap when the next match is close.
+static vector<int>::const_iterator gallopTo(vector<int>::const_iterator from, const vector<int>::const_iterator last,
+                                           const int item) {
+    ptrdiff_t step = 1;
+    while (last - from > step && *(from + step) < item) {
+        from += step;
+        step *= 2;
+    }
+    return lower_bound(from, min(from + step + 1, last), item);
+}
+
+static string_view trim(string_view text) {
+    while (!text.empty() && isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+    while (!text.empty() && isspace(static_cast<unsigned char>(text.back()))) text.remove_suffix(1);
+    return text;
+}
+
+// Reads a number from the front of text (after spaces).
+static bool takeNumber(string_view& text, double& value) {
+    text = trim(text);
+    const auto [last, error] = from_chars(text.data(), text.data() + text.size(), value);
+    if (error != errc() || !isfinite(value)) return false;
+    text.remove_prefix(static_cast<size_t>(last - text.data()));
+    return true;
+}
+
+// Reads an amount from the front of text (after spaces), up to the next blank.
+static bool takeMoney(string_view& text, Money& value) {
+    text = trim(text);
+    const size_t end = min(text.find_first_of(" \t"), text.size());
+    if (!parseMoney(text.substr(0, end), value)) return false;
+    text.remove_prefix(end);
+    return true;
+}
+
+static bool startsWithWord(string_view text, const string_view word) {
+    if (text.size() < word.size()) return false;
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (tolower(static_cast<unsigned char>(text[i])) != word[i]) return false;
+    }
+    return text.size() == word.size() || isspace(static_cast<unsigned char>(text[word.size()]));
+}
+
+/*
+ * parseSearchQuery function definition:
+ *  - "units"/"cost" followed by an operator, a number or "between" is a range
+ *    query; anything else (including "cost" followed by other words) is text.
+ *  - Strict bounds are turned into closed ones: units < 5 is units 0..4, and
+ *    cost < 2 is cost up to 1.99. Costs are read as Money (parseMoney), so a
+ *    bound is compared to the stored cents exactly.
+ */
+bool parseSearchQuery(const string_view input, SearchQuery& query, const char*& reason) {
+    const string_view text = trim(input);
+    if (text.empty()) {
+        reason = "nothing to search for";
+        return false;
+    }
+
+    SearchQuery range;
+    string_view rest;
+    if (startsWithWord(text, "units")) {
+        range.field = SearchQuery::Field::Units;
+        rest = trim(text.substr(5));
+    } else if (startsWithWord(text, "cost")) {
+        range.field = SearchQuery::Field::Cost;
+        rest = trim(text.substr(4));
+    }
+    const bool isRange = !rest.empty() && (rest.front() == '<' || rest.front() == '>' || rest.front() == '=' ||
+                                           isdigit(static_cast<unsigned char>(rest.front())) ||
+                                           startsWithWord(rest, "between"));
+    if (!isRange) {
+        query = SearchQuery();
+        query.text = string(text);
+        return true;
+    }
+
+    // Units bounds are read as doubles and Cost bounds as Money; one step is a
+    // whole unit or a cent, and the open ends are the lowest and highest values.
+    const bool units = range.field == SearchQuery::Field::Units;
+    const double infinity = numeric_limits<double>::infinity();
+    double low = -infinity;
+    double high = infinity;
+    Money lowCost = Money::lowest();
+    Money highCost = Money::highest();
+    const auto take = [&](string_view& from, double& number, Money& amount) {
+        return units ? takeNumber(from, number) : takeMoney(from, amount);
+    };
+    if (startsWithWord(rest, "between")) {
+        rest.remove_prefix(7);
+        if (!take(rest, low, lowCost)) {
+            reason = "expected a number after \"between\"";
+            return false;
+        }
+        rest = trim(rest);
+        if (!startsWithWord(rest, "and") || (rest.remove_prefix(3), !take(rest, high, highCost))) {
+            reason = "expected \"between <low> and <high>\"";
+            return false;
+        }
+    } else {
+        string_view op = rest.substr(0, rest.find_first_not_of("<>="));
+        rest.remove_prefix(op.size());
+        double value = 0.0;
+        Money amount;
+        if (!take(rest, value, amount)) {
+            reason = "expected a number after the comparison";
+            return false;
+        }
+        const Money cent = Money::fromCents(1);
+        if (op == "<") {
+            high = ceil(value) - 1.0;
+            if (amount == Money::lowest()) lowCost = Money::highest();  // Nothing is below it
+            else highCost = amount - cent;
+        } else if (op == "<=") {
+            high = value;
+            highCost = amount;
+        } else if (op == ">") {
+            low = floor(value) + 1.0;
+            if (amount == Money::highest()) highCost = Money::lowest();  // Nothing is above it
+            else lowCost = amount + cent;
+        } else if (op == ">=") {
+            low = value;
+            lowCost = amount;
+        } else if (op.empty() || op == "=" || op == "==") {
+            low = high = value;
+            lowCost = highCost = amount;
+        } else {
+            reason = "unknown comparison (use <, <=, >, >=, = or between)";
+            return false;
+        }
+    }
+    if (!trim(rest).empty()) {
+        reason = "unexpected text after the number";
+        return false;
+    }
+    if (units ? low > high : lowCost > highCost) {
+        reason = "the range is empty";
+        return false;
+    }
+
+    // A fractional units range holds the whole numbers inside it (possibly none)
+    range.lowUnits = static_cast<int>(max(ceil(low), static_cast<double>(INT_MIN)));
+    range.highUnits = static_cast<int>(min(floor(high), static_cast<double>(INT_MAX)));
+    range.lowCost = lowCost;
+    range.highCost = highCost;
+    query = range;
+    return true;
+}
+
+SearchFilter::SearchFilter(const SearchQuery& query) : query(query), lowered(query.text) {
+    transform(lowered.begin(), lowered.end(), lowered.begin(), [](const unsigned char c) { return tolower(c); });
+}
+
+bool SearchFilter::matches(const string_view description, const Money cost, const int units) const {
+    switch (query.field) {
+        case SearchQuery::Field::Units:
+            return units >= query.lowUnits && units <= query.highUnits;
+        case SearchQuery::Field::Cost:
+            return cost >= query.lowCost && cost <= query.highCost;
+        default:
+            return containsIgnoringCase(description, lowered);
+    }
+}
+
+SearchIndex::SearchIndex(InventoryStore& store) : store(store), trigramItems(TRIGRAM_CODES) {
+    store.addObserver(this);
+}
+
+SearchIndex::~SearchIndex() {
+    store.removeObserver(this);
+}
+
+int SearchIndex::indexedItems() const {
+    shared_lock lock(indexMutex);
+    return indexed;
+}
+
+/*
+ * search function definition:
+ *  - Runs under the shared lock when the index is current; otherwise takes the
+ *    exclusive lock once to index the items added since the last search.
+ */
+SearchResult SearchIndex::search(const SearchQuery& query, const size_t limit) const {
+    const auto run = [&] {
+        switch (query.field) {
+            case SearchQuery::Field::Units:
+                return findUnits(query.lowUnits, query.highUnits, limit);
+            case SearchQuery::Field::Cost:
+                return findCost(query.lowCost, query.highCost, limit);
+            default:
+                return findText(query.text, limit);
+        }
+    };
+
+    {
+        shared_lock lock(indexMutex);
+        if (indexed >= store.size()) {
+            return run();
+        }
+    }
+    unique_lock lock(indexMutex);
+    catchUp();
+    return run();
+}
+
+/*
+ * catchUp function definition:
+ *  - Called with the exclusive lock held. Indexes items indexed .. size() - 1:
+ *    their trigrams, their current units and their cost.
+ *  - New costs go to the small recent list; it is merged into the main list once
+ *    it grows past RECENT_COSTS_MIN or 1/64 of the main list, so adding items one
+ *    at a time does not move the whole main list every time.
+ */
+void SearchIndex::catchUp() const {
+    const int total = store.size();
+    if (indexed >= total) {
+        return;
+    }
+
+    groupSlot.resize(static_cast<size_t>(total));
+    const size_t recentBefore = recentCosts.size();
+    for (int item = indexed; item < total; ++item) {
+        const string_view description = store.getDescription(item);
+        for (size_t at = 0; at + 3 <= description.size(); ++at) {
+            vector<int>& items = trigramItems[trigramCode(description, at)];
+            if (items.empty() || items.back() != item) {
+                items.push_back(item);
+            }
+        }
+        addToUnitsGroup(item, store.getUnits(item));
+        recentCosts.emplace_back(store.getCost(item), item);
+    }
+    indexed = total;
+
+    sort(recentCosts.begin() + static_cast<ptrdiff_t>(recentBefore), recentCosts.end());
+    inplace_merge(recentCosts.begin(), recentCosts.begin() + static_cast<ptrdiff_t>(recentBefore), recentCosts.end());
+    if (recentCosts.size() > max(RECENT_COSTS_MIN, costOrder.size() / 64)) {
+        const size_t before = costOrder.size();
+        costOrder.insert(costOrder.end(), recentCosts.begin(), recentCosts.end());
+        inplace_merge(costOrder.begin(), costOrder.begin() + static_cast<ptrdiff_t>(before), costOrder.end());
+        recentCosts.clear();
+    }
+}
+
+void SearchIndex::addToUnitsGroup(const int itemNum, const int units) const {
+    vector<int>& group = unitsGroups[units];
+    groupSlot[static_cast<size_t>(itemNum)] = static_cast<int>(group.size());
+    group.push_back(itemNum);
+}
+
+// Removes itemNum from the group for `units`; false if it is not in that group.
+bool SearchIndex::removeFromUnitsGroup(const int itemNum, const int units) const {
+    const auto found = unitsGroups.find(units);
+    const size_t slot = static_cast<size_t>(groupSlot[static_cast<size_t>(itemNum)]);
+    if (found == unitsGroups.end() || slot >= found->second.size() || found->second[slot] != itemNum) {
+        return false;
+    }
+    vector<int>& group = found->second;
+    group[slot] = group.back();
+    groupSlot[static_cast<size_t>(group[slot])] = static_cast<int>(slot);
+    group.pop_back();
+    return true;
+}
+
+/*
+ * onUnitsChanged function definition:
+ *  - Moves the item from its old units group to the new one.
+ *  - Items not indexed yet are skipped; they are read when the next search
+ *    indexes them. If an index pass read the unit count between the change and
+ *    this notification, the item is already in the new group and stays there.
+ */
+void SearchIndex::onUnitsChanged(const InventoryStore& /*store*/, const int itemNum, const int oldUnits,
+                                 const int newUnits) {
+    unique_lock lock(indexMutex);
+    if (itemNum >= indexed || oldUnits == newUnits) {
+        return;
+    }
+    if (removeFromUnitsGroup(itemNum, oldUnits)) {
+        addToUnitsGroup(itemNum, newUnits);
+    }
+}
+
+/*
+ * findText function definition:
+ *  - Three characters or more: walks the shortest trigram list of the query and
+ *    keeps the items found in every other list (galloping forward through them),
+ *    then checks those candidates really contain the text
+ *    (the trigrams might be in a different order, or share a character class).
+ *  - Shorter queries have no trigram, so every indexed description is checked.
+ */
+SearchResult SearchIndex::findText(const string_view text, const size_t limit) const {
+    string lowered(text);
+    transform(lowered.begin(), lowered.end(), lowered.begin(), [](const unsigned char c) { return tolower(c); });
+
+    SearchResult result;
+    const auto check = [&](const int item) {
+        if (containsIgnoringCase(store.getDescription(item), lowered)) {
+            if (result.items.size() < limit) result.items.push_back(item);
+            ++result.total;
+        }
+    };
+
+    if (text.size() < 3) {
+        for (int item = 0; item < indexed; ++item) {
+            check(item);
+        }
+        return result;
+    }
+
+    vector<const vector<int>*> lists;
+    for (size_t at = 0; at + 3 <= text.size(); ++at) {
+        lists.push_back(&trigramItems[trigramCode(text, at)]);
+    }
+    sort(lists.begin(), lists.end(), [](const vector<int>* a, const vector<int>* b) { return a->size() < b->size(); });
+    lists.erase(unique(lists.begin(), lists.end()), lists.end());
+
+    // One cursor per longer list; all lists are ascending, so cursors only move forward
+    vector<vector<int>::const_iterator> cursors;
+    for (size_t l = 1; l < lists.size(); ++l) {
+        cursors.push_back(lists[l]->begin());
+    }
+    for (const int item : *lists.front()) {
+        bool inAll = true;
+        for (size_t c = 0; c < cursors.size() && inAll; ++c) {
+            cursors[c] = gallopTo(cursors[c], lists[c + 1]->end(), item);
+            inAll = cursors[c] != lists[c + 1]->end() && *cursors[c] == item;
+        }
+        if (inAll) {
+            check(item);
+        }
+    }
+    return result;
+}
+
+/*
+ * findUnits function definition:
+ *  - Visits only the units groups inside the range. Counting is one addition per
+ *    group; the first `limit` items are picked in item order within each group.
+ */
+SearchResult SearchIndex::findUnits(const int low, const int high, const size_t limit) const {
+    SearchResult result;
+    for (auto group = unitsGroups.lower_bound(low); group != unitsGroups.end() && group->first <= high; ++group) {
+        result.total += group->second.size();
+        const size_t take = min(limit - result.items.size(), group->second.size());
+        if (take > 0) {
+            const size_t before = result.items.size();
+            result.items.resize(before + take);
+            partial_sort_copy(group->second.begin(), group->second.end(),
+                              result.items.begin() + static_cast<ptrdiff_t>(before), result.items.end());
+        }
+    }
+    return result;
+}
+
+/*
+ * findCost function definition:
+ *  - Two binary searches in each of the main and recent cost lists; the first
+ *    `limit` matches are merged from both in cost order.
+ */
+SearchResult SearchIndex::findCost(const Money low, const Money high, const size_t limit) const {
+    const auto range = [&](const vector<pair<Money, int>>& costs) {
+        return make_pair(lower_bound(costs.begin(), costs.end(), make_pair(low, INT_MIN)),
+                         upper_bound(costs.begin(), costs.end(), make_pair(high, INT_MAX)));
+    };
+    auto [mainFirst, mainLast] = range(costOrder);
+    auto [recentFirst, recentLast] = range(recentCosts);
+
+    SearchResult result;
+    result.total = static_cast<size_t>((mainLast - mainFirst) + (recentLast - recentFirst));
+    result.items.reserve(min(limit, result.total));
+    while (result.items.size() < limit && (mainFirst != mainLast || recentFirst != recentLast)) {
+        if (recentFirst == recentLast || (mainFirst != mainLast && *mainFirst < *recentFirst)) {
+            result.items.push_back((mainFirst++)->second);
+        } else {
+            result.items.push_back((recentFirst++)->second);
+        }
+    }
+    return result;
+}
+
+namespace {
+unique_ptr<SearchIndex> activeIndex;
+}
+
+SearchIndex& searchIndexFor(InventoryStore& inventory) {
+    if (!activeIndex) {
+        activeIndex = make_unique<SearchIndex>(inventory);
+    }
+    return *activeIndex;
+}
+
+void stopSearchIndex() {
+    activeIndex.reset();
+}
@@ -0,0 +1,131 @@
+// Specification File -> SearchIndex.h
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "InventoryStore.h"
+
+using namespace std;
+
+// What a search looks for: description text, or a closed range of units or cost.
+struct SearchQuery {
+    enum class Field { Description, Units, Cost };
+
+    Field field = Field::Description;
+    string text;          // Description: case-insensitive substring
+    int lowUnits = 0;     // Units: lowUnits <= units <= highUnits
+    int highUnits = 0;
+    Money lowCost;        // Cost: lowCost <= cost <= highCost
+    Money highCost;
+};
+
+struct SearchResult {
+    size_t total = 0;     // Number of matching items
+    vector<int> items;    // The first matches (up to the limit asked for)
+};
+
+/*
+ * Parses what the user typed after 'f':
+ *   "units < 5", "units >= 10", "units = 0", "cost between 2 and 4", "cost <= 1.5"
+ * or any other text, which is searched for in the descriptions.
+ * On failure returns false and sets reason.
+ */
+bool parseSearchQuery(string_view input, SearchQuery& query, const char*& reason);
+
+/*
+ * Checks items against a query one at a time, without an index (for scans that
+ * visit the items anyway, such as a filtered 'p' report).
+ */
+class SearchFilter {
+public:
+    explicit SearchFilter(const SearchQuery& query);
+
+    bool matches(string_view description, Money cost, int units) const;
+
+private:
+    SearchQuery query;
+    string lowered;   // Query text in lower case
+};
+
+/*
+    SearchIndex
+    -----------------------------
+    Description:
+    Secondary indexes over an InventoryStore, so items can be found by what they
+    are rather than by item number:
+      - Description text: a trigram index. Every run of three characters in a
+        description (case-folded) maps to the ascending list of items containing
+        it. A query looks up its own trigrams, walks the shortest list and checks
+        each candidate, so the cost follows the number of candidates, not the
+        size of the store. Queries shorter than three characters scan the
+        descriptions instead.
+      - Units: items grouped by unit count in an ordered map, so a range query
+        visits only the unit values inside the range. Each stock change moves one
+        item between two groups in O(1).
+      - Cost: (cost, item) pairs kept sorted; a range is a pair of binary
+        searches. Costs never change after an item is created.
+
+    The index follows the store as an InventoryObserver: stock changes update the
+    units groups as they happen, and new items are indexed by the next query, so
+    bulk loads do not pay for the index. Queries may run on any thread; they share
+    the index with each other and only exclude the (short) updates.
+
+    In Simpler Terms:
+    The index at the back of a catalogue: look up "hex" or "fewer than 5 in
+    stock" and get the item numbers straight away, without reading every page.
+*/
+class SearchIndex : public InventoryObserver {
+public:
+    explicit SearchIndex(InventoryStore& store);
+    ~SearchIndex() override;
+
+    SearchIndex(const SearchIndex&) = delete;
+    SearchIndex& operator=(const SearchIndex&) = delete;
+
+    // Counts every match and returns the first `limit` of them: descriptions in
+    // item order, units and cost ranges in value order (ties by item number).
+    SearchResult search(const SearchQuery& query, size_t limit = SIZE_MAX) const;
+
+    // Number of items indexed so far (new items are added by the next search).
+    int indexedItems() const;
+
+    void onUnitsChanged(const InventoryStore& store, int itemNum, int oldUnits, int newUnits) override;
+
+private:
+    InventoryStore& store;
+
+    mutable shared_mutex indexMutex;
+    mutable int indexed = 0;                           // Items 0 .. indexed - 1 are in the index
+    mutable vector<vector<int>> trigramItems;          // Trigram code -> ascending item numbers
+    mutable map<int, vector<int>> unitsGroups;         // Units -> items with that many units
+    mutable vector<int> groupSlot;                     // Item -> position in its units group
+    mutable vector<pair<Money, int>> costOrder;        // Sorted by cost, then item
+    mutable vector<pair<Money, int>> recentCosts;      // Same, for items not merged into costOrder yet
+
+    void catchUp() const;
+    void addToUnitsGroup(int itemNum, int units) const;
+    bool removeFromUnitsGroup(int itemNum, int units) const;
+    SearchResult findText(string_view text, size_t limit) const;
+    SearchResult findUnits(int low, int high, size_t limit) const;
+    SearchResult findCost(Money low, Money high, size_t limit) const;
+};
+
+/*
+    Application-level index
+    -----------------------------
+    Built the first time the 'f' command runs and kept up to date from then on.
+*/
+
+// The index for the program's inventory, created (and attached) on first use.
+SearchIndex& searchIndexFor(InventoryStore& inventory);
+
+// Detaches and frees the index (called at exit, before the inventory goes away).
+void stopSearchIndex();
+
+#endif // SEARCHINDEX_H
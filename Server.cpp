@@ -0,0 +1,520 @@
+// Implementation File -> Server.cpp
+#include "Server.h"
+#include "BatchMode.h"
+#include "Journal.h"
+#include "StockStats.h"
+#include "ParallelFor.h"
+#include "Report.h"
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__)
+#include <csignal>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#if defined(__linux__)
+
+// Longest request line accepted; a client sending more without a newline is disconnected.
+static constexpr size_t MAX_REQUEST_BYTES = 64 * 1024;
+
+// Per-connection limits: stop reading while this much input is waiting, and stop
+// handling requests while this much output has not been sent yet (backpressure).
+static constexpr size_t MAX_PENDING_INPUT = 4 << 20;
+static constexpr size_t MAX_PENDING_OUTPUT = 4 << 20;
+
+static constexpr size_t READ_CHUNK = 64 * 1024;
+
+static constexpr const char* HELP_LINES[] = {
+    "h                              list the supported requests",
+    "i <file>                       load a file on the server's disk",
+    "n <description>|<cost>|<units> create an item",
+    "a <item#> <qty>                add parts",
+    "r <item#> <qty>                remove parts",
+    "k <a|r> <item#> <qty>; ...     pick list: apply every line or none",
+    "p [first [count]] [options]    list items as item#|description|cost|units (by <key> [desc], filter)",
+    "t                              stock statistics as name value lines",
+    "o <file>                       write the inventory to a file on the server",
+};
+
+// Signalled (eventfd) by SIGINT/SIGTERM; every worker watches it.
+static int shutdownFd = -1;
+
+static void requestShutdown(int /*signal*/) {
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t ignored = write(shutdownFd, &one, sizeof(one));
+}
+
+namespace {
+struct Connection {
+    int fd = -1;
+    string input;
+    string output;
+    size_t written = 0;          // Bytes of output already sent
+    bool closing = false;        // Close once the output has been sent
+    uint32_t events = 0;         // Events currently registered with epoll
+};
+
+struct ServerCounters {
+    atomic<uint64_t> requests{0};
+    atomic<uint64_t> connections{0};
+};
+}
+
+static void appendNumber(string& out, const long long value) {
+    char digits[24];
+    out.append(digits, static_cast<size_t>(to_chars(digits, digits + sizeof(digits), value).ptr - digits));
+}
+
+static void appendCost(string& out, const Money cost) {
+    char digits[MONEY_CHARS];
+    out.append(digits, formatMoney(digits, cost));
+}
+
+/*
+ * listItems function definition:
+ *  - "p [first [count]] [by key [desc]] [filter]", parsed as for the console 'p'.
+ *  - Header "OK <lines> <rows>" (rows = items passing the filter), then one
+ *    item#|description|cost|units line per row.
+ */
+static void listItems(const string_view args, const InventoryStore& inventory, string& out) {
+    ReportRequest request;
+    const char* reason = nullptr;
+    if (!parseReportRequest(args, request, reason)) {
+        out += "ERR ";
+        out += reason;
+        out += '\n';
+        return;
+    }
+    if (!request.outputFile.empty()) {
+        out += "ERR output files are not available over the network\n";
+        return;
+    }
+
+    ReportView view(inventory, request);
+    const size_t first = min(request.first, view.size());
+    const size_t count = min(request.count, view.size() - first);
+    out += "OK ";
+    appendNumber(out, static_cast<long long>(count));
+    out += ' ';
+    appendNumber(out, static_cast<long long>(view.size()));
+    out += '\n';
+
+    int rowItems[1024];
+    for (size_t row = first; row < first + count;) {
+        const size_t read = view.read(row, min(size(rowItems), first + count - row), rowItems);
+        for (size_t i = 0; i < read; ++i) {
+            const int itemNum = rowItems[i];
+            appendNumber(out, itemNum);
+            out += '|';
+            out += inventory.getDescription(itemNum);
+            out += '|';
+            appendCost(out, inventory.getCost(itemNum));
+            out += '|';
+            appendNumber(out, inventory.getUnits(itemNum));
+            out += '\n';
+        }
+        row += read;
+    }
+}
+
+// "t": the running figures from StockStats, one "name value" line each.
+static void listStockFigures(const InventoryStore& inventory, string& out) {
+    StockFigures figures;
+    if (!currentStockFigures(figures)) {
+        out += "ERR statistics are not available\n";
+        return;
+    }
+    out += "OK 8 ";
+    appendNumber(out, inventory.size());
+    out += "\nitems ";
+    appendNumber(out, figures.items);
+    out += "\nunits ";
+    appendNumber(out, figures.units);
+    out += "\nvalue ";
+    appendCost(out, figures.value);
+    out += "\nout_of_stock ";
+    appendNumber(out, figures.outOfStock);
+    out += "\nreorder ";
+    appendNumber(out, figures.atOrBelowReorder);
+    out += "\nreorder_threshold ";
+    appendNumber(out, figures.reorderThreshold);
+    out += "\nnear_cap ";
+    appendNumber(out, figures.nearCap);
+    out += "\nalerts_raised ";
+    appendNumber(out, static_cast<long long>(figures.alertsRaised));
+    out += '\n';
+}
+
+/*
+ * handleRequest function definition:
+ *  - Answers h, p, t and k itself and passes everything else to applyTransaction.
+ *  - Appends exactly one response (nothing for blank lines and comments).
+ *  - Returns true if the request changed the inventory.
+ */
+static bool handleRequest(string_view line, InventoryStore& inventory, string& out) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) line.remove_prefix(1);
+    if (line.empty() || line.front() == '#') {
+        return false;
+    }
+
+    const char op = static_cast<char>(tolower(static_cast<unsigned char>(line.front())));
+    if (op == 'h' && line.find_first_not_of(" \t", 1) == string_view::npos) {
+        out += "OK ";
+        appendNumber(out, static_cast<long long>(size(HELP_LINES)));
+        out += ' ';
+        appendNumber(out, inventory.size());
+        out += '\n';
+        for (const char* help : HELP_LINES) {
+            out += help;
+            out += '\n';
+        }
+        return false;
+    }
+    if (op == 't' && line.find_first_not_of(" \t", 1) == string_view::npos) {
+        listStockFigures(inventory, out);
+        return false;
+    }
+    if (op == 'p' && (line.size() == 1 || line[1] == ' ' || line[1] == '\t')) {
+        listItems(line.substr(1), inventory, out);
+        return false;
+    }
+    if (op == 'k' && (line.size() == 1 || line[1] == ' ' || line[1] == '\t')) {
+        const PickListResult picked = applyPickList(line.substr(1), inventory);
+        if (!picked.applied) {
+            out += "ERR line ";
+            appendNumber(out, static_cast<long long>(picked.failedLine));
+            out += ": ";
+            out += picked.reason;
+            out += '\n';
+            return false;
+        }
+        out += "OK ";
+        appendNumber(out, static_cast<long long>(picked.lines));
+        out += ' ';
+        appendNumber(out, picked.unitsAdded);
+        out += ' ';
+        appendNumber(out, picked.unitsRemoved);
+        out += '\n';
+        return true;
+    }
+
+    const TransactionResult result = applyTransaction(line, inventory);
+    if (result.status != TransactionResult::Status::Applied) {
+        out += "ERR ";
+        out += result.reason != nullptr ? result.reason : "unknown transaction";
+        out += '\n';
+        return false;
+    }
+
+    out += "OK";
+    if (result.op == 'a' || result.op == 'r' || result.op == 'n') {
+        out += ' ';
+        appendNumber(out, result.itemNum);
+        out += ' ';
+        appendNumber(out, result.units);
+    } else if (result.op == 'i') {
+        out += ' ';
+        appendNumber(out, static_cast<long long>(result.records));
+    }
+    out += '\n';
+    return result.op != 'o' && result.op != 's';
+}
+
+/*
+ * handleRequests function definition:
+ *  - Answers every complete line received so far, unless too much output is
+ *    already waiting for the client.
+ *  - Commits the journal once for the whole batch before any response is sent.
+ */
+static void handleRequests(Connection& connection, InventoryStore& inventory, ServerCounters& counters) {
+    size_t position = 0;
+    bool changed = false;
+    uint64_t handled = 0;
+    while (connection.output.size() - connection.written < MAX_PENDING_OUTPUT) {
+        const size_t newline = connection.input.find('\n', position);
+        if (newline == string::npos) {
+            break;
+        }
+        changed |= handleRequest(string_view(connection.input).substr(position, newline - position), inventory,
+                                 connection.output);
+        position = newline + 1;
+        ++handled;
+    }
+    connection.input.erase(0, position);
+    counters.requests.fetch_add(handled, memory_order_relaxed);
+
+    if (connection.input.size() > MAX_REQUEST_BYTES && connection.input.find('\n') == string::npos) {
+        connection.output += "ERR request too long\n";
+        connection.input.clear();
+        connection.closing = true;
+    }
+    if (changed && !syncJournal()) {
+        cerr << "Error: Could not write to the journal.\n";
+    }
+}
+
+// Sends as much pending output as the socket accepts. Returns false on a socket error.
+static bool flushOutput(Connection& connection) {
+    while (connection.written < connection.output.size()) {
+        const ssize_t count = send(connection.fd, connection.output.data() + connection.written,
+                                   connection.output.size() - connection.written, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection.written += static_cast<size_t>(count);
+    }
+    connection.output.clear();
+    connection.written = 0;
+    return true;
+}
+
+// Reads everything available. Returns false once the client has closed its side.
+static bool readInput(Connection& connection) {
+    while (connection.input.size() < MAX_PENDING_INPUT) {
+        const size_t used = connection.input.size();
+        connection.input.resize(used + READ_CHUNK);
+        const ssize_t count = recv(connection.fd, connection.input.data() + used, READ_CHUNK, 0);
+        connection.input.resize(used + (count > 0 ? static_cast<size_t>(count) : 0));
+        if (count > 0) continue;
+        if (count == 0) return false;
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    return true;
+}
+
+// Registers interest in reading while input has room and in writing while output is pending.
+static void updateInterest(const int epoll, Connection& connection) {
+    uint32_t events = EPOLLRDHUP;
+    if (!connection.closing && connection.input.size() < MAX_PENDING_INPUT) events |= EPOLLIN;
+    if (connection.written < connection.output.size()) events |= EPOLLOUT;
+    if (events != connection.events) {
+        epoll_event change{};
+        change.events = events;
+        change.data.fd = connection.fd;
+        epoll_ctl(epoll, EPOLL_CTL_MOD, connection.fd, &change);
+        connection.events = events;
+    }
+}
+
+/*
+ * serveConnections function definition:
+ *  - One worker's event loop: accepts new clients (the listening socket is shared,
+ *    EPOLLEXCLUSIVE wakes a single worker per connection attempt) and serves the
+ *    connections it accepted until the shutdown event fires.
+ */
+static void serveConnections(const int listenFd, const bool tcp, InventoryStore& inventory, ServerCounters& counters) {
+    const int epoll = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event watch{};
+    watch.events = EPOLLIN | EPOLLEXCLUSIVE;
+    watch.data.fd = listenFd;
+    epoll_ctl(epoll, EPOLL_CTL_ADD, listenFd, &watch);
+    watch.events = EPOLLIN;
+    watch.data.fd = shutdownFd;
+    epoll_ctl(epoll, EPOLL_CTL_ADD, shutdownFd, &watch);
+
+    unordered_map<int, Connection> connections;
+    epoll_event events[64];
+    bool running = true;
+    while (running) {
+        const int ready = epoll_wait(epoll, events, static_cast<int>(size(events)), -1);
+        if (ready < 0 && errno != EINTR) break;
+
+        for (int e = 0; e < ready; ++e) {
+            const int fd = events[e].data.fd;
+            if (fd == shutdownFd) {
+                running = false;
+                break;
+            }
+
+            if (fd == listenFd) {
+                for (int client; (client = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0;) {
+                    if (tcp) {
+                        const int on = 1;
+                        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                    }
+                    Connection& connection = connections[client];
+                    connection.fd = client;
+                    connection.events = EPOLLIN | EPOLLRDHUP;
+                    epoll_event add{};
+                    add.events = connection.events;
+                    add.data.fd = client;
+                    epoll_ctl(epoll, EPOLL_CTL_ADD, client, &add);
+                    counters.connections.fetch_add(1, memory_order_relaxed);
+                }
+                continue;
+            }
+
+            const auto found = connections.find(fd);
+            if (found == connections.end()) continue;
+            Connection& connection = found->second;
+
+            bool open = !(events[e].events & EPOLLERR);
+            if (open && (events[e].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+                if (!readInput(connection)) connection.closing = true;
+            }
+            if (open) {
+                handleRequests(connection, inventory, counters);
+                open = flushOutput(connection);
+                // Requests held back by backpressure can go now that output drained
+                if (open && !connection.input.empty() && connection.output.empty()) {
+                    handleRequests(connection, inventory, counters);
+                    open = flushOutput(connection);
+                }
+            }
+            const bool finished = connection.closing && connection.written == connection.output.size();
+            if (!open || finished) {
+                close(fd);
+                connections.erase(found);
+                continue;
+            }
+            updateInterest(epoll, connection);
+        }
+    }
+
+    for (auto& [fd, connection] : connections) {
+        flushOutput(connection);
+        close(fd);
+    }
+    close(epoll);
+}
+
+/*
+ * openListener function definition:
+ *  - "unix:/path" creates a Unix socket (replacing a stale socket file);
+ *    anything else is "[host:]port" over TCP, host 127.0.0.1 by default.
+ *  - The socket is non-blocking and close-on-exec.
+ */
+int openListener(const string& address, bool& tcp, string& error) {
+    tcp = address.rfind("unix:", 0) != 0;
+    if (!tcp) {
+        const string path = address.substr(5);
+        sockaddr_un local{};
+        if (path.empty() || path.size() >= sizeof(local.sun_path)) {
+            error = "invalid socket path";
+            return -1;
+        }
+        local.sun_family = AF_UNIX;
+        memcpy(local.sun_path, path.c_str(), path.size() + 1);
+        unlink(path.c_str());
+        const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0 || listen(fd, SOMAXCONN) != 0) {
+            error = strerror(errno);
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    const size_t colon = address.rfind(':');
+    const string host = colon == string::npos ? "127.0.0.1" : address.substr(0, colon);
+    const string port = colon == string::npos ? address : address.substr(colon + 1);
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* found = nullptr;
+    if (const int status = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &found); status != 0) {
+        error = gai_strerror(status);
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* candidate = found; candidate != nullptr && fd < 0; candidate = candidate->ai_next) {
+        fd = socket(candidate->ai_family, candidate->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, candidate->ai_protocol);
+        if (fd < 0) continue;
+        const int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        if (bind(fd, candidate->ai_addr, candidate->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0) {
+            error = strerror(errno);
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    return fd;
+}
+
+/*
+ * runServer function definition:
+ *  - Opens the listening socket, starts the worker threads (the calling thread is
+ *    one of them) and waits for SIGINT/SIGTERM.
+ */
+bool runServer(const ServerOptions& options, InventoryStore& inventory) {
+    bool tcp = true;
+    string error;
+    const int listenFd = openListener(options.address, tcp, error);
+    if (listenFd < 0) {
+        cout << "Error: Could not listen on \"" << options.address << "\": " << error << ".\n";
+        return false;
+    }
+
+    shutdownFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    struct sigaction stop{};
+    stop.sa_handler = requestShutdown;
+    struct sigaction oldInterrupt{};
+    struct sigaction oldTerminate{};
+    sigaction(SIGINT, &stop, &oldInterrupt);
+    sigaction(SIGTERM, &stop, &oldTerminate);
+
+    const unsigned threads = options.threads == 0 ? defaultWorkerCount() : options.threads;
+    cout << "Serving " << inventory.size() << " item(s) on " << options.address << " with " << threads
+         << " thread(s). Press Ctrl+C to stop.\n" << flush;
+
+    ServerCounters counters;
+    vector<thread> workers;
+    for (unsigned t = 1; t < threads; ++t) {
+        workers.emplace_back(serveConnections, listenFd, tcp, ref(inventory), ref(counters));
+    }
+    serveConnections(listenFd, tcp, inventory, counters);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    sigaction(SIGINT, &oldInterrupt, nullptr);
+    sigaction(SIGTERM, &oldTerminate, nullptr);
+    close(listenFd);
+    close(shutdownFd);
+    shutdownFd = -1;
+    if (!tcp) {
+        unlink(options.address.substr(5).c_str());
+    }
+
+    cout << "Server stopped after " << counters.requests.load() << " request(s) from "
+         << counters.connections.load() << " connection(s).\n";
+    return true;
+}
+
+#else
+
+bool runServer(const ServerOptions& options, InventoryStore& /*inventory*/) {
+    cout << "Error: Server mode (" << options.address << ") requires Linux.\n";
+    return false;
+}
+
+int openListener(const string& /*address*/, bool& tcp, string& error) {
+    tcp = false;
+    error = "sockets require Linux";
+    return -1;
+}
+
+#endif
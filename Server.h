@@ -0,0 +1,71 @@
+// Specification File -> Server.h
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include "InventoryStore.h"
+
+using namespace std;
+
+/*
+    Server Mode
+    -----------------------------
+    Description:
+    Serves one shared inventory to many remote terminals and scanners. Clients
+    connect over TCP ("[host:]port", default host 127.0.0.1) or a Unix socket
+    ("unix:/path/to/socket") and send one request per line. Requests use the
+    batch transaction syntax (see BatchMode.h) plus two read-only requests:
+
+        h                              list the supported requests
+        i <file>                       load a file on the server's disk
+        n <description>|<cost>|<units> create an item
+        a <item#> <qty>                add parts
+        r <item#> <qty>                remove parts
+        k <a|r> <item#> <qty>; ...     pick list: every line applies or none does
+                                       (lines separated by ';', see BatchMode.h)
+        p [first [count]] [options]    list items (all, or count items from first),
+                                       optionally "by cost|units|description [desc]"
+                                       and/or filtered as for 'f' (see Report.h)
+        t                              stock statistics (see StockStats.h)
+        o <file>                       write the inventory to a file on the server
+
+    Every request gets exactly one response, in request order:
+
+        OK [values]                    a/r: "OK <item#> <units>", n: "OK <item#> <units>",
+                                       i: "OK <records loaded>", o: "OK",
+                                       k: "OK <lines> <units added> <units removed>"
+        OK <lines> <total items>       h/p/t: followed by <lines> lines of text
+                                       (p lines are item#|description|cost|units and
+                                       the total counts the items passing the filter,
+                                       t lines are "name value")
+        ERR <reason>                   (k: "ERR line <n>: <reason>", nothing changed)
+
+    Blank lines and '#' comments get no response. Clients may pipeline: send many
+    requests without waiting. The server handles every complete request it has
+    received, then sends all their responses with one write call. Polling "t" is
+    cheap at any inventory size, so dashboards can ask every second. With a journal
+    (--journal), the changes of a batch are committed before its responses go out,
+    so an "OK" is never lost in a crash.
+
+    Each worker thread runs its own epoll loop; connections are spread over the
+    workers and all of them share the thread-safe InventoryStore. Requires Linux.
+
+    In Simpler Terms:
+    Lets many devices use the same inventory at once over the network, using the
+    same short commands as the console.
+*/
+
+struct ServerOptions {
+    string address;        // "[host:]port" or "unix:/path"
+    unsigned threads = 1;  // Worker threads (0 = one per hardware thread)
+};
+
+// Serves requests until SIGINT or SIGTERM. Returns false if the server could not start.
+bool runServer(const ServerOptions& options, InventoryStore& inventory);
+
+// Opens a listening socket for an address as --serve takes it; sets tcp to false
+// for "unix:/path". Returns the descriptor, or -1 with error set. Linux only (also
+// used by the change feed, see ChangeFeed.h).
+int openListener(const string& address, bool& tcp, string& error);
+
+#endif // SERVER_H
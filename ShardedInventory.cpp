@@ -0,0 +1,226 @@
+// Implementation File -> ShardedInventory.cpp
+#include "ShardedInventory.h"
+#include "BulkLoader.h"
+#include "ColumnKernels.h"
+#include "ParallelFor.h"
+#include "ParallelIngest.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+int ShardedInventory::addShard(const string_view name) {
+    if (name.empty() || name.find(':') != string_view::npos) {
+        return -1;
+    }
+    if (const int existing = findShard(name); existing >= 0) {
+        return existing;
+    }
+    shards.push_back(make_unique<Shard>(name));
+    return shardCount() - 1;
+}
+
+int ShardedInventory::findShard(const string_view name) const {
+    for (int shard = 0; shard < shardCount(); ++shard) {
+        if (shards[shard]->name == name) return shard;
+    }
+    return -1;
+}
+
+size_t ShardedInventory::totalItems() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        total += static_cast<size_t>(shard->store.size());
+    }
+    return total;
+}
+
+/*
+ * parseItemId function definition:
+ *  - Splits at the last ':' so the warehouse part is looked up by name first and
+ *    only then read as a shard number.
+ */
+bool ShardedInventory::parseItemId(string_view text, ItemId& id, const char*& reason) const {
+    while (!text.empty() && isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+    while (!text.empty() && isspace(static_cast<unsigned char>(text.back()))) text.remove_suffix(1);
+
+    const size_t colon = text.rfind(':');
+    if (colon == string_view::npos) {
+        reason = "an item is written warehouse:number, e.g. plumbing:3";
+        return false;
+    }
+    const string_view warehouse = text.substr(0, colon);
+    const string_view number = text.substr(colon + 1);
+
+    id.shard = findShard(warehouse);
+    if (id.shard < 0) {
+        int shard = -1;
+        const auto [last, error] = from_chars(warehouse.data(), warehouse.data() + warehouse.size(), shard);
+        if (error != errc() || last != warehouse.data() + warehouse.size() || shard < 0 || shard >= shardCount()) {
+            reason = "no such warehouse";
+            return false;
+        }
+        id.shard = shard;
+    }
+
+    const auto [last, error] = from_chars(number.data(), number.data() + number.size(), id.index);
+    if (error != errc() || last != number.data() + number.size() || !store(id.shard).contains(id.index)) {
+        reason = "invalid item number";
+        return false;
+    }
+    return true;
+}
+
+string ShardedInventory::formatItemId(const ItemId id) const {
+    return shardName(id.shard) + ":" + to_string(id.index);
+}
+
+StockResult ShardedInventory::addUnits(const ItemId id, const int quantity, int* unitsAfter) {
+    return store(id.shard).addUnits(id.index, quantity, unitsAfter);
+}
+
+StockResult ShardedInventory::removeUnits(const ItemId id, const int quantity, int* unitsAfter) {
+    return store(id.shard).removeUnits(id.index, quantity, unitsAfter);
+}
+
+/*
+ * valuation function definition:
+ *  - Each task scans one shard's columns and writes only its own slot; the slots
+ *    are added up afterwards in shard order.
+ */
+vector<ShardValuation> ShardedInventory::valuation(const int lowStockThreshold, ShardValuation& total,
+                                                   const unsigned workers) const {
+    vector<ShardValuation> results(shards.size());
+    parallelFor(shards.size(), [&](const size_t shard) {
+        const InventoryStore& inventory = shards[shard]->store;
+        ShardValuation& result = results[shard];
+        result.items = static_cast<size_t>(inventory.size());
+        result.totalUnits = totalUnits(inventory);
+        result.stockValue = totalStockValue(inventory);
+        const CostRange range = minMaxCost(inventory);
+        result.minCost = range.minimum;
+        result.maxCost = range.maximum;
+        result.lowStock = countUnitsAtMost(inventory, lowStockThreshold);
+    }, workers);
+
+    total = ShardValuation();
+    bool anyItems = false;
+    for (const ShardValuation& result : results) {
+        if (result.items == 0) continue;
+        total.minCost = anyItems ? min(total.minCost, result.minCost) : result.minCost;
+        total.maxCost = anyItems ? max(total.maxCost, result.maxCost) : result.maxCost;
+        anyItems = true;
+        total.items += result.items;
+        total.totalUnits += result.totalUnits;
+        total.stockValue += result.stockValue;
+        total.lowStock += result.lowStock;
+    }
+    return results;
+}
+
+vector<ItemId> ShardedInventory::lowStock(const int threshold, const unsigned workers) const {
+    vector<vector<int>> selected(shards.size());
+    parallelFor(shards.size(), [&](const size_t shard) {
+        selectUnitsAtMost(shards[shard]->store, threshold, selected[shard]);
+    }, workers);
+
+    size_t count = 0;
+    for (const vector<int>& items : selected) count += items.size();
+    vector<ItemId> items;
+    items.reserve(count);
+    for (size_t shard = 0; shard < selected.size(); ++shard) {
+        for (const int index : selected[shard]) {
+            items.push_back({static_cast<int>(shard), index});
+        }
+    }
+    return items;
+}
+
+/*
+ * loadWarehouses function definition:
+ *  - Resolves every file to its warehouse first (this adds the shards, on the
+ *    calling thread), then runs one task per warehouse with its files in order.
+ */
+WarehouseLoadSummary loadWarehouses(const vector<string>& specs, ShardedInventory& inventory, const unsigned workers) {
+    const auto start = chrono::steady_clock::now();
+    WarehouseLoadSummary summary;
+
+    for (const string& spec : specs) {
+        if (const size_t equals = spec.find('='); equals != string::npos) {
+            WarehouseFileResult file;
+            file.warehouse = spec.substr(0, equals);
+            file.filename = spec.substr(equals + 1);
+            summary.files.push_back(move(file));
+            continue;
+        }
+        for (const string& filename : expandFilePatterns({spec})) {
+            WarehouseFileResult file;
+            file.filename = filename;
+            file.warehouse = filesystem::path(filename).stem().string();
+            summary.files.push_back(move(file));
+        }
+    }
+
+    vector<vector<size_t>> filesOfShard;
+    for (size_t f = 0; f < summary.files.size(); ++f) {
+        const int shard = inventory.addShard(summary.files[f].warehouse);
+        if (shard < 0) {
+            summary.files[f].error = "a warehouse name must not be empty or contain ':'";
+            continue;
+        }
+        if (static_cast<size_t>(shard) >= filesOfShard.size()) filesOfShard.resize(static_cast<size_t>(shard) + 1);
+        filesOfShard[static_cast<size_t>(shard)].push_back(f);
+    }
+
+    vector<size_t> bytes(summary.files.size(), 0);
+    summary.workers = static_cast<unsigned>(min<size_t>(workers == 0 ? defaultWorkerCount() : workers,
+                                                        max<size_t>(filesOfShard.size(), 1)));
+    parallelFor(filesOfShard.size(), [&](const size_t shard) {
+        for (const size_t f : filesOfShard[shard]) {
+            WarehouseFileResult& file = summary.files[f];
+            BulkLoadStats stats;
+            file.opened = bulkLoadFile(file.filename, inventory.store(static_cast<int>(shard)), stats);
+            file.error = stats.formatError;
+            file.recordsLoaded = stats.recordsLoaded;
+            file.recordsRejected = stats.recordsRejected;
+            bytes[f] = stats.bytesScanned;
+        }
+    }, summary.workers);
+
+    for (size_t f = 0; f < summary.files.size(); ++f) {
+        summary.recordsLoaded += summary.files[f].recordsLoaded;
+        summary.recordsRejected += summary.files[f].recordsRejected;
+        summary.bytes += bytes[f];
+    }
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return summary;
+}
+
+void printWarehouseLoadSummary(const WarehouseLoadSummary& summary) {
+    for (const WarehouseFileResult& file : summary.files) {
+        if (file.error != nullptr) {
+            cout << "Error: \"" << file.filename << "\": " << file.error << ".\n";
+            continue;
+        }
+        if (!file.opened) {
+            cout << "Error: Could not open file \"" << file.filename << "\".\n";
+            continue;
+        }
+        cout << "  " << file.filename << " -> " << file.warehouse << ": " << file.recordsLoaded << " record(s)";
+        if (file.recordsRejected > 0) {
+            cout << ", " << file.recordsRejected << " skipped";
+        }
+        cout << '\n';
+    }
+
+    const double megabytes = static_cast<double>(summary.bytes) / (1024.0 * 1024.0);
+    cout << summary.recordsLoaded << " record(s) loaded from " << summary.files.size() << " file(s) using "
+         << summary.workers << " thread(s).\n"
+         << fixed << setprecision(2) << "Scanned " << summary.bytes << " bytes in " << summary.seconds * 1000.0
+         << " ms (" << (summary.seconds > 0.0 ? megabytes / summary.seconds : 0.0) << " MB/s).\n";
+}
@@ -0,0 +1,140 @@
+// Specification File -> ShardedInventory.h
+#ifndef SHARDEDINVENTORY_H
+#define SHARDEDINVENTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "InventoryStore.h"
+
+using namespace std;
+
+// An item of a sharded inventory: its warehouse (shard number) and its item
+// number within that warehouse. Written "electrical:3" (or "0:3").
+struct ItemId {
+    int shard = -1;
+    int index = -1;
+};
+
+// Stock figures of one warehouse, or of all of them added up.
+struct ShardValuation {
+    size_t items = 0;
+    int64_t totalUnits = 0;
+    Money stockValue;
+    Money minCost;
+    Money maxCost;
+    size_t lowStock = 0;        // Items at or below the threshold asked for
+};
+
+/*
+    ShardedInventory
+    -----------------------------
+    Description:
+    An inventory split into shards, one per warehouse (or category), each with
+    an InventoryStore of its own: its own columns, structure lock, update
+    stripes and description index. Item numbers start at 0 in every shard, so
+    the category files keep the numbers they were written with, and an item is
+    named by the pair (shard, index).
+
+    A stock change only touches its own shard's store, so changes in different
+    warehouses never wait for each other or share a cache line. Queries over
+    every warehouse (valuation, low stock) run one task per shard in parallel
+    with the ColumnKernels scans, and the per-shard results are combined in
+    shard order, so the answer does not depend on which thread finished first.
+
+    Shards are added before the inventory is shared between threads (at load
+    time, or by a console command); their stores are then used like any other.
+
+    In Simpler Terms:
+    One inventory per warehouse, kept side by side, with questions about all
+    of them answered by asking every warehouse at once.
+*/
+class ShardedInventory {
+public:
+    ShardedInventory() = default;
+    ShardedInventory(const ShardedInventory&) = delete;
+    ShardedInventory& operator=(const ShardedInventory&) = delete;
+
+    // Returns the shard with this name, adding an empty one if there is none,
+    // or -1 if the name is empty or contains ':' (which separates an ItemId).
+    int addShard(string_view name);
+
+    // Shard number of a name, or -1.
+    int findShard(string_view name) const;
+
+    int shardCount() const { return static_cast<int>(shards.size()); }
+    const string& shardName(int shard) const { return shards[shard]->name; }
+    InventoryStore& store(int shard) { return shards[shard]->store; }
+    const InventoryStore& store(int shard) const { return shards[shard]->store; }
+
+    // Items in all shards together.
+    size_t totalItems() const;
+
+    // Reads "warehouse:index" (the warehouse by name or number). Returns false
+    // with reason set if either part is malformed or names nothing stored.
+    bool parseItemId(string_view text, ItemId& id, const char*& reason) const;
+    string formatItemId(ItemId id) const;
+
+    // Validated stock changes on one item, as InventoryStore::addUnits/removeUnits.
+    StockResult addUnits(ItemId id, int quantity, int* unitsAfter = nullptr);
+    StockResult removeUnits(ItemId id, int quantity, int* unitsAfter = nullptr);
+
+    // Figures per shard (in shard order), computed in parallel; total receives
+    // their sum (cost range over every item).
+    vector<ShardValuation> valuation(int lowStockThreshold, ShardValuation& total, unsigned workers = 0) const;
+
+    // Every item with at most threshold units, by shard and then item number,
+    // collected from the shards in parallel.
+    vector<ItemId> lowStock(int threshold, unsigned workers = 0) const;
+
+private:
+    struct Shard {
+        explicit Shard(string_view name) : name(name) {}
+        string name;
+        InventoryStore store;
+    };
+
+    vector<unique_ptr<Shard>> shards; // Each shard on its own allocation
+};
+
+// What loadWarehouses did with one file.
+struct WarehouseFileResult {
+    string filename;
+    string warehouse;
+    bool opened = false;
+    const char* error = nullptr;     // Why a snapshot was rejected, if it was
+    size_t recordsLoaded = 0;
+    size_t recordsRejected = 0;
+};
+
+// What loadWarehouses did.
+struct WarehouseLoadSummary {
+    vector<WarehouseFileResult> files;   // In the order given
+    size_t recordsLoaded = 0;
+    size_t recordsRejected = 0;
+    size_t bytes = 0;
+    unsigned workers = 0;
+    double seconds = 0.0;
+};
+
+/*
+    loadWarehouses
+    -----------------------------
+    Description:
+    Loads inventory files into the shards named after them: "electrical.txt"
+    goes to warehouse "electrical", and "east=stock/east.txt" to "east".
+    Wildcards ("*.txt") are expanded as for --load, one warehouse per file. Each
+    warehouse's files are read in the order given by one task, and the tasks
+    of different warehouses run in parallel through the bulk loader; they
+    write to different stores, so they never wait for each other. Snapshots
+    ('s') are recognised as with 'b'.
+*/
+WarehouseLoadSummary loadWarehouses(const vector<string>& specs, ShardedInventory& inventory, unsigned workers = 0);
+
+// Prints one line per file and a total.
+void printWarehouseLoadSummary(const WarehouseLoadSummary& summary);
+
+#endif // SHARDEDINVENTORY_H
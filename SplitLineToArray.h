@@ -3,11 +3,12 @@
 #define SPLITLINETOARRAY_H
 
 #include <string>
+#include <string_view>
 using namespace std;
 
 // Splits a line using a delimiter into a string array.
 // Returns number of fields extracted.
-int splitLineToArray(const string& line, const string& delimiter, string fields[], int maxFields) {
+inline int splitLineToArray(const string& line, const string& delimiter, string fields[], int maxFields) {
     size_t start = 0;
     size_t end;
     int count = 0;
@@ -24,4 +25,23 @@ int splitLineToArray(const string& line, const string& delimiter, string fields[
     return count;
 }
 
+// Same splitting rules as splitLineToArray, but the fields are views into line,
+// so nothing is allocated. The views are valid as long as line is.
+inline int splitLineToViews(string_view line, char delimiter, string_view fields[], int maxFields) {
+    size_t start = 0;
+    size_t end;
+    int count = 0;
+
+    while ((end = line.find(delimiter, start)) != string_view::npos && count < maxFields) {
+        fields[count++] = line.substr(start, end - start);
+        start = end + 1;
+    }
+
+    if (count < maxFields) {
+        fields[count++] = line.substr(start);
+    }
+
+    return count;
+}
+
 #endif
@@ -0,0 +1,171 @@
+// Implementation File -> StockStats.cpp
+#include "StockStats.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+/*
+ * StockStats constructor definition:
+ *  - Counts the items already stored (one pass), then attaches as an observer.
+ *    Must run before other threads start changing the store.
+ */
+StockStats::StockStats(InventoryStore& store, const int reorderThreshold)
+    : store(store), reorderThreshold(reorderThreshold) {
+    onItemsAdded(store, 0, store.size());
+    store.addObserver(this);
+}
+
+StockStats::~StockStats() {
+    store.removeObserver(this);
+}
+
+void StockStats::countLevel(const int unitCount, const int change) {
+    if (unitCount >= 0 && unitCount <= MAX_UNITS) {
+        itemsByUnits[static_cast<size_t>(unitCount)].fetch_add(change, memory_order_relaxed);
+    } else {
+        itemsOutOfRange.fetch_add(change, memory_order_relaxed);
+    }
+}
+
+/*
+ * onItemsAdded function definition:
+ *  - Sums the new items locally and publishes the totals with one atomic add
+ *    each, so a bulk load of a million items costs one pass and a few atomics.
+ */
+void StockStats::onItemsAdded(const InventoryStore& inventory, const int firstItem, const int count) {
+    array<int, MAX_UNITS + 1> levels{};
+    int outOfRange = 0;
+    long long addedUnits = 0;
+    int64_t addedCents = 0;
+    for (int item = firstItem; item < firstItem + count; ++item) {
+        const int itemUnits = inventory.getUnits(item);
+        addedUnits += itemUnits;
+        addedCents += inventory.getCost(item).cents * itemUnits;
+        if (itemUnits >= 0 && itemUnits <= MAX_UNITS) {
+            ++levels[static_cast<size_t>(itemUnits)];
+        } else {
+            ++outOfRange;
+        }
+    }
+
+    for (size_t level = 0; level < levels.size(); ++level) {
+        if (levels[level] != 0) itemsByUnits[level].fetch_add(levels[level], memory_order_relaxed);
+    }
+    if (outOfRange != 0) itemsOutOfRange.fetch_add(outOfRange, memory_order_relaxed);
+    units.fetch_add(addedUnits, memory_order_relaxed);
+    valueCents.fetch_add(addedCents, memory_order_relaxed);
+    items.fetch_add(count, memory_order_relaxed);
+}
+
+/*
+ * onUnitsChanged function definition:
+ *  - O(1): moves the item between two unit levels and adjusts units and value.
+ *  - Queues an alert when the change crosses the reorder threshold downwards.
+ */
+void StockStats::onUnitsChanged(const InventoryStore& inventory, const int itemNum, const int oldUnits,
+                                const int newUnits) {
+    countLevel(oldUnits, -1);
+    countLevel(newUnits, +1);
+    units.fetch_add(newUnits - oldUnits, memory_order_relaxed);
+    valueCents.fetch_add(inventory.getCost(itemNum).cents * (newUnits - oldUnits), memory_order_relaxed);
+
+    if (oldUnits > reorderThreshold && newUnits <= reorderThreshold) {
+        alertsRaised.fetch_add(1, memory_order_relaxed);
+        lock_guard lock(alertMutex);
+        if (alerts.size() == MAX_PENDING_ALERTS) {
+            alerts.pop_front();
+        }
+        alerts.push_back({itemNum, oldUnits, newUnits});
+    }
+}
+
+int StockStats::countWithUnits(const int low, const int high) const {
+    int count = 0;
+    for (int level = max(low, 0); level <= min(high, MAX_UNITS); ++level) {
+        count += itemsByUnits[static_cast<size_t>(level)].load(memory_order_relaxed);
+    }
+    return count;
+}
+
+StockFigures StockStats::snapshot() const {
+    StockFigures figures;
+    figures.items = items.load(memory_order_relaxed);
+    figures.units = units.load(memory_order_relaxed);
+    figures.value = Money::fromCents(valueCents.load(memory_order_relaxed));
+    figures.outOfStock = countWithUnits(0, 0);
+    figures.atOrBelowReorder = countWithUnits(0, reorderThreshold);
+    figures.nearCap = countWithUnits(MAX_UNITS - NEAR_CAP_MARGIN, MAX_UNITS);
+    figures.reorderThreshold = reorderThreshold;
+    figures.alertsRaised = alertsRaised.load(memory_order_relaxed);
+    lock_guard lock(alertMutex);
+    figures.alertsPending = alerts.size();
+    return figures;
+}
+
+vector<StockAlert> StockStats::takeAlerts() {
+    lock_guard lock(alertMutex);
+    vector<StockAlert> taken(alerts.begin(), alerts.end());
+    alerts.clear();
+    return taken;
+}
+
+namespace {
+unique_ptr<StockStats> activeStats;
+}
+
+void startStockStats(InventoryStore& inventory, const int reorderThreshold) {
+    activeStats = make_unique<StockStats>(inventory, reorderThreshold);
+}
+
+/*
+ * printStockStats function definition:
+ *  - 't' command: prints the running figures. No item is read, so this is as
+ *    cheap with ten million items as with ten.
+ */
+void printStockStats() {
+    if (!activeStats) {
+        cout << "Statistics are not available.\n";
+        return;
+    }
+
+    const StockFigures figures = activeStats->snapshot();
+    cout << fixed << setprecision(2)
+         << "Items:               " << figures.items << '\n'
+         << "Total units:         " << figures.units << '\n'
+         << "Total stock value:   " << figures.value << '\n'
+         << "Out of stock:        " << figures.outOfStock << " item(s)\n"
+         << "Reorder (<= " << figures.reorderThreshold << "):      " << figures.atOrBelowReorder << " item(s)\n"
+         << "Near cap (>= " << MAX_UNITS - NEAR_CAP_MARGIN << "):    " << figures.nearCap << " item(s)\n"
+         << "Reorder alerts:      " << figures.alertsRaised << " raised, " << figures.alertsPending
+         << " not yet shown\n";
+}
+
+/*
+ * reportStockAlerts function definition:
+ *  - Called after every command, so an alert shows up right after the 'r'
+ *    (or batch, or file load) that caused it.
+ */
+void reportStockAlerts(const InventoryStore& inventory) {
+    if (!activeStats) {
+        return;
+    }
+    for (const StockAlert& alert : activeStats->takeAlerts()) {
+        cout << "Reorder alert: item #" << alert.itemNum << " (" << inventory.getDescription(alert.itemNum)
+             << ") is down to " << alert.newUnits << " unit(s).\n";
+    }
+}
+
+bool currentStockFigures(StockFigures& figures) {
+    if (!activeStats) {
+        return false;
+    }
+    figures = activeStats->snapshot();
+    return true;
+}
+
+void stopStockStats() {
+    activeStats.reset();
+}
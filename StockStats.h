@@ -0,0 +1,123 @@
+// Specification File -> StockStats.h
+#ifndef STOCKSTATS_H
+#define STOCKSTATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "InventoryStore.h"
+
+using namespace std;
+
+// Default reorder threshold: an alert is raised when an item drops to this many units.
+constexpr int DEFAULT_REORDER_THRESHOLD = 5;
+
+// Items within this many units of MAX_UNITS count as "near the cap".
+constexpr int NEAR_CAP_MARGIN = 5;
+
+// An item whose units dropped from above the reorder threshold to at or below it.
+struct StockAlert {
+    int itemNum = 0;
+    int oldUnits = 0;
+    int newUnits = 0;
+};
+
+// The running figures at one moment (see StockStats::snapshot).
+struct StockFigures {
+    int items = 0;
+    long long units = 0;
+    Money value;                   // Sum of cost * units, exact
+    int outOfStock = 0;            // 0 units
+    int atOrBelowReorder = 0;      // units <= reorder threshold
+    int nearCap = 0;               // units >= MAX_UNITS - NEAR_CAP_MARGIN
+    int reorderThreshold = 0;
+    uint64_t alertsRaised = 0;     // Since the program started
+    size_t alertsPending = 0;      // Raised but not yet taken
+};
+
+/*
+    StockStats
+    -----------------------------
+    Description:
+    Running aggregates over an InventoryStore, so questions like "what is the
+    stock worth" or "how many items are out of stock" are answered without
+    scanning the items. As an InventoryObserver it adjusts a few atomic counters
+    on every change: total units, total value (cost x units) and a count of items
+    per unit level (0 .. MAX_UNITS). Reading the figures costs O(MAX_UNITS) no
+    matter how many items there are. The counters are updated without locks, so
+    a snapshot taken while other threads change stock may mix figures from just
+    before and just after one of those changes.
+
+    It also watches for reorder points: when a change takes an item from above
+    the reorder threshold to at or below it, an alert is queued right away. The
+    queue keeps the latest MAX_PENDING_ALERTS alerts until someone takes them.
+
+    In Simpler Terms:
+    A scoreboard that is updated every time stock moves, plus a bell that rings
+    when something is running low.
+*/
+class StockStats : public InventoryObserver {
+public:
+    static constexpr size_t MAX_PENDING_ALERTS = 1024;
+
+    // Counts the items already in the store, then follows every change.
+    explicit StockStats(InventoryStore& store, int reorderThreshold = DEFAULT_REORDER_THRESHOLD);
+    ~StockStats() override;
+
+    StockStats(const StockStats&) = delete;
+    StockStats& operator=(const StockStats&) = delete;
+
+    StockFigures snapshot() const;
+
+    // Number of items with low <= units <= high (O(MAX_UNITS)).
+    int countWithUnits(int low, int high) const;
+
+    // Removes and returns the queued alerts, oldest first.
+    vector<StockAlert> takeAlerts();
+
+    void onItemsAdded(const InventoryStore& store, int firstItem, int count) override;
+    void onUnitsChanged(const InventoryStore& store, int itemNum, int oldUnits, int newUnits) override;
+
+private:
+    InventoryStore& store;
+    const int reorderThreshold;
+
+    atomic<int> items{0};
+    atomic<long long> units{0};
+    atomic<int64_t> valueCents{0};
+    array<atomic<int>, MAX_UNITS + 1> itemsByUnits{};
+    atomic<int> itemsOutOfRange{0};   // Units outside 0 .. MAX_UNITS (unvalidated loads)
+
+    atomic<uint64_t> alertsRaised{0};
+    mutable mutex alertMutex;
+    deque<StockAlert> alerts;
+
+    void countLevel(int unitCount, int change);
+};
+
+/*
+    Application-level statistics
+    -----------------------------
+    Started by main() right after journal recovery; items already in the store
+    are counted once, and everything loaded or changed later is followed.
+*/
+
+// Starts following the inventory (called once from main).
+void startStockStats(InventoryStore& inventory, int reorderThreshold);
+
+// 't' command handler: prints the running figures.
+void printStockStats();
+
+// Prints and clears the queued reorder alerts (called after each command).
+void reportStockAlerts(const InventoryStore& inventory);
+
+// The running figures, or false when statistics were not started.
+bool currentStockFigures(StockFigures& figures);
+
+// Detaches and frees the statistics (called at exit, before the inventory goes away).
+void stopStockStats();
+
+#endif // STOCKSTATS_H
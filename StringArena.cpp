@@ -0,0 +1,99 @@
+// Implementation File -> StringArena.cpp
+#include "StringArena.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+/*
+ * append function definition:
+ *  - Copies text to the end of the current block.
+ *  - Starts a new block when the current one is full; a string longer than the
+ *    block size gets a block of its own.
+ */
+string_view StringArena::append(const string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+
+    if (blocks.empty() || blocks.back().capacity - blocks.back().length < text.size()) {
+        Block block;
+        block.capacity = max(blockSize, text.size());
+        block.data = make_unique_for_overwrite<char[]>(block.capacity);
+        reserved += block.capacity;
+        blocks.push_back(move(block));
+    }
+
+    Block& block = blocks.back();
+    char* destination = block.data.get() + block.length;
+    memcpy(destination, text.data(), text.size());
+    block.length += text.size();
+    used += text.size();
+    return {destination, text.size()};
+}
+
+/*
+ * intern function definition:
+ *  - Linear probing from the text's hash; stops at the stored copy or at a
+ *    free slot, where a new copy is recorded. Each slot keeps the hash, so a
+ *    mismatch is almost always decided without reading the stored text.
+ *  - Once deduplication is switched off (see grow), the text is simply appended.
+ */
+string_view StringInterner::intern(const string_view text) {
+    if (text.empty()) {
+        return {};
+    }
+    ++lookups;
+    if (deduplicate && (count + 1) * 4 > slots.size() * 3) {
+        grow();
+    }
+    if (!deduplicate) {
+        ++count;
+        return arena.append(text);
+    }
+
+    const size_t textHash = hash<string_view>()(text);
+    const size_t mask = slots.size() - 1;
+    for (size_t slot = textHash & mask;; slot = (slot + 1) & mask) {
+        Slot& entry = slots[slot];
+        if (entry.text == nullptr) {
+            const string_view stored = arena.append(text);
+            entry = {stored.data(), stored.size(), textHash};
+            ++count;
+            return stored;
+        }
+        if (entry.hash == textHash && entry.length == text.size() && memcmp(entry.text, text.data(), text.size()) == 0) {
+            return {entry.text, entry.length};
+        }
+    }
+}
+
+/*
+ * grow function definition:
+ *  - Doubles the table (starting at 1024 slots) and moves every entry using its
+ *    stored hash, so no text is read or hashed again.
+ *  - From DEDUPLICATION_CHECK_SLOTS on, first checks that deduplication pays:
+ *    if fewer than half of the strings seen so far were repeats, the table would
+ *    cost more memory and time than it saves, so it is dropped and later strings
+ *    are only appended. Strings already interned keep their shared copies.
+ */
+void StringInterner::grow() {
+    if (slots.size() >= DEDUPLICATION_CHECK_SLOTS && lookups < count * 2) {
+        deduplicate = false;
+        vector<Slot>().swap(slots);
+        return;
+    }
+
+    vector<Slot> previous(max<size_t>(1024, slots.size() * 2));
+    previous.swap(slots);
+
+    const size_t mask = slots.size() - 1;
+    for (const Slot& entry : previous) {
+        if (entry.text == nullptr) continue;
+        size_t slot = entry.hash & mask;
+        while (slots[slot].text != nullptr) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = entry;
+    }
+}
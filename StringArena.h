@@ -0,0 +1,121 @@
+// Specification File -> StringArena.h
+#ifndef STRINGARENA_H
+#define STRINGARENA_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+/*
+    StringArena
+    -----------------------------
+    Description:
+    Stores many short strings back to back in large blocks of characters instead of
+    one heap allocation per string. A block is never moved or resized once created,
+    so the string_view returned by append() stays valid for the arena's lifetime.
+
+    In Simpler Terms:
+    A big shared notebook for item descriptions: each new description is written
+    right after the previous one, and the program keeps a bookmark to where it is.
+*/
+class StringArena {
+public:
+    explicit StringArena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    StringArena(StringArena&&) = default;
+    StringArena& operator=(StringArena&&) = default;
+
+    // Copies text into the arena and returns a stable view of the copy.
+    string_view append(string_view text);
+
+    // Total characters stored (excluding unused space at the end of blocks).
+    size_t bytesUsed() const { return used; }
+
+    // Total characters allocated across all blocks.
+    size_t bytesReserved() const { return reserved; }
+
+private:
+    struct Block {
+        unique_ptr<char[]> data;
+        size_t capacity = 0;
+        size_t length = 0;
+    };
+
+    size_t blockSize;
+    vector<Block> blocks;
+    size_t used = 0;
+    size_t reserved = 0;
+};
+
+/*
+    StringInterner
+    -----------------------------
+    Description:
+    A StringArena that stores each distinct string only once. intern() looks the
+    text up in an open-addressing hash table of views into the arena; if the same
+    text was stored before, the existing view is returned and nothing is copied.
+    The table is one flat array that doubles when it is 3/4 full, so interning
+    never allocates per string, only when the arena needs a new block or the
+    table grows.
+
+    Catalogs repeat themselves ("(box of 100)", "PVC Elbow Joint"), so the text
+    of a large inventory often takes a fraction of the space it would otherwise.
+    When the strings turn out to be mostly distinct, the table would cost more
+    than it saves; the interner then stops deduplicating (checked each time the
+    table would grow past DEDUPLICATION_CHECK_SLOTS) and behaves like a plain
+    StringArena from then on.
+
+    In Simpler Terms:
+    The notebook from StringArena with an index in the back: before writing a
+    description down, check whether it is already written somewhere.
+*/
+class StringInterner {
+public:
+    // Table size from which deduplication has to keep paying for itself.
+    static constexpr size_t DEDUPLICATION_CHECK_SLOTS = 64 * 1024;
+
+    explicit StringInterner(size_t blockSize = 64 * 1024) : arena(blockSize) {}
+
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    // Returns a view of a stored copy of text, storing it first if it is new.
+    string_view intern(string_view text);
+
+    // Number of (non-empty) strings stored; all distinct while deduplicating.
+    size_t storedStrings() const { return count; }
+
+    // False once the interner has fallen back to storing every string.
+    bool deduplicating() const { return deduplicate; }
+
+    // Characters stored, i.e. the length of all stored strings together.
+    size_t bytesUsed() const { return arena.bytesUsed(); }
+
+    // Memory held: arena blocks plus the hash table.
+    size_t bytesReserved() const { return arena.bytesReserved() + slots.size() * sizeof(Slot); }
+
+private:
+    // One table entry: the stored text and its hash, which is compared before the
+    // text and reused when the table grows.
+    struct Slot {
+        const char* text = nullptr;   // nullptr marks a free slot
+        size_t length = 0;
+        size_t hash = 0;
+    };
+
+    StringArena arena;
+    vector<Slot> slots;       // Power-of-two size
+    size_t count = 0;
+    size_t lookups = 0;       // Non-empty strings passed to intern()
+    bool deduplicate = true;
+
+    void grow();
+};
+
+#endif // STRINGARENA_H
@@ -0,0 +1,168 @@
+// Specification File -> BenchHarness.h
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+
+using namespace std;
+
+/*
+    Benchmark Harness
+    -----------------------------
+    Description:
+    A small self-contained replacement for a benchmark library. Each case is a
+    function that performs one complete run over `items` elements. The harness
+    runs it once as a warm-up, then repeats it until at least minSeconds have
+    passed (and at least minRuns times), and reports the fastest and the median
+    run. Only the body of the function is timed; per-run setup that must not be
+    measured goes into the optional `prepare` function.
+
+    Every timed run also counts the heap allocations it made (see
+    AllocationCounter.h); the fewest seen in one run is reported per item.
+
+    Results are printed as a table and can also be written as CSV, so two builds
+    can be compared line by line.
+
+    In Simpler Terms:
+    A stopwatch that runs each piece of code several times and keeps the
+    trustworthy numbers.
+*/
+
+struct BenchOptions {
+    double minSeconds = 0.5;   // Keep repeating a case for at least this long
+    int minRuns = 3;
+    int maxRuns = 1000;
+    string filter;             // Only run cases whose name contains this text
+};
+
+struct BenchResult {
+    string name;
+    size_t items = 0;
+    size_t bytes = 0;          // Bytes processed per run (0 = not meaningful)
+    int runs = 0;
+    double bestSeconds = 0.0;
+    double medianSeconds = 0.0;
+    uint64_t allocations = 0;  // Fewest heap allocations made by one timed run
+
+    double allocationsPerItem() const {
+        return items ? static_cast<double>(allocations) / static_cast<double>(items) : 0.0;
+    }
+    double nanosecondsPerItem() const { return items ? bestSeconds * 1e9 / static_cast<double>(items) : 0.0; }
+    double itemsPerSecond() const { return bestSeconds > 0.0 ? static_cast<double>(items) / bestSeconds : 0.0; }
+    double megabytesPerSecond() const {
+        return bestSeconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / bestSeconds : 0.0;
+    }
+};
+
+// Keeps the compiler from discarding a computed value.
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Stream buffer that throws everything away (used to time console output).
+class NullBuffer : public streambuf {
+protected:
+    int overflow(const int c) override { return c; }
+    streamsize xsputn(const char* /*s*/, const streamsize count) override { return count; }
+};
+
+class BenchRunner {
+public:
+    explicit BenchRunner(BenchOptions options) : options(move(options)) {}
+
+    // True if a case with this name passes the filter (lets callers skip expensive setup).
+    bool wants(const string& name) const {
+        return options.filter.empty() || name.find(options.filter) != string::npos;
+    }
+
+    /*
+        Times body() (one full pass over `items` elements, `bytes` bytes of data).
+        prepare() runs before every pass, outside the timed region.
+    */
+    void run(const string& name, const size_t items, const size_t bytes, const function<void()>& body,
+             const function<void()>& prepare = {}) {
+        if (!wants(name)) {
+            return;
+        }
+
+        if (prepare) prepare();
+        body(); // warm-up: caches, page faults, allocator
+
+        vector<double> times;
+        double total = 0.0;
+        uint64_t fewestAllocations = UINT64_MAX;
+        while (static_cast<int>(times.size()) < options.maxRuns &&
+               (static_cast<int>(times.size()) < options.minRuns || total < options.minSeconds)) {
+            if (prepare) prepare();
+            const uint64_t allocationsBefore = allocationCount();
+            const auto start = chrono::steady_clock::now();
+            body();
+            const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            fewestAllocations = min(fewestAllocations, allocationCount() - allocationsBefore);
+            times.push_back(seconds);
+            total += seconds;
+        }
+
+        sort(times.begin(), times.end());
+        BenchResult result;
+        result.name = name;
+        result.items = items;
+        result.bytes = bytes;
+        result.runs = static_cast<int>(times.size());
+        result.bestSeconds = times.front();
+        result.medianSeconds = times[times.size() / 2];
+        result.allocations = fewestAllocations;
+        results.push_back(result);
+        printResult(result);
+    }
+
+    static void printHeader() {
+        printf("%-44s %12s %6s %12s %12s %14s %10s %12s\n", "Benchmark", "Items", "Runs", "Best ms", "Median ms",
+               "Items/s", "MB/s", "Allocs/item");
+        printf("%s\n", string(129, '-').c_str());
+    }
+
+    static void printResult(const BenchResult& result) {
+        printf("%-44s %12zu %6d %12.3f %12.3f %14.0f ", result.name.c_str(), result.items, result.runs,
+               result.bestSeconds * 1e3, result.medianSeconds * 1e3, result.itemsPerSecond());
+        if (result.bytes > 0) {
+            printf("%10.1f ", result.megabytesPerSecond());
+        } else {
+            printf("%10s ", "-");
+        }
+        printf("%12.3f\n", result.allocationsPerItem());
+        fflush(stdout);
+    }
+
+    // Writes name,items,bytes,runs,best_ns,median_ns,ns_per_item,allocs_per_item for every result.
+    bool writeCsv(const string& filename) const {
+        FILE* file = fopen(filename.c_str(), "w");
+        if (file == nullptr) {
+            return false;
+        }
+        fprintf(file, "name,items,bytes,runs,best_ns,median_ns,ns_per_item,allocs_per_item\n");
+        for (const BenchResult& result : results) {
+            fprintf(file, "\"%s\",%zu,%zu,%d,%.0f,%.0f,%.3f,%.4f\n", result.name.c_str(), result.items, result.bytes,
+                    result.runs, result.bestSeconds * 1e9, result.medianSeconds * 1e9, result.nanosecondsPerItem(),
+                    result.allocationsPerItem());
+        }
+        return fclose(file) == 0;
+    }
+
+private:
+    BenchOptions options;
+    vector<BenchResult> results;
+};
+
+#endif // BENCHHARNESS_H
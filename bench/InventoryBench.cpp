@@ -0,0 +1,885 @@
+/*
+    Program    : inventory_bench
+
+    Description:
+        Measures the core inventory paths at several inventory sizes so that
+        regressions show up as numbers before a build reaches production:
+          - splitLineToArray on synthetic records
+          - the parse loop of inputFromFile ('i') and the bulk loader ('b'), and
+            'i' on a dirty file where every third record is rejected, and 'i' on
+            the same records in the seven-column vendor layout
+          - memory used by a bulk load: allocations per record, RSS growth and
+            description text kept, for unique and for repeating descriptions
+          - printInventory ('p') and writeInventoryFile ('o') formatting, including
+            'p' reports written to a file, sorted, and a sorted page, and a 'd'
+            delta export of 1000 changed items
+          - addUnits/removeUnits updates as used by 'a' and 'r', and the same
+            updates committed as 500-line pick lists ('k')
+          - the search index ('f'): building it, text and range queries, and the
+            cost of keeping it up to date during updates
+          - stock figures from a column scan ('v') against the running aggregates ('t')
+          - the same updates on a paged store (--paged) whose cache holds an eighth
+            of the items, with random and with skewed item choice, plus hit rates
+          - the same updates from 1, 2, 4, ... threads at once, alone and next to a
+            reader scanning the store and a writer adding items, followed by a
+            consistency check of the final unit counts
+          - a check that a delta merge ('m') refuses records whose units are out
+            of range and leaves the base untouched, for text and snapshot bases
+
+        Usage:
+          inventory_bench [--sizes 1000,100000,10000000] [--filter text]
+                          [--min-time seconds] [--csv results.csv] [--dir folder]
+          inventory_bench --generate <file> <count> [seed]
+
+        --generate writes a synthetic inventory file in the normal pipe-delimited
+        format and exits (see SyntheticData.h).
+
+        Every case also reports heap allocations per item (Allocs/item), counted
+        by the replacement operator new in AllocationCounter.cpp.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "AllocationCounter.h"
+#include "BenchHarness.h"
+#include "SyntheticData.h"
+#include "BinarySnapshot.h"
+#include "BulkLoader.h"
+#include "ChangeFeed.h"
+#include "ColumnKernels.h"
+#include "DeltaExport.h"
+#include "InventoryStore.h"
+#include "Menu.h"
+#include "PagedStore.h"
+#include "RecordWriter.h"
+#include "SearchIndex.h"
+#include "SplitLineToArray.h"
+#include "StockStats.h"
+
+using namespace std;
+
+// Sends cout to a NullBuffer and feeds cin from text while in scope, so the
+// interactive handlers can be timed without a terminal.
+class ConsoleRedirect {
+public:
+    explicit ConsoleRedirect(const string& input = "") : input(input) {
+        oldOut = cout.rdbuf(&sink);
+        oldIn = cin.rdbuf(this->input.rdbuf());
+    }
+    ~ConsoleRedirect() {
+        cout.rdbuf(oldOut);
+        cin.rdbuf(oldIn);
+    }
+
+private:
+    NullBuffer sink;
+    istringstream input;
+    streambuf* oldOut;
+    streambuf* oldIn;
+};
+
+static vector<size_t> parseSizes(const string& text) {
+    vector<size_t> sizes;
+    stringstream list(text);
+    for (string size; getline(list, size, ',');) {
+        if (const size_t value = strtoull(size.c_str(), nullptr, 10); value > 0) {
+            sizes.push_back(value);
+        }
+    }
+    return sizes;
+}
+
+static string sizeLabel(const size_t size) {
+    if (size >= 1000000 && size % 1000000 == 0) return to_string(size / 1000000) + "M";
+    if (size >= 1000 && size % 1000 == 0) return to_string(size / 1000) + "K";
+    return to_string(size);
+}
+
+static void benchSplitLine(BenchRunner& runner, const size_t count) {
+    if (!runner.wants("splitLineToArray/" + sizeLabel(count))) return;
+    const vector<string> lines = syntheticLines(count);
+    size_t bytes = 0;
+    for (const string& line : lines) bytes += line.size() + 1;
+
+    runner.run("splitLineToArray/" + sizeLabel(count), count, bytes, [&] {
+        string fields[4];
+        int total = 0;
+        for (const string& line : lines) {
+            total += splitLineToArray(line, "|", fields, 4);
+        }
+        doNotOptimize(total);
+    });
+}
+
+// Writes count synthetic records with every third one broken (units "n/a"), as
+// from a dirty vendor feed. Returns the number of bytes written, 0 on failure.
+static size_t writeDirtyInventory(const string& filename, const size_t count) {
+    ofstream out(filename, ios::binary);
+    size_t bytes = 0;
+    for (size_t i = 0; i < count && out; ++i) {
+        string line = syntheticRecord(i);
+        if (i % 3 == 2) {
+            line.replace(line.rfind('|') + 1, string::npos, "n/a");
+        }
+        line += '\n';
+        out << line;
+        bytes += line.size();
+    }
+    return out ? bytes : 0;
+}
+
+// Writes count synthetic records in the vendor layout (index|sku|description|
+// supplier|cost|units|bin, see RecordSchema.h). Returns the bytes written, 0 on failure.
+static size_t writeVendorInventory(const string& filename, const size_t count) {
+    ofstream out(filename, ios::binary);
+    size_t bytes = 0;
+    for (size_t i = 0; i < count && out; ++i) {
+        string line = syntheticRecord(i);
+        const size_t first = line.find('|');
+        line.insert(first + 1, "SKU-" + to_string(i) + "|");
+        const size_t cost = line.find('|', line.find('|', first + 1) + 1);
+        line.insert(cost + 1, "Supplier " + to_string(i % 17) + "|");
+        line += "|BIN-" + to_string(i % 500) + "\n";
+        out << line;
+        bytes += line.size();
+    }
+    return out ? bytes : 0;
+}
+
+static void benchLoading(BenchRunner& runner, const size_t count, const string& file) {
+    if (!runner.wants("inputFromFile (i)/" + sizeLabel(count)) &&
+        !runner.wants("bulkLoadFile (b)/" + sizeLabel(count)) &&
+        !runner.wants("inputFromFile, 1/3 rejected (i)/" + sizeLabel(count)) &&
+        !runner.wants("inputFromFile, vendor layout (i)/" + sizeLabel(count))) {
+        return;
+    }
+    const size_t bytes = writeSyntheticInventory(file, count);
+    if (bytes == 0) {
+        cerr << "Error: Could not write \"" << file << "\".\n";
+        return;
+    }
+    unique_ptr<InventoryStore> inventory;
+    const auto freshStore = [&] { inventory = make_unique<InventoryStore>(); };
+
+    runner.run("inputFromFile (i)/" + sizeLabel(count), count, bytes, [&] {
+        ConsoleRedirect console(file + "\n");
+        inputFromFile(*inventory);
+    }, freshStore);
+
+    runner.run("bulkLoadFile (b)/" + sizeLabel(count), count, bytes, [&] {
+        BulkLoadStats stats;
+        bulkLoadFile(file, *inventory, stats);
+        doNotOptimize(stats.recordsLoaded);
+    }, freshStore);
+
+    if (runner.wants("inputFromFile, 1/3 rejected (i)/" + sizeLabel(count))) {
+        const size_t dirtyBytes = writeDirtyInventory(file, count);
+        runner.run("inputFromFile, 1/3 rejected (i)/" + sizeLabel(count), count, dirtyBytes, [&] {
+            ConsoleRedirect console(file + "\n");
+            inputFromFile(*inventory);
+        }, freshStore);
+    }
+
+    if (runner.wants("inputFromFile, vendor layout (i)/" + sizeLabel(count))) {
+        const size_t vendorBytes = writeVendorInventory(file, count);
+        runner.run("inputFromFile, vendor layout (i)/" + sizeLabel(count), count, vendorBytes, [&] {
+            ConsoleRedirect console;
+            inputFromFile(*inventory, file + " vendor");
+        }, freshStore);
+    }
+
+    error_code removeError;
+    filesystem::remove(file, removeError);
+    filesystem::remove(file + ".rejects", removeError);
+}
+
+/*
+ * reportMemory function definition:
+ *  - Loads count records with 'b' into a fresh store and reports what the load
+ *    cost in memory: heap allocations per record, growth of the resident set
+ *    (RSS) and how much description text the interner kept. Done twice: once with
+ *    every record generated on its own, once as a 1000-product catalog where
+ *    descriptions repeat.
+ */
+static void reportMemory(BenchRunner& runner, const size_t count, const string& file) {
+    if (!runner.wants("memory/" + sizeLabel(count))) return;
+    const pair<const char*, size_t> datasets[] = {{"random", 0}, {"catalog of 1000", 1000}};
+    for (const auto& [datasetName, distinct] : datasets) {
+        const size_t bytes = writeSyntheticInventory(file, count, 1, distinct);
+        if (bytes == 0) {
+            cerr << "Error: Could not write \"" << file << "\".\n";
+            return;
+        }
+        releaseFreeMemory();
+        const size_t residentBefore = residentBytes();
+        const uint64_t allocationsBefore = allocationCount();
+        auto inventory = make_unique<InventoryStore>();
+        BulkLoadStats stats;
+        bulkLoadFile(file, *inventory, stats);
+        const uint64_t allocations = allocationCount() - allocationsBefore;
+        const size_t residentAfter = residentBytes();
+
+        size_t textBytes = 0;
+        for (int item = 0; item < inventory->size(); ++item) {
+            textBytes += inventory->getDescription(item).size();
+        }
+        printf("memory/%s (%s): %.3f allocs/record, RSS +%.1f MB for %.1f MB of file, "
+               "%zu description copies, %.1f of %.1f MB text kept\n",
+               sizeLabel(count).c_str(), datasetName,
+               count ? static_cast<double>(allocations) / static_cast<double>(count) : 0.0,
+               static_cast<double>(residentAfter - min(residentBefore, residentAfter)) / (1024.0 * 1024.0),
+               static_cast<double>(bytes) / (1024.0 * 1024.0), inventory->storedDescriptions(),
+               static_cast<double>(inventory->descriptionBytes()) / (1024.0 * 1024.0),
+               static_cast<double>(textBytes) / (1024.0 * 1024.0));
+        fflush(stdout);
+    }
+
+    error_code removeError;
+    filesystem::remove(file, removeError);
+}
+
+// Adds count synthetic records (see SyntheticData.h) through addItem.
+static void fillSynthetic(InventoryStore& inventory, const size_t count) {
+    inventory.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const string line = syntheticRecord(i);
+        string fields[4];
+        splitLineToArray(line, "|", fields, 4);
+        inventory.addItem(InventoryItem(fields[1], stod(fields[2]), stoi(fields[3])));
+    }
+}
+
+static void benchFormatting(BenchRunner& runner, const size_t count, const string& file) {
+    const string label = "/" + sizeLabel(count);
+    const string names[] = {"printInventory (p)", "report to file (p > file)", "report by cost (p by cost > file)",
+                            "sorted page (p n 50 by description)", "writeInventoryFile (o)",
+                            "delta of 1000 changes (d)"};
+    if (none_of(begin(names), end(names), [&](const string& name) { return runner.wants(name + label); })) {
+        return;
+    }
+    InventoryStore inventory;
+    fillSynthetic(inventory, count);
+
+    runner.run(names[0] + label, count, 0, [&] {
+        ConsoleRedirect console;
+        printInventory(inventory);
+    });
+
+    const string reportArguments[] = {"> " + file, "by cost > " + file};
+    for (size_t r = 0; r < size(reportArguments); ++r) {
+        runner.run(names[r + 1] + label, count, 0, [&] {
+            ConsoleRedirect console;
+            printInventory(inventory, reportArguments[r]);
+        });
+    }
+
+    const string page = to_string(count / 2) + " 50 by description";
+    runner.run(names[3] + label, min<size_t>(count, 50), 0, [&] {
+        ConsoleRedirect console;
+        printInventory(inventory, page);
+    });
+
+    error_code sizeError;
+    writeInventoryFile(inventory, file);
+    const size_t bytes = static_cast<size_t>(filesystem::file_size(file, sizeError));
+    runner.run(names[4] + label, count, sizeError ? 0 : bytes, [&] {
+        writeInventoryFile(inventory, file);
+    });
+
+    // 1000 items spread over the store change between two exports
+    const size_t changes = min<size_t>(count, 1000);
+    ChangeTracker tracker(inventory);
+    tracker.take();
+    runner.run(names[5] + label, changes, 0, [&] {
+        for (size_t i = 0; i < changes; ++i) {
+            const int itemNum = static_cast<int>(i * (count / changes));
+            inventory.setUnits(itemNum, (inventory.getUnits(itemNum) + 1) % (MAX_UNITS + 1));
+        }
+        writeInventoryRecords(inventory, tracker.take(), file);
+    });
+
+    filesystem::remove(file, sizeError);
+}
+
+// Fills a store with count items whose unit counts cycle through 0..MAX_UNITS.
+static void fillForUpdates(InventoryStore& inventory, const size_t count) {
+    inventory.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        inventory.addItem(InventoryItem("Item", 1.0, static_cast<int>(i % (MAX_UNITS + 1))));
+    }
+}
+
+/*
+ * benchUpdates function definition:
+ *  - One pass applies `count` add/remove operations to random items, alternating
+ *    like a stream of 'a' and 'r' commands. Some are rejected by the bounds
+ *    checks, exactly as they would be interactively.
+ */
+static void benchUpdates(BenchRunner& runner, const size_t count) {
+    if (!runner.wants("addUnits/removeUnits (a/r)/" + sizeLabel(count))) return;
+    InventoryStore inventory;
+    fillForUpdates(inventory, count);
+
+    vector<int> items(count);
+    vector<int> quantities(count);
+    uint64_t state = 42;
+    for (size_t i = 0; i < count; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        items[i] = static_cast<int>((state >> 33) % count);
+        quantities[i] = 1 + static_cast<int>((state >> 20) % 5);
+    }
+
+    runner.run("addUnits/removeUnits (a/r)/" + sizeLabel(count), count, 0, [&] {
+        size_t applied = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const StockResult result = (i & 1) ? inventory.removeUnits(items[i], quantities[i])
+                                               : inventory.addUnits(items[i], quantities[i]);
+            applied += result == StockResult::Ok;
+        }
+        doNotOptimize(applied);
+    });
+}
+
+/*
+ * benchBackgroundExport function definition:
+ *  - What 'w' costs the command loop: starting an export (the stall before the
+ *    next command), and the benchUpdates stream run while the export writes, so
+ *    its first change to each chunk pays for the copy-on-write.
+ *  - Each pass waits for the previous export outside the timed region.
+ */
+static void benchBackgroundExport(BenchRunner& runner, const size_t count, const string& file) {
+    const string label = "/" + sizeLabel(count);
+    const string names[] = {"start background write (w)", "addUnits/removeUnits during background write (a/r, w)"};
+    if (none_of(begin(names), end(names), [&](const string& name) { return runner.wants(name + label); })) {
+        return;
+    }
+    InventoryStore inventory;
+    fillForUpdates(inventory, count);
+
+    const auto waitForExport = [] {
+        ConsoleRedirect console;
+        waitForBackgroundExport();
+    };
+    runner.run(names[0] + label, count, 0, [&] {
+        doNotOptimize(startBackgroundExport(inventory, file));
+    }, waitForExport);
+
+    vector<int> items(count);
+    vector<int> quantities(count);
+    uint64_t state = 42;
+    for (size_t i = 0; i < count; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        items[i] = static_cast<int>((state >> 33) % count);
+        quantities[i] = 1 + static_cast<int>((state >> 20) % 5);
+    }
+    runner.run(names[1] + label, count, 0, [&] {
+        size_t applied = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const StockResult result = (i & 1) ? inventory.removeUnits(items[i], quantities[i])
+                                               : inventory.addUnits(items[i], quantities[i]);
+            applied += result == StockResult::Ok;
+        }
+        doNotOptimize(applied);
+    }, [&] {
+        waitForExport();
+        startBackgroundExport(inventory, file);
+    });
+
+    waitForExport();
+    error_code removeError;
+    filesystem::remove(file, removeError);
+}
+
+/*
+ * benchChangeFeed function definition:
+ *  - The benchUpdates stream with a ChangeFeed attached: without subscribers
+ *    (the cost of publishing), and with one subscriber thread draining it under
+ *    each policy.
+ *  - Round trip: one change at a time, timed until the subscriber has it, so
+ *    Items/s is the inverse of the delivery latency (including the wake-up).
+ */
+static void benchChangeFeed(BenchRunner& runner, const size_t count) {
+    const string label = "/" + sizeLabel(count);
+    const string names[] = {"a/r with change feed, no subscriber", "a/r with change feed + subscriber (overwrite)",
+                            "a/r with change feed + subscriber (block)", "change feed round trip (a -> subscriber)"};
+    if (none_of(begin(names), end(names), [&](const string& name) { return runner.wants(name + label); })) {
+        return;
+    }
+
+    vector<int> items(count);
+    vector<int> quantities(count);
+    uint64_t state = 42;
+    for (size_t i = 0; i < count; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        items[i] = static_cast<int>((state >> 33) % count);
+        quantities[i] = 1 + static_cast<int>((state >> 20) % 5);
+    }
+    const auto updates = [&](InventoryStore& inventory) {
+        size_t applied = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const StockResult result = (i & 1) ? inventory.removeUnits(items[i], quantities[i])
+                                               : inventory.addUnits(items[i], quantities[i]);
+            applied += result == StockResult::Ok;
+        }
+        doNotOptimize(applied);
+    };
+
+    // Drains subscription until stop is set and nothing is left; seen is the last sequence read.
+    const auto drain = [](ChangeSubscription& subscription, const atomic<bool>& stop, atomic<uint64_t>& seen) {
+        vector<ChangeEvent> events(4096);
+        for (;;) {
+            const bool stopping = stop.load(memory_order_acquire);
+            const size_t read = subscription.poll(events.data(), events.size());
+            if (read > 0) {
+                seen.store(events[read - 1].sequence, memory_order_release);
+            } else if (stopping) {
+                break;
+            } else {
+                subscription.wait(chrono::microseconds(1000));
+            }
+        }
+    };
+
+    for (size_t c = 0; c < 3; ++c) {
+        if (!runner.wants(names[c] + label)) continue;
+        InventoryStore inventory;
+        fillForUpdates(inventory, count);
+        ChangeFeed feed(inventory, ChangeFeed::DEFAULT_CAPACITY, c == 2 ? FeedPolicy::Block : FeedPolicy::Overwrite);
+        runner.run(names[c] + label, count, 0, [&] {
+            if (c == 0) {
+                updates(inventory);
+                return;
+            }
+            unique_ptr<ChangeSubscription> subscription = feed.subscribe();
+            atomic<bool> stop{false};
+            atomic<uint64_t> seen{0};
+            thread subscriber(drain, ref(*subscription), cref(stop), ref(seen));
+            updates(inventory);
+            stop.store(true, memory_order_release);
+            subscriber.join();
+        });
+    }
+
+    if (runner.wants(names[3] + label)) {
+        constexpr size_t ROUND_TRIPS = 1000;
+        InventoryStore inventory;
+        fillForUpdates(inventory, count);
+        ChangeFeed feed(inventory);
+        unique_ptr<ChangeSubscription> subscription = feed.subscribe();
+        atomic<bool> stop{false};
+        atomic<uint64_t> seen{0};
+        thread subscriber(drain, ref(*subscription), cref(stop), ref(seen));
+        runner.run(names[3] + label, ROUND_TRIPS, 0, [&] {
+            for (size_t i = 0; i < ROUND_TRIPS; ++i) {
+                const int itemNum = items[i % count];
+                if (inventory.addUnits(itemNum, 1) != StockResult::Ok) inventory.removeUnits(itemNum, 1);
+                while (seen.load(memory_order_acquire) < feed.published()) this_thread::yield();
+            }
+        });
+        stop.store(true, memory_order_release);
+        subscriber.join();
+    }
+}
+
+/*
+ * benchPickLists function definition:
+ *  - The update stream of benchUpdates cut into 500-line pick lists, each
+ *    committed all-or-nothing through StockTransaction, from one thread as at the
+ *    console. A list with a line out of range is rejected as a whole, so more
+ *    lines fail than with single updates.
+ */
+static void benchPickLists(BenchRunner& runner, const size_t count) {
+    constexpr size_t LINES = 500;
+    const string name = "pick lists of 500 (k)/" + sizeLabel(count);
+    if (!runner.wants(name)) return;
+    InventoryStore inventory;
+    fillForUpdates(inventory, count);
+
+    vector<StockTransaction> lists((count + LINES - 1) / LINES);
+    uint64_t state = 42;
+    for (size_t i = 0; i < count; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const int itemNum = static_cast<int>((state >> 33) % count);
+        const int quantity = 1 + static_cast<int>((state >> 20) % 5);
+        if (i & 1) {
+            lists[i / LINES].remove(itemNum, quantity);
+        } else {
+            lists[i / LINES].add(itemNum, quantity);
+        }
+    }
+
+    runner.run(name, count, 0, [&] {
+        size_t committed = 0;
+        for (const StockTransaction& list : lists) {
+            committed += list.commit(inventory) == StockResult::Ok;
+        }
+        doNotOptimize(committed);
+    });
+}
+
+/*
+ * benchPagedUpdates function definition:
+ *  - The a/r loop of benchUpdates on a PagedStore whose cache holds an eighth of
+ *    the item pages, so most random updates fault a page in (and write a dirty
+ *    one back). The skewed case sends 90% of the updates to 5% of the items, the
+ *    usual shape of real stock movements; the hit rate of each case is printed.
+ */
+static void benchPagedUpdates(BenchRunner& runner, const size_t count, const filesystem::path& pageFile) {
+    const string label = "/" + sizeLabel(count);
+    const char* const names[] = {"paged a/r, random (--paged)", "paged a/r, 5% hot (--paged)"};
+    if (none_of(begin(names), end(names), [&](const char* name) { return runner.wants(name + label); })) {
+        return;
+    }
+
+    error_code removeError;
+    filesystem::remove(pageFile, removeError);
+    const size_t cacheBytes = count / PagedStore::RECORDS_PER_PAGE / 8 * BufferCache::PAGE_SIZE;
+    PagedStore inventory;
+    const char* reason = nullptr;
+    if (!inventory.open(pageFile.string(), cacheBytes, reason)) {
+        cerr << "Error: \"" << pageFile.string() << "\": " << reason << ".\n";
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        inventory.addItem("Item", Money::fromCents(100), static_cast<int>(i % (MAX_UNITS + 1)));
+    }
+    inventory.flush();
+
+    const size_t hotItems = max<size_t>(count / 20, 1);
+    for (size_t c = 0; c < size(names); ++c) {
+        vector<int> items(count);
+        vector<int> quantities(count);
+        uint64_t state = 42;
+        for (size_t i = 0; i < count; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            const bool hot = c == 1 && (state >> 8) % 10 != 0;
+            items[i] = static_cast<int>((state >> 33) % (hot ? hotItems : count));
+            quantities[i] = 1 + static_cast<int>((state >> 20) % 5);
+        }
+
+        const CacheStats before = inventory.cacheStats();
+        runner.run(names[c] + label, count, 0, [&] {
+            size_t applied = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const StockResult result = (i & 1) ? inventory.removeUnits(items[i], quantities[i])
+                                                   : inventory.addUnits(items[i], quantities[i]);
+                applied += result == StockResult::Ok;
+            }
+            doNotOptimize(applied);
+        });
+        const CacheStats after = inventory.cacheStats();
+        const uint64_t hits = after.hits - before.hits;
+        const uint64_t fetches = hits + after.misses - before.misses;
+        printf("%s%s: %.1f%% cache hits, %llu page(s) written back, cache %zu of %zu pages\n", names[c],
+               label.c_str(), fetches ? 100.0 * static_cast<double>(hits) / static_cast<double>(fetches) : 0.0,
+               static_cast<unsigned long long>(after.writeBacks - before.writeBacks), after.capacityPages,
+               count / PagedStore::RECORDS_PER_PAGE + 1);
+        fflush(stdout);
+    }
+
+    filesystem::remove(pageFile, removeError);
+}
+
+/*
+ * benchSearch function definition:
+ *  - Builds the search index from scratch, then times batches of 'f' queries
+ *    (first 50 matches plus the total count, as the command prints them), and
+ *    the a/r update loop with the index attached and following every change.
+ */
+static void benchSearch(BenchRunner& runner, const size_t count) {
+    const string label = string("/").append(sizeLabel(count));
+    const char* const names[] = {"search index build (f)", "search text \"hex bolt\" (f)", "search units < 5 (f)",
+                                 "search cost between 2 and 4 (f)", "addUnits/removeUnits + index (a/r)"};
+    if (none_of(begin(names), end(names), [&](const char* name) { return runner.wants(name + label); })) return;
+    InventoryStore inventory;
+    fillSynthetic(inventory, count);
+
+    unique_ptr<SearchIndex> index;
+    runner.run(names[0] + label, count, 0, [&] {
+        index = make_unique<SearchIndex>(inventory);
+        doNotOptimize(index->search(SearchQuery(), 0).total);
+    }, [&] { index.reset(); });
+    if (!index) index = make_unique<SearchIndex>(inventory);
+
+    constexpr size_t QUERIES = 100;
+    const char* const queries[] = {"hex bolt", "units < 5", "cost between 2 and 4"};
+    for (size_t q = 0; q < size(queries); ++q) {
+        SearchQuery query;
+        const char* reason = nullptr;
+        parseSearchQuery(queries[q], query, reason);
+        runner.run(names[q + 1] + label, QUERIES, 0, [&] {
+            size_t found = 0;
+            for (size_t i = 0; i < QUERIES; ++i) {
+                found += index->search(query, 50).total;
+            }
+            doNotOptimize(found);
+        });
+    }
+
+    runner.run(names[4] + label, count, 0, [&] {
+        uint64_t state = 42;
+        size_t applied = 0;
+        for (size_t i = 0; i < count; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            const int itemNum = static_cast<int>((state >> 33) % count);
+            const int quantity = 1 + static_cast<int>((state >> 20) % 5);
+            const StockResult result = (i & 1) ? inventory.removeUnits(itemNum, quantity)
+                                               : inventory.addUnits(itemNum, quantity);
+            applied += result == StockResult::Ok;
+        }
+        doNotOptimize(applied);
+    });
+}
+
+/*
+ * benchStatistics function definition:
+ *  - Answers "value, units, low stock" by scanning the columns (what 'v'
+ *    does) and from the running aggregates (what 't' does), 100 times each.
+ */
+static void benchStatistics(BenchRunner& runner, const size_t count) {
+    const string label = string("/").append(sizeLabel(count));
+    if (!runner.wants("stock figures by scan (v)" + label) && !runner.wants("stock figures running (t)" + label)) {
+        return;
+    }
+    InventoryStore inventory;
+    fillSynthetic(inventory, count);
+    StockStats stats(inventory);
+
+    constexpr size_t QUERIES = 100;
+    runner.run("stock figures by scan (v)" + label, QUERIES, 0, [&] {
+        double value = 0.0;
+        for (size_t i = 0; i < QUERIES; ++i) {
+            value += totalStockValue(inventory).toDouble() + static_cast<double>(totalUnits(inventory)) +
+                     static_cast<double>(countUnitsAtMost(inventory, DEFAULT_REORDER_THRESHOLD));
+        }
+        doNotOptimize(value);
+    });
+    runner.run("stock figures running (t)" + label, QUERIES, 0, [&] {
+        double value = 0.0;
+        for (size_t i = 0; i < QUERIES; ++i) {
+            const StockFigures figures = stats.snapshot();
+            value += figures.value.toDouble() + static_cast<double>(figures.units) + figures.atOrBelowReorder;
+        }
+        doNotOptimize(value);
+    });
+}
+
+/*
+ * pickerLoop function definition:
+ *  - One simulated picker: `operations` random add/remove requests of 1..5 units.
+ *  - Returns the net number of units it actually added (rejected requests count 0).
+ */
+static long long pickerLoop(InventoryStore& inventory, const size_t count, const size_t operations,
+                            uint64_t state) {
+    long long net = 0;
+    for (size_t i = 0; i < operations; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        const int itemNum = static_cast<int>((state >> 33) % count);
+        const int quantity = 1 + static_cast<int>((state >> 20) % 5);
+        if (i & 1) {
+            net -= inventory.removeUnits(itemNum, quantity) == StockResult::Ok ? quantity : 0;
+        } else {
+            net += inventory.addUnits(itemNum, quantity) == StockResult::Ok ? quantity : 0;
+        }
+    }
+    return net;
+}
+
+/*
+ * benchConcurrentUpdates function definition:
+ *  - Runs `count` operations per thread for 1, 2, 4, ... up to the hardware thread
+ *    count. With perfect scaling, Items/s grows with the number of threads.
+ *  - The "+ reader + writer" variant adds one thread that keeps computing the
+ *    stock value and one that appends up to `count` items, to show that neither
+ *    blocks the pickers.
+ */
+static void benchConcurrentUpdates(BenchRunner& runner, const size_t count) {
+    const unsigned hardware = max(1u, thread::hardware_concurrency());
+    vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < hardware; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(hardware);
+
+    for (const bool mixed : {false, true}) {
+        for (const unsigned threads : threadCounts) {
+            const string name = "concurrent a/r x" + to_string(threads) + (mixed ? " + reader + writer/" : "/") +
+                                sizeLabel(count);
+            if (!runner.wants(name)) continue;
+
+            InventoryStore inventory;
+            fillForUpdates(inventory, count);
+            runner.run(name, count * threads, 0, [&] {
+                atomic<bool> pickersDone{false};
+                vector<thread> workers;
+                if (mixed) {
+                    workers.emplace_back([&] {
+                        double value = 0.0;
+                        while (!pickersDone.load(memory_order_relaxed)) value += totalStockValue(inventory).toDouble();
+                        doNotOptimize(value);
+                    });
+                    workers.emplace_back([&] {
+                        for (size_t added = 0; added < count && !pickersDone.load(memory_order_relaxed); ++added) {
+                            inventory.addItem(InventoryItem("New", 2.0, 1));
+                        }
+                    });
+                }
+                vector<thread> pickers;
+                for (unsigned t = 0; t < threads; ++t) {
+                    pickers.emplace_back([&, t] { doNotOptimize(pickerLoop(inventory, count, count, t + 1)); });
+                }
+                for (thread& picker : pickers) picker.join();
+                pickersDone.store(true, memory_order_relaxed);
+                for (thread& worker : workers) worker.join();
+            });
+        }
+    }
+}
+
+/*
+ * stressCheck function definition:
+ *  - Hammers a small store (heavy contention on every item) from many threads,
+ *    then verifies that no unit count left 0..MAX_UNITS and that the total equals
+ *    the starting total plus every change the threads were told succeeded.
+ */
+static bool stressCheck(const size_t count, const unsigned threads) {
+    InventoryStore inventory;
+    fillForUpdates(inventory, count);
+    const int64_t before = totalUnits(inventory);
+
+    vector<long long> net(threads, 0);
+    vector<thread> pickers;
+    for (unsigned t = 0; t < threads; ++t) {
+        pickers.emplace_back([&, t] { net[t] = pickerLoop(inventory, count, 1000000, 1000 + t); });
+    }
+    for (thread& picker : pickers) picker.join();
+
+    long long expected = before;
+    for (const long long change : net) expected += change;
+    bool inRange = true;
+    for (int i = 0; i < inventory.size(); ++i) {
+        inRange = inRange && inventory.getUnits(i) >= 0 && inventory.getUnits(i) <= MAX_UNITS;
+    }
+    const bool ok = inRange && totalUnits(inventory) == expected;
+    printf("Stress check (%u threads, %zu items, 1M operations each): %s\n", threads, count,
+           ok ? "OK" : "FAILED");
+    return ok;
+}
+
+static string readWholeFile(const string& filename) {
+    ifstream in(filename, ios::binary);
+    return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+/*
+ * mergeCheck function definition:
+ *  - Merges a delta whose record has units below 0 or above MAX_UNITS into an
+ *    'o' export and into a snapshot; each merge must fail and leave the base
+ *    byte for byte as it was.
+ *  - Then merges a valid delta into both to show the bases are still usable.
+ */
+static bool mergeCheck(const filesystem::path& folder) {
+    InventoryStore inventory;
+    fillForUpdates(inventory, 8);
+    const string textBase = (folder / "inventory_bench_merge.txt").string();
+    const string snapshotBase = (folder / "inventory_bench_merge.snap").string();
+    const string delta = (folder / "inventory_bench_merge_delta.txt").string();
+    bool ok = writeInventoryFile(inventory, textBase) && saveSnapshotFile(inventory, snapshotBase);
+
+    const auto merge = [&](const string& base, const string& record) {
+        ofstream(delta, ios::trunc) << record << '\n';
+        MergeSummary summary;
+        string error;
+        return mergeDeltaFiles(base, {delta}, summary, error);
+    };
+    for (const string& base : {textBase, snapshotBase}) {
+        const string before = readWholeFile(base);
+        ok = ok && !merge(base, "3|Item|1.00|-4") && !merge(base, "9|Item|1.00|999");
+        ok = ok && readWholeFile(base) == before;
+        ok = ok && merge(base, "3|Item|1.00|" + to_string(MAX_UNITS));
+    }
+    InventoryStore merged;
+    ok = ok && loadSnapshotFile(snapshotBase, merged) == SnapshotResult::Ok && merged.size() == 8 &&
+         merged.getUnits(3) == MAX_UNITS;
+
+    filesystem::remove(textBase);
+    filesystem::remove(snapshotBase);
+    filesystem::remove(delta);
+    printf("Merge check (out-of-range units in a delta): %s\n", ok ? "OK" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    vector<size_t> sizes = {1000, 100000, 10000000};
+    string csvFile;
+    filesystem::path folder = filesystem::temp_directory_path();
+
+    for (int arg = 1; arg < argc; ++arg) {
+        const string option = argv[arg];
+        if (option == "--generate" && arg + 2 < argc) {
+            const uint64_t seed = arg + 3 < argc ? strtoull(argv[arg + 3], nullptr, 10) : 1;
+            const size_t bytes = writeSyntheticInventory(argv[arg + 1], strtoull(argv[arg + 2], nullptr, 10), seed);
+            if (bytes == 0) {
+                cerr << "Error: Could not write \"" << argv[arg + 1] << "\".\n";
+                return 1;
+            }
+            cout << "Wrote " << bytes << " bytes to \"" << argv[arg + 1] << "\".\n";
+            return 0;
+        } else if (option == "--sizes" && arg + 1 < argc) {
+            sizes = parseSizes(argv[++arg]);
+        } else if (option == "--filter" && arg + 1 < argc) {
+            options.filter = argv[++arg];
+        } else if (option == "--min-time" && arg + 1 < argc) {
+            options.minSeconds = atof(argv[++arg]);
+        } else if (option == "--csv" && arg + 1 < argc) {
+            csvFile = argv[++arg];
+        } else if (option == "--dir" && arg + 1 < argc) {
+            folder = argv[++arg];
+        } else {
+            cerr << "Usage: " << argv[0] << " [--sizes n,n,...] [--filter text] [--min-time seconds]"
+                 << " [--csv file] [--dir folder]\n"
+                 << "       " << argv[0] << " --generate <file> <count> [seed]\n";
+            return 1;
+        }
+    }
+
+    const string file = (folder / "inventory_bench_data.txt").string();
+    BenchRunner runner(options);
+    BenchRunner::printHeader();
+    for (const size_t count : sizes) {
+        benchSplitLine(runner, count);
+        benchLoading(runner, count, file);
+        reportMemory(runner, count, file);
+        benchFormatting(runner, count, file);
+        benchUpdates(runner, count);
+        benchBackgroundExport(runner, count, file);
+        benchChangeFeed(runner, count);
+        benchPickLists(runner, count);
+        benchPagedUpdates(runner, count, folder / "inventory_bench_pages.db");
+        benchSearch(runner, count);
+        benchStatistics(runner, count);
+        benchConcurrentUpdates(runner, count);
+    }
+
+    if (!stressCheck(64, max(4u, thread::hardware_concurrency()))) {
+        return 2;
+    }
+    if (!mergeCheck(folder)) {
+        return 2;
+    }
+
+    if (!csvFile.empty() && !runner.writeCsv(csvFile)) {
+        cerr << "Error: Could not write \"" << csvFile << "\".\n";
+        return 1;
+    }
+    return 0;
+}
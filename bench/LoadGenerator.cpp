@@ -0,0 +1,278 @@
+/*
+    Program    : inventory_loadgen
+
+    Description:
+        Load generator for server mode (see Server.h). Opens several connections
+        to a running server and keeps `depth` pipelined a/r requests in flight on
+        each, picking random items and quantities. Every response is matched to
+        its request in order, and the time between sending a request and reading
+        its response is recorded. At the end it reports throughput and latency
+        percentiles over all connections.
+
+        Usage:
+          inventory_loadgen --connect <[host:]port|unix:/path> [--connections 4]
+                            [--depth 16] [--requests 100000] [--seed 1]
+
+        The server must already hold some items (for example: Project2 --load
+        inventory.txt --serve 7070). "r" requests that would go below zero units
+        come back as ERR and are counted as rejected, not as failures.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+struct LoadOptions {
+    string address;
+    int connections = 4;
+    int depth = 16;              // Requests in flight per connection
+    uint64_t requests = 100000;  // Total over all connections
+    uint64_t seed = 1;
+};
+
+struct ConnectionResult {
+    vector<int64_t> latencies;   // Nanoseconds per request
+    uint64_t rejected = 0;       // ERR responses
+    bool failed = false;         // Connection lost or protocol error
+};
+
+// Connects to "unix:/path" or "[host:]port" (host 127.0.0.1 by default). Returns -1 on failure.
+static int connectTo(const string& address) {
+    if (address.rfind("unix:", 0) == 0) {
+        sockaddr_un remote{};
+        const string path = address.substr(5);
+        if (path.empty() || path.size() >= sizeof(remote.sun_path)) return -1;
+        remote.sun_family = AF_UNIX;
+        memcpy(remote.sun_path, path.c_str(), path.size() + 1);
+        const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&remote), sizeof(remote)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    const size_t colon = address.rfind(':');
+    const string host = colon == string::npos ? "127.0.0.1" : address.substr(0, colon);
+    const string port = colon == string::npos ? address : address.substr(colon + 1);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0) return -1;
+
+    int fd = -1;
+    for (addrinfo* candidate = found; candidate != nullptr && fd < 0; candidate = candidate->ai_next) {
+        fd = socket(candidate->ai_family, candidate->ai_socktype | SOCK_CLOEXEC, candidate->ai_protocol);
+        if (fd >= 0 && connect(fd, candidate->ai_addr, candidate->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (fd >= 0) {
+        const int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+static bool sendAll(const int fd, const string& data) {
+    for (size_t sent = 0; sent < data.size();) {
+        const ssize_t count = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (count <= 0) return false;
+        sent += static_cast<size_t>(count);
+    }
+    return true;
+}
+
+// Reads one response line (without the newline) through a shared buffer.
+static bool readLine(const int fd, string& buffer, string& line) {
+    for (size_t newline; (newline = buffer.find('\n')) == string::npos;) {
+        char chunk[64 * 1024];
+        const ssize_t count = recv(fd, chunk, sizeof(chunk), 0);
+        if (count <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(count));
+    }
+    const size_t newline = buffer.find('\n');
+    line.assign(buffer, 0, newline);
+    buffer.erase(0, newline + 1);
+    return true;
+}
+
+// Asks the server how many items it holds ("p 0 0" -> "OK 0 <total>").
+static long long queryItemCount(const string& address) {
+    const int fd = connectTo(address);
+    if (fd < 0) return -1;
+    string buffer;
+    string line;
+    long long total = -1;
+    if (sendAll(fd, "p 0 0\n") && readLine(fd, buffer, line) && line.rfind("OK 0 ", 0) == 0) {
+        total = atoll(line.c_str() + 5);
+    }
+    close(fd);
+    return total;
+}
+
+/*
+ * runConnection function definition:
+ *  - Tops the pipeline up to `depth` requests with one send call, then reads
+ *    responses until the pipeline is half empty, so the server always has work
+ *    queued on this connection.
+ */
+static void runConnection(const LoadOptions& options, const uint64_t quota, const long long items, uint64_t seed,
+                          ConnectionResult& result) {
+    const int fd = connectTo(options.address);
+    if (fd < 0) {
+        result.failed = true;
+        return;
+    }
+
+    result.latencies.reserve(quota);
+    deque<Clock::time_point> inFlight;
+    string requests;
+    string buffer;
+    string line;
+    uint64_t sent = 0;
+    while (result.latencies.size() < quota) {
+        requests.clear();
+        const Clock::time_point now = Clock::now();
+        while (sent < quota && inFlight.size() < static_cast<size_t>(options.depth)) {
+            // SplitMix64 step: cheap, and each connection gets its own sequence
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t random = seed;
+            random = (random ^ (random >> 30)) * 0xBF58476D1CE4E5B9ull;
+            random = (random ^ (random >> 27)) * 0x94D049BB133111EBull;
+            random ^= random >> 31;
+
+            requests += (random & 1) ? "a " : "r ";
+            requests += to_string(static_cast<long long>((random >> 8) % static_cast<uint64_t>(items)));
+            requests += ' ';
+            requests += to_string(1 + (random >> 4) % 5);
+            requests += '\n';
+            inFlight.push_back(now);
+            ++sent;
+        }
+        if (!requests.empty() && !sendAll(fd, requests)) {
+            result.failed = true;
+            break;
+        }
+
+        const size_t target = sent < quota ? static_cast<size_t>(options.depth) / 2 : 0;
+        while (inFlight.size() > target) {
+            if (!readLine(fd, buffer, line)) {
+                result.failed = true;
+                break;
+            }
+            result.latencies.push_back(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - inFlight.front()).count());
+            inFlight.pop_front();
+            if (line.rfind("ERR", 0) == 0) {
+                ++result.rejected;
+            } else if (line.rfind("OK", 0) != 0) {
+                result.failed = true;
+            }
+        }
+        if (result.failed) break;
+    }
+    close(fd);
+}
+
+static double percentileMicroseconds(const vector<int64_t>& sorted, const double fraction) {
+    if (sorted.empty()) return 0.0;
+    const size_t index = min(sorted.size() - 1, static_cast<size_t>(fraction * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[index]) / 1000.0;
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    for (int arg = 1; arg < argc; ++arg) {
+        const string option = argv[arg];
+        if (option == "--connect" && arg + 1 < argc) {
+            options.address = argv[++arg];
+        } else if (option == "--connections" && arg + 1 < argc) {
+            options.connections = max(1, atoi(argv[++arg]));
+        } else if (option == "--depth" && arg + 1 < argc) {
+            options.depth = max(1, atoi(argv[++arg]));
+        } else if (option == "--requests" && arg + 1 < argc) {
+            options.requests = strtoull(argv[++arg], nullptr, 10);
+        } else if (option == "--seed" && arg + 1 < argc) {
+            options.seed = strtoull(argv[++arg], nullptr, 10);
+        } else {
+            options.address.clear();
+            break;
+        }
+    }
+    if (options.address.empty()) {
+        cerr << "Usage: " << argv[0] << " --connect <[host:]port|unix:/path> [--connections n] [--depth n]"
+             << " [--requests n] [--seed n]\n";
+        return 1;
+    }
+
+    const long long items = queryItemCount(options.address);
+    if (items < 0) {
+        cerr << "Error: Could not reach a server at \"" << options.address << "\".\n";
+        return 1;
+    }
+    if (items == 0) {
+        cerr << "Error: The server has no items; start it with --load or send some 'n' requests first.\n";
+        return 1;
+    }
+
+    vector<ConnectionResult> results(static_cast<size_t>(options.connections));
+    vector<thread> workers;
+    const auto start = Clock::now();
+    for (int c = 0; c < options.connections; ++c) {
+        const uint64_t quota = options.requests / static_cast<uint64_t>(options.connections) +
+                               (static_cast<uint64_t>(c) < options.requests % static_cast<uint64_t>(options.connections) ? 1 : 0);
+        workers.emplace_back(runConnection, cref(options), quota, items, options.seed * 1000003 + static_cast<uint64_t>(c),
+                             ref(results[static_cast<size_t>(c)]));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    const double seconds = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<int64_t> latencies;
+    uint64_t rejected = 0;
+    int failedConnections = 0;
+    for (ConnectionResult& result : results) {
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        rejected += result.rejected;
+        failedConnections += result.failed ? 1 : 0;
+    }
+    sort(latencies.begin(), latencies.end());
+
+    printf("Server      : %s (%lld items)\n", options.address.c_str(), items);
+    printf("Load        : %d connection(s) x %d in flight\n", options.connections, options.depth);
+    printf("Requests    : %zu in %.3f s (%zu rejected with ERR)\n", latencies.size(), seconds,
+           static_cast<size_t>(rejected));
+    printf("Throughput  : %.0f ops/s\n", seconds > 0.0 ? static_cast<double>(latencies.size()) / seconds : 0.0);
+    printf("Latency (us): p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+           percentileMicroseconds(latencies, 0.50), percentileMicroseconds(latencies, 0.90),
+           percentileMicroseconds(latencies, 0.99), percentileMicroseconds(latencies, 0.999),
+           percentileMicroseconds(latencies, 1.0));
+    if (failedConnections > 0) {
+        printf("Failed      : %d connection(s) lost or sent an unexpected response\n", failedConnections);
+        return 2;
+    }
+    return 0;
+}
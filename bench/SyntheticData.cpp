@@ -0,0 +1,83 @@
+// Implementation File -> SyntheticData.cpp
+#include "SyntheticData.h"
+#include "InventoryStore.h"
+#include "RecordWriter.h"
+#include <iterator>
+
+using namespace std;
+
+static constexpr const char* WORDS[] = {
+    "Copper", "Steel", "Brass", "PVC", "Galvanized", "Stainless", "Hex", "Phillips", "Flat", "Round",
+    "Bolt", "Nut", "Washer", "Screw", "Elbow", "Coupling", "Valve", "Outlet", "Switch", "Breaker",
+    "Wire", "Conduit", "Fitting", "Bracket", "Hinge", "Anchor", "Clamp", "Tape", "Sealant", "Fuse",
+    "1/4\"", "3/8\"", "1/2\"", "3/4\"", "10ft", "12AWG", "14AWG", "20A", "15A", "(box of 50)"};
+
+// SplitMix64: tiny, fast and good enough to make varied but reproducible data.
+static uint64_t mix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/*
+ * syntheticRecord function definition:
+ *  - Derives every field from (seed, itemNum) alone (or from the product number
+ *    when distinct is set), so any record can be produced independently of the others.
+ */
+string syntheticRecord(const size_t itemNum, const uint64_t seed, const size_t distinct) {
+    const size_t product = distinct > 0 ? itemNum % distinct : itemNum;
+    uint64_t state = mix(seed * 0x100000001B3ULL + product);
+    const size_t wordCount = 2 + state % 5;
+
+    string line = to_string(itemNum);
+    line += '|';
+    for (size_t w = 0; w < wordCount; ++w) {
+        state = mix(state);
+        if (w > 0) line += ' ';
+        line += WORDS[state % size(WORDS)];
+    }
+    line += '|';
+
+    state = mix(state);
+    const uint64_t cents = 10 + state % 99990;
+    line += to_string(cents / 100);
+    line += '.';
+    line += static_cast<char>('0' + cents / 10 % 10);
+    line += static_cast<char>('0' + cents % 10);
+    line += '|';
+
+    state = mix(state);
+    line += to_string(state % (MAX_UNITS + 1));
+    return line;
+}
+
+vector<string> syntheticLines(const size_t count, const uint64_t seed) {
+    vector<string> lines;
+    lines.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        lines.push_back(syntheticRecord(i, seed));
+    }
+    return lines;
+}
+
+/*
+ * writeSyntheticInventory function definition:
+ *  - Streams the records through an AtomicFileWriter, so even very large files
+ *    are written without holding them in memory.
+ */
+size_t writeSyntheticInventory(const string& filename, const size_t count, const uint64_t seed,
+                               const size_t distinct) {
+    AtomicFileWriter writer;
+    if (!writer.open(filename)) {
+        return 0;
+    }
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const string line = syntheticRecord(i, seed, distinct);
+        writer.append(line);
+        writer.append('\n');
+        bytes += line.size() + 1;
+    }
+    return writer.commit() ? bytes : 0;
+}
@@ -0,0 +1,39 @@
+// Specification File -> SyntheticData.h
+#ifndef SYNTHETICDATA_H
+#define SYNTHETICDATA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/*
+    Synthetic Inventory Data
+    -----------------------------
+    Description:
+    Produces reproducible inventory records in the program's pipe-delimited
+    format ("item#|description|cost|units"). Descriptions are built from a small
+    vocabulary of hardware words (5 to 60 characters), costs are between 0.10
+    and 999.99 with two decimals and units are within 0..MAX_UNITS. The same
+    seed always produces the same data.
+
+    With `distinct` > 0 only that many different products exist: record i repeats
+    the description, cost and units of product i % distinct, like a catalog where
+    the same part is stocked in many bins.
+
+    In Simpler Terms:
+    Makes fake but realistic inventory files of any size for timing tests.
+*/
+
+// Returns record number itemNum as one line (without the newline).
+string syntheticRecord(size_t itemNum, uint64_t seed = 1, size_t distinct = 0);
+
+// Returns count records as lines (without newlines).
+vector<string> syntheticLines(size_t count, uint64_t seed = 1);
+
+// Writes count records to filename. Returns the number of bytes written, 0 on failure.
+size_t writeSyntheticInventory(const string& filename, size_t count, uint64_t seed = 1, size_t distinct = 0);
+
+#endif // SYNTHETICDATA_H